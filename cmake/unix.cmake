@@ -143,7 +143,7 @@ if(APPLE)
 	set(OSX_ICON "${CMAKE_SOURCE_DIR}/SLADE-osx.icns")
 	set(OSX_PLIST "${CMAKE_SOURCE_DIR}/Info.plist")
 
-	set(SLADE_SOURCES ${SLADE_SOURCES} ${OSX_ICON} ${OSX_PLIST})
+	set(SLADE_GUI_SOURCES ${SLADE_GUI_SOURCES} ${OSX_ICON} ${OSX_PLIST})
 
 	set_source_files_properties(${OSX_ICON} PROPERTIES MACOSX_PACKAGE_LOCATION Resources)
 endif(APPLE)
@@ -167,12 +167,14 @@ endif(USE_SANITIZER)
 # External libraries are compiled separately to enable unity builds
 add_subdirectory(../thirdparty external)
 
-add_executable(slade WIN32 MACOSX_BUNDLE
+# Everything but the entry points is built once, as an object library shared by
+# the GUI (slade) and batch (slade-cli) executables
+add_library(slade_core OBJECT
 	${SLADE_SOURCES}
 	${SLADE_HEADERS}
 )
 
-target_link_libraries(slade
+target_link_libraries(slade_core PUBLIC
 	${ZLIB_LIBRARY}
 	${BZIP2_LIBRARIES}
 	${EXTERNAL_LIBRARIES}
@@ -187,20 +189,32 @@ target_link_libraries(slade
 )
 
 if(CMAKE_CXX_COMPILER_ID STREQUAL "GNU" AND CMAKE_CXX_COMPILER_VERSION LESS 9)
-	target_link_libraries(slade -lstdc++fs)
+	target_link_libraries(slade_core PUBLIC -lstdc++fs)
 endif()
 
 if (WX_GTK3)
-	target_link_libraries(slade ${GTK3_LIBRARIES})
+	target_link_libraries(slade_core PUBLIC ${GTK3_LIBRARIES})
 else(WX_GTK3)
-	target_link_libraries(slade ${GTK2_LIBRARIES})
+	target_link_libraries(slade_core PUBLIC ${GTK2_LIBRARIES})
 endif(WX_GTK3)
 
 if (NOT NO_FLUIDSYNTH)
-	target_link_libraries(slade ${FLUIDSYNTH_LIBRARIES})
+	target_link_libraries(slade_core PUBLIC ${FLUIDSYNTH_LIBRARIES})
 endif()
 
-set_target_properties(slade PROPERTIES RUNTIME_OUTPUT_DIRECTORY ${SLADE_OUTPUT_DIR})
+add_executable(slade WIN32 MACOSX_BUNDLE ${SLADE_GUI_SOURCES})
+target_link_libraries(slade slade_core)
+
+add_executable(slade-cli ${SLADE_BATCH_SOURCES})
+target_link_libraries(slade-cli slade_core)
+
+set_target_properties(slade slade-cli PROPERTIES RUNTIME_OUTPUT_DIRECTORY ${SLADE_OUTPUT_DIR})
+
+if (BUILD_BENCHMARKS)
+	add_executable(slade-bench ${SLADE_BENCHMARK_SOURCES})
+	target_link_libraries(slade-bench slade_core)
+	set_target_properties(slade-bench PROPERTIES RUNTIME_OUTPUT_DIRECTORY ${SLADE_OUTPUT_DIR})
+endif()
 
 # TODO: Installation targets for APPLE
 if(APPLE)
@@ -211,7 +225,7 @@ if(APPLE)
 	)
 else(APPLE)
 	if(UNIX)
-		install(TARGETS slade
+		install(TARGETS slade slade-cli
 			RUNTIME DESTINATION bin
 			)
 
@@ -248,7 +262,7 @@ if(NOT TARGET uninstall)
 endif()
 
 if (NOT NO_COTIRE)
-	set_target_properties(slade PROPERTIES
+	set_target_properties(slade_core PROPERTIES
 		COTIRE_CXX_PREFIX_HEADER_INIT "common.h"
 		# Enable multithreaded unity builds by default
 		# because otherwise probably no one would realize how
@@ -256,5 +270,5 @@ if (NOT NO_COTIRE)
 		# Fixes macro definition bleedout
 		COTIRE_UNITY_SOURCE_PRE_UNDEFS "Bool"
 		)
-	cotire(slade)
+	cotire(slade_core)
 endif()
@@ -58,7 +58,7 @@ include_directories(
 # Sources ----------------------------------------------------------------------
 
 # Extra MSVC-specific files to build
-set(SLADE_SOURCES ${SLADE_SOURCES} "../msvc/SLADE.rc" "../msvc/SLADE.manifest")
+set(SLADE_GUI_SOURCES ${SLADE_GUI_SOURCES} "../msvc/SLADE.rc" "../msvc/SLADE.manifest")
 
 # External libraries are compiled separately to enable unity builds
 add_subdirectory(../thirdparty external)
@@ -66,11 +66,16 @@ add_subdirectory(../thirdparty external)
 
 # Build ------------------------------------------------------------------------
 
-add_executable(slade WIN32
+# Everything but the entry points is built once, as an object library shared by
+# the GUI (slade) and batch (slade-cli) executables
+add_library(slade_core OBJECT
 	${SLADE_SOURCES}
 	${SLADE_HEADERS}
 )
 
+add_executable(slade WIN32 ${SLADE_GUI_SOURCES})
+add_executable(slade-cli ${SLADE_BATCH_SOURCES})
+
 if(NOT SLADE_EXE_NAME)
 set(SLADE_EXE_NAME SLADE)
 endif()
@@ -86,12 +91,27 @@ set_target_properties(slade
 	OUTPUT_NAME "${SLADE_EXE_NAME}"
 	RUNTIME_OUTPUT_DIRECTORY "${CMAKE_SOURCE_DIR}/${SLADE_EXE_DIR}"
 )
+set_target_properties(slade-cli
+	PROPERTIES
+	LINK_FLAGS "/subsystem:console"
+	OUTPUT_NAME "${SLADE_EXE_NAME}-cli"
+	RUNTIME_OUTPUT_DIRECTORY "${CMAKE_SOURCE_DIR}/${SLADE_EXE_DIR}"
+)
+if (BUILD_BENCHMARKS)
+	add_executable(slade-bench ${SLADE_BENCHMARK_SOURCES})
+	set_target_properties(slade-bench
+		PROPERTIES
+		LINK_FLAGS "/subsystem:console"
+		OUTPUT_NAME "${SLADE_EXE_NAME}-bench"
+		RUNTIME_OUTPUT_DIRECTORY "${CMAKE_SOURCE_DIR}/${SLADE_EXE_DIR}"
+	)
+endif()
 
 # Precompiled Header
-target_precompile_headers(slade PRIVATE "common.h")
+target_precompile_headers(slade_core PRIVATE "common.h")
 
 # Link
-target_link_libraries(slade
+target_link_libraries(slade_core PUBLIC
 	${BZIP2_LIBRARIES}
 	${EXTERNAL_LIBRARIES}
 	${FREETYPE_LIBRARIES}
@@ -102,15 +122,19 @@ target_link_libraries(slade
 	freeimage::FreeImage
 	MPG123::libmpg123
 	sfml-audio
-	sfml-main
 	sfml-network
 	sfml-window
 )
+target_link_libraries(slade slade_core sfml-main)
+target_link_libraries(slade-cli slade_core)
+if (BUILD_BENCHMARKS)
+	target_link_libraries(slade-bench slade_core)
+endif()
 
 if (NOT NO_LUA)
-	target_link_libraries(slade ${LUA_LIBRARIES})
+	target_link_libraries(slade_core PUBLIC ${LUA_LIBRARIES})
 endif ()
 
 if (NOT NO_FLUIDSYNTH)
-	target_link_libraries(slade FluidSynth::libfluidsynth)
+	target_link_libraries(slade_core PUBLIC FluidSynth::libfluidsynth)
 endif ()
@@ -53,6 +53,7 @@
 #include "SLADEWxApp.h"
 #include "Scripting/Lua.h"
 #include "Scripting/ScriptManager.h"
+#include "TextEditor/SymbolIndex.h"
 #include "TextEditor/TextLanguage.h"
 #include "TextEditor/TextStyle.h"
 #include "UI/Dialogs/SetupWizard/SetupWizardDialog.h"
@@ -80,6 +81,7 @@ wxStopWatch     timer;
 int             temp_fail_count = 0;
 bool            init_ok         = false;
 bool            exiting         = false;
+bool            headless        = false;
 std::thread::id main_thread_id;
 
 // Version
@@ -103,6 +105,7 @@ PaletteManager  palette_manager;
 ArchiveManager  archive_manager;
 Clipboard       clip_board;
 ResourceManager resource_manager;
+SymbolIndex     symbol_index;
 } // namespace slade::app
 
 CVAR(Int, temp_location, 0, CVar::Flag::Save)
@@ -412,6 +415,14 @@ ResourceManager& app::resources()
 	return resource_manager;
 }
 
+// -----------------------------------------------------------------------------
+// Returns the text entry Symbol Index
+// -----------------------------------------------------------------------------
+SymbolIndex& app::symbolIndex()
+{
+	return symbol_index;
+}
+
 // -----------------------------------------------------------------------------
 // Returns the number of ms elapsed since the application was started
 // -----------------------------------------------------------------------------
@@ -428,6 +439,15 @@ bool app::isExiting()
 	return exiting;
 }
 
+// -----------------------------------------------------------------------------
+// Returns true if the application was initialised without a user interface
+// (see initHeadless)
+// -----------------------------------------------------------------------------
+bool app::isHeadless()
+{
+	return headless;
+}
+
 // -----------------------------------------------------------------------------
 // Application initialisation
 // -----------------------------------------------------------------------------
@@ -594,6 +614,120 @@ bool app::init(const vector<string>& args, double ui_scale)
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Application initialisation without a user interface (for batch mode).
+// Only the things needed to open, process and save archives are initialised,
+// no windows are created and nothing that requires a display is touched.
+//
+// Since any number of batch processes can run at once, each one gets its own
+// temp folder, and the log is only written to a file if [log_file] is given
+// -----------------------------------------------------------------------------
+bool app::initHeadless(const string& log_file)
+{
+	headless = true;
+
+	// Get the id of the current thread (should be the main one)
+	main_thread_id = std::this_thread::get_id();
+
+	// Set numeric locale to C so that the tokenizer will work properly
+	wxSetlocale(LC_NUMERIC, "C");
+
+	// Init application directories
+	if (!initDirectories())
+		return false;
+
+	// Use a temp folder for this process only
+	dir_temp += fmt::format("{}cli-{}", dir_separator, wxGetProcessId());
+	if (!wxDirExists(dir_temp) && !wxMkdir(dir_temp))
+	{
+		fmt::print(stderr, "Unable to create temp directory \"{}\"\n", dir_temp);
+		return false;
+	}
+
+	// Init log
+	log::init(log_file);
+
+	// Init FreeImage
+	FreeImage_Initialise();
+
+	// Never show the splash window
+	ui::enableSplash(false);
+
+	// Load configuration file
+	readConfigFile();
+
+	// Init entry types
+	EntryDataFormat::initBuiltinFormats();
+	EntryType::initTypes();
+
+	// Check that SLADE.pk3 can be found
+	archive_manager.init();
+	if (!archive_manager.resArchiveOK())
+	{
+		log::error("Unable to find slade.pk3, make sure it exists in the same directory as the SLADE executable");
+		return false;
+	}
+
+#ifndef NO_LUA
+	// Init lua
+	lua::init();
+#endif
+
+	// Init palettes
+	if (!palette_manager.init())
+	{
+		log::error("Failed to initialise palettes");
+		return false;
+	}
+
+	// Init SImage formats
+	SIFormat::initFormats();
+
+	// Load entry types
+	EntryType::loadEntryTypes();
+
+	// Load text languages
+	TextLanguage::loadLanguages();
+
+	// Init colour configuration
+	colourconfig::init();
+
+	// Init base resource
+	archive_manager.initBaseResource();
+
+	// Init game configuration
+	game::init();
+
+	init_ok = true;
+	log::info("SLADE Initialisation OK (headless)");
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Cleans up after headless initialisation. Unlike exit, nothing is saved (so
+// that many batch processes can run at once without clobbering the user's
+// configuration), and only this process' temp folder is removed
+// -----------------------------------------------------------------------------
+void app::exitHeadless()
+{
+	exiting = true;
+
+	// Close all open archives
+	archive_manager.closeAll();
+
+#ifndef NO_LUA
+	// Close lua
+	lua::close();
+#endif
+
+	// Remove temp folder
+	std::error_code error;
+	std::filesystem::remove_all(dir_temp, error);
+	if (error)
+		log::warning("Could not remove temp directory \"{}\": {}", dir_temp, error.message());
+}
+
 // -----------------------------------------------------------------------------
 // Saves the SLADE configuration file
 // -----------------------------------------------------------------------------
@@ -9,6 +9,7 @@ class Console;
 class PaletteManager;
 class Clipboard;
 class ResourceManager;
+class SymbolIndex;
 
 namespace app
 {
@@ -20,11 +21,17 @@ namespace app
 	ArchiveManager&  archiveManager();
 	Clipboard&       clipboard();
 	ResourceManager& resources();
+	SymbolIndex&     symbolIndex();
 
 	bool init(const vector<string>& args, double ui_scale = 1.);
 	void saveConfigFile();
 	void exit(bool save_config);
 
+	// Batch mode (no user interface)
+	bool initHeadless(const string& log_file = {});
+	void exitHeadless();
+	bool isHeadless();
+
 	// Version
 	struct Version
 	{
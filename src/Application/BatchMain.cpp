@@ -0,0 +1,92 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2022 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    BatchMain.cpp
+// Description: Entry point for the slade-cli (batch mode) executable. This
+//              runs as a wx console app, so no display is needed
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "App.h"
+#include "BatchMode.h"
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+// Batch mode entry point
+// -----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+	vector<string> args;
+	for (int a = 1; a < argc; a++)
+		args.emplace_back(argv[a]);
+
+	if (args.empty() || args[0] == "--help" || args[0] == "-h")
+	{
+		batch::printUsage();
+		return args.empty() ? 2 : 0;
+	}
+
+	// Use a console app rather than SLADEWxApp, so wx doesn't try to connect
+	// to a display (this must be set before wx is initialised)
+	wxApp::SetInstance(new wxAppConsole);
+	wxInitializer initializer(argc, argv);
+	if (!initializer.IsOk())
+	{
+		fmt::print(stderr, "Failed to initialise wxWidgets\n");
+		return 1;
+	}
+
+	// Set application name (for wx directory stuff), same as SLADEWxApp
+#ifdef __WINDOWS__
+	wxTheApp->SetAppName("SLADE3");
+#else
+	wxTheApp->SetAppName("slade3");
+#endif
+
+	// Get the log file to write to (if any), since the log is initialised
+	// before the rest of the arguments are parsed
+	string log_file;
+	for (unsigned a = 0; a + 1 < args.size(); a++)
+		if (args[a] == "--log")
+			log_file = args[a + 1];
+
+	if (!app::initHeadless(log_file))
+	{
+		fmt::print(stderr, "SLADE initialisation failed\n");
+		for (const auto& msg : log::history())
+			if (msg.type == log::MessageType::Error)
+				fmt::print(stderr, "{}\n", msg.formattedMessageLine());
+		return 1;
+	}
+
+	int result = batch::run(args);
+	app::exitHeadless();
+
+	return result;
+}
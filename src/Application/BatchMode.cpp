@@ -0,0 +1,535 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2022 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    BatchMode.cpp
+// Description: Batch mode, opens archives given on the command line, runs
+//              lua scripts and/or built-in operations on them and saves the
+//              results, all without any user interface
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "BatchMode.h"
+#include "App.h"
+#include "Archive/ArchiveManager.h"
+#include "Game/Configuration.h"
+#include "General/Misc.h"
+#include "Graphics/Palette/Palette.h"
+#include "Graphics/SImage/BatchConvert.h"
+#include "MainEditor/ArchiveOperations.h"
+#include "MapEditor/MapChecks.h"
+#include "SLADEMap/SLADEMap.h"
+#include "Scripting/Lua.h"
+#include "Utility/FileUtils.h"
+#include "Utility/StringUtils.h"
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// External Variables
+//
+// -----------------------------------------------------------------------------
+EXTERN_CVAR(Int, max_worker_threads)
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Batch mode options, from the command line
+// -----------------------------------------------------------------------------
+struct Options
+{
+	vector<string> archives;
+	vector<string> scripts;
+	bool           detect_types           = false;
+	bool           check_duplicates       = false;
+	bool           list_unused_textures   = false;
+	bool           remove_unused_textures = false;
+	string         convert_gfx; // Image format id to convert all graphics to
+	vector<string> map_checks;  // Map check ids to run
+	string         game;
+	string         port;
+	bool           save = false;
+	string         output_dir;
+	bool           verbose = false;
+};
+
+// Index of the next log message to be printed
+size_t log_printed = 0;
+
+// -----------------------------------------------------------------------------
+// Prints any new log messages: warnings and errors go to stderr (info messages
+// too if [verbose] is true), script output goes to stdout
+// -----------------------------------------------------------------------------
+void printNewLogMessages(bool verbose)
+{
+	const auto& messages = log::history();
+	for (; log_printed < messages.size(); ++log_printed)
+	{
+		const auto& msg = messages[log_printed];
+		switch (msg.type)
+		{
+		case log::MessageType::Script: fmt::print("{}\n", msg.message); break;
+		case log::MessageType::Warning:
+		case log::MessageType::Error: fmt::print(stderr, "{}\n", msg.formattedMessageLine()); break;
+		case log::MessageType::Info:
+			if (verbose)
+				fmt::print(stderr, "{}\n", msg.formattedMessageLine());
+			break;
+		default: break;
+		}
+	}
+	std::fflush(stdout);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the path of [entry] without the leading separator
+// -----------------------------------------------------------------------------
+string entryPath(const ArchiveEntry* entry)
+{
+	auto path = entry->path(true);
+	if (strutil::startsWith(path, '/'))
+		path.erase(0, 1);
+	return path;
+}
+
+// -----------------------------------------------------------------------------
+// Parses command line [args] into [opt].
+// Returns false if the arguments are invalid
+// -----------------------------------------------------------------------------
+bool parseArgs(const vector<string>& args, Options& opt)
+{
+	for (unsigned a = 0; a < args.size(); ++a)
+	{
+		const auto& arg = args[a];
+
+		// Gets the value for the current option
+		auto value = [&](string& out)
+		{
+			if (a + 1 >= args.size())
+			{
+				fmt::print(stderr, "Missing value for {}\n", arg);
+				return false;
+			}
+			out = args[++a];
+			return true;
+		};
+
+		string val;
+		if (arg == "--detect-types")
+			opt.detect_types = true;
+		else if (arg == "--check-duplicates")
+			opt.check_duplicates = true;
+		else if (arg == "--list-unused-textures")
+			opt.list_unused_textures = true;
+		else if (arg == "--remove-unused-textures")
+			opt.remove_unused_textures = true;
+		else if (arg == "--convert-gfx")
+		{
+			if (!value(opt.convert_gfx))
+				return false;
+		}
+		else if (arg == "--check-maps")
+		{
+			if (!value(val))
+				return false;
+			for (const auto& id : strutil::split(val, ','))
+				if (!id.empty())
+					opt.map_checks.push_back(id);
+		}
+		else if (arg == "--game")
+		{
+			if (!value(opt.game))
+				return false;
+		}
+		else if (arg == "--port")
+		{
+			if (!value(opt.port))
+				return false;
+		}
+		else if (arg == "--script")
+		{
+			if (!value(val))
+				return false;
+			opt.scripts.push_back(val);
+		}
+		else if (arg == "--save")
+			opt.save = true;
+		else if (arg == "--output")
+		{
+			if (!value(opt.output_dir))
+				return false;
+		}
+		else if (arg == "--threads" || arg == "-j")
+		{
+			if (!value(val))
+				return false;
+			max_worker_threads = strutil::asInt(val);
+		}
+		else if (arg == "--verbose" || arg == "-v")
+			opt.verbose = true;
+		else if (arg == "--log")
+		{
+			// Already handled before initialisation (see BatchMain.cpp)
+			if (!value(val))
+				return false;
+		}
+		else if (strutil::startsWith(arg, '-'))
+		{
+			fmt::print(stderr, "Unknown option \"{}\"\n", arg);
+			return false;
+		}
+		else
+			opt.archives.push_back(arg);
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Detects the type of all entries in [archive] and prints the number of
+// entries of each type
+// -----------------------------------------------------------------------------
+void detectTypes(Archive& archive)
+{
+	vector<ArchiveEntry*> entries;
+	archive.putEntryTreeAsList(entries);
+
+	std::map<string, unsigned> type_counts;
+	for (auto* entry : entries)
+	{
+		if (entry->type() == EntryType::folderType())
+			continue;
+
+		EntryType::detectEntryType(*entry);
+		type_counts[entry->type()->id()]++;
+	}
+
+	for (const auto& [type, count] : type_counts)
+		fmt::print("types: {} {}\n", type, count);
+}
+
+// -----------------------------------------------------------------------------
+// Prints all groups of entries in [archive] with the same data
+// -----------------------------------------------------------------------------
+void checkDuplicates(const Archive& archive)
+{
+	auto duplicates = archiveoperations::findDuplicateEntryContent(&archive);
+	for (const auto& group : duplicates)
+	{
+		string line = fmt::format("duplicate: {} ({:08x}) duplicated by", entryPath(group[0]), group[0]->contentHash());
+		for (unsigned a = 1; a < group.size(); ++a)
+			line += fmt::format(" {}", entryPath(group[a]));
+		fmt::print("{}\n", line);
+	}
+
+	fmt::print("duplicate: {} groups of duplicated entries\n", duplicates.size());
+}
+
+// -----------------------------------------------------------------------------
+// Prints textures in [archive] that aren't used in any of its maps, and removes
+// the ones that are safe to remove if [remove] is true
+// -----------------------------------------------------------------------------
+void unusedTextures(Archive& archive, bool remove)
+{
+	auto unused = archiveoperations::findUnusedTextures(&archive);
+
+	vector<wxString> to_remove;
+	for (const auto& tex : unused)
+	{
+		fmt::print("unused-texture: {}{}\n", tex.name.ToStdString(), tex.safe_to_remove ? "" : " (kept)");
+		if (tex.safe_to_remove)
+			to_remove.push_back(tex.name);
+	}
+
+	if (remove && !to_remove.empty())
+		fmt::print("unused-texture: removed {}\n", archiveoperations::removeTextures(&archive, to_remove));
+}
+
+// -----------------------------------------------------------------------------
+// Converts all graphics entries in [archive] to the image format [format_id].
+// Returns false if the format is invalid
+// -----------------------------------------------------------------------------
+bool convertGfx(Archive& archive, const string& format_id)
+{
+	auto format = SIFormat::getFormat(format_id);
+	if (format == SIFormat::unknownFormat())
+	{
+		fmt::print(stderr, "Unknown image format \"{}\"\n", format_id);
+		return false;
+	}
+
+	// Use the archive's palette (or the default one)
+	Palette palette;
+	misc::loadPaletteFromArchive(&palette, &archive);
+
+	// Get graphics entries not already in the format
+	vector<ArchiveEntry*> entries;
+	archive.putEntryTreeAsList(entries);
+	vector<gfx::BatchConvertItem> items;
+	for (auto* entry : entries)
+	{
+		if (entry->type()->editor() != "gfx" || SIFormat::determineFormat(entry->data()) == format)
+			continue;
+
+		auto& item               = items.emplace_back(entry);
+		item.options.pal_current = &palette;
+		item.options.pal_target  = &palette;
+		item.write_palette       = &palette;
+	}
+
+	auto stats = gfx::convertImages(items, format, true, true);
+	gfx::writeConvertedImages(items);
+
+	for (const auto& item : items)
+		if (item.status != gfx::BatchConvertItem::Status::Done)
+			fmt::print("convert: failed {}: {}\n", entryPath(item.entry), item.error);
+	fmt::print("convert: {}\n", stats.asString());
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Runs the map checks [check_ids] on all maps in [archive] and prints any
+// problems found.
+// Checks for unknown textures/flats need the map editor's texture manager (and
+// an OpenGL context), so they are skipped
+// -----------------------------------------------------------------------------
+void checkMaps(Archive& archive, const vector<string>& check_ids, const Options& opt)
+{
+	// Get checks to run
+	vector<string> ids;
+	for (const auto& id : check_ids)
+	{
+		if (strutil::equalCI(id, "all"))
+		{
+			for (int a = 0; a < MapCheck::NumStandardChecks; ++a)
+				ids.push_back(MapCheck::standardCheckId(static_cast<MapCheck::StandardCheck>(a)));
+		}
+		else
+			ids.push_back(id);
+	}
+
+	for (const auto& map_desc : archive.detectMaps())
+	{
+		// Load game configuration for the map format
+		if (!opt.game.empty())
+			game::configuration().openConfig(opt.game, opt.port, map_desc.format);
+
+		SLADEMap map;
+		if (!map.readMap(map_desc))
+		{
+			fmt::print(stderr, "Unable to open map {}: {}\n", map_desc.name, global::error);
+			continue;
+		}
+
+		unsigned n_problems = 0;
+		for (const auto& id : ids)
+		{
+			if (id == MapCheck::standardCheckId(MapCheck::UnknownTexture)
+				|| id == MapCheck::standardCheckId(MapCheck::UnknownFlat))
+				continue;
+
+			auto check = MapCheck::standardCheck(id, &map);
+			if (!check)
+			{
+				fmt::print(stderr, "Unknown map check \"{}\"\n", id);
+				continue;
+			}
+
+			check->doCheck();
+			for (unsigned a = 0; a < check->nProblems(); ++a)
+				fmt::print("map-check: {}: {}: {}\n", map_desc.name, id, check->problemDesc(a));
+			n_problems += check->nProblems();
+		}
+
+		fmt::print("map-check: {}: {} problems\n", map_desc.name, n_problems);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Opens the archive at [path] and runs everything in [opt] on it.
+// Returns false if anything failed
+// -----------------------------------------------------------------------------
+bool processArchive(const string& path, const Options& opt, const vector<string>& scripts)
+{
+	auto& manager = app::archiveManager();
+	auto  archive = fileutil::dirExists(path) ? manager.openDirArchive(path, true, true) :
+												manager.openArchive(path, true, true);
+	if (!archive)
+	{
+		fmt::print(stderr, "Unable to open archive {}: {}\n", path, global::error);
+		return false;
+	}
+
+	fmt::print("archive: {}\n", path);
+	bool ok = true;
+
+	// Built-in operations
+	if (opt.detect_types)
+		detectTypes(*archive);
+	if (opt.check_duplicates)
+		checkDuplicates(*archive);
+	if (opt.list_unused_textures || opt.remove_unused_textures)
+		unusedTextures(*archive, opt.remove_unused_textures);
+	if (!opt.convert_gfx.empty())
+		ok = convertGfx(*archive, opt.convert_gfx) && ok;
+	if (!opt.map_checks.empty())
+		checkMaps(*archive, opt.map_checks, opt);
+	printNewLogMessages(opt.verbose);
+
+#ifndef NO_LUA
+	// Scripts
+	for (unsigned a = 0; a < scripts.size(); ++a)
+	{
+		bool script_ok = lua::runArchiveScript(scripts[a], archive.get());
+		printNewLogMessages(opt.verbose);
+
+		if (!script_ok)
+		{
+			const auto& error = lua::error();
+			fmt::print(stderr, "{} error in {}", error.type, opt.scripts[a]);
+			if (error.line_no >= 0)
+				fmt::print(stderr, " line {}", error.line_no);
+			fmt::print(stderr, ": {}\n", error.message);
+			ok = false;
+		}
+	}
+#endif
+
+	// Save
+	if (!opt.output_dir.empty())
+	{
+		auto out_path = fmt::format("{}/{}", opt.output_dir, archive->filename(false));
+		if (!archive->save(out_path))
+		{
+			fmt::print(stderr, "Unable to save {}: {}\n", out_path, global::error);
+			ok = false;
+		}
+	}
+	else if (opt.save && archive->isModified())
+	{
+		if (!archive->save())
+		{
+			fmt::print(stderr, "Unable to save {}: {}\n", path, global::error);
+			ok = false;
+		}
+	}
+	printNewLogMessages(opt.verbose);
+
+	manager.closeArchive(archive.get());
+
+	return ok;
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Batch Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Prints command line usage info for batch mode
+// -----------------------------------------------------------------------------
+void batch::printUsage()
+{
+	fmt::print(
+		"Usage: slade-cli [options] <archive>...\n"
+		"\n"
+		"Operations (run on each archive, in this order):\n"
+		"  --detect-types              Detect entry types and list the number of each\n"
+		"  --check-duplicates          List entries with duplicated data\n"
+		"  --list-unused-textures      List textures not used in any map\n"
+		"  --remove-unused-textures    Remove unused textures (except switch counterparts\n"
+		"                              of used textures and base resource textures)\n"
+		"  --convert-gfx <format>      Convert all graphics to an image format (eg. png)\n"
+		"  --check-maps <ids|all>      Run map checks (comma-separated check ids)\n"
+		"  --script <file>             Run Execute(archive) in a lua script, can be given\n"
+		"                              multiple times\n"
+		"\n"
+		"Other options:\n"
+		"  --game <id> [--port <id>]   Game configuration to use for map checks\n"
+		"  --save                      Save modified archives\n"
+		"  --output <dir>              Save archives to <dir> instead\n"
+		"  -j, --threads <n>           Maximum worker threads (0 = one per CPU core)\n"
+		"  -v, --verbose               Show all log messages\n"
+		"  --log <file>                Also write the log to <file>\n");
+}
+
+// -----------------------------------------------------------------------------
+// Runs batch mode with the given command line [args] (excluding the executable
+// name). The application must have been initialised with app::initHeadless.
+// Returns the process exit code: 0 if everything succeeded, 1 if anything
+// failed or 2 if the arguments were invalid
+// -----------------------------------------------------------------------------
+int batch::run(const vector<string>& args)
+{
+	Options opt;
+	if (!parseArgs(args, opt) || opt.archives.empty())
+	{
+		printUsage();
+		return 2;
+	}
+
+	if (opt.verbose)
+		log::setVerbosity(2);
+
+	// Load scripts
+	vector<string> scripts;
+	for (const auto& file : opt.scripts)
+	{
+#ifdef NO_LUA
+		fmt::print(stderr, "Unable to run {}: built without lua support\n", file);
+		return 2;
+#else
+		auto& script = scripts.emplace_back();
+		if (!fileutil::readFileToString(file, script))
+		{
+			fmt::print(stderr, "Unable to read script {}\n", file);
+			return 2;
+		}
+#endif
+	}
+
+	// Process archives
+	log_printed = log::history().size();
+	int result  = 0;
+	for (const auto& path : opt.archives)
+		if (!processArchive(path, opt, scripts))
+			result = 1;
+
+	return result;
+}
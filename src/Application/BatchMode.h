@@ -0,0 +1,7 @@
+#pragma once
+
+namespace slade::batch
+{
+int  run(const vector<string>& args);
+void printUsage();
+} // namespace slade::batch
@@ -50,11 +50,11 @@ using std::weak_ptr;
 // Namespace to hold 'global' variables
 namespace slade::global
 {
-extern string error;
-extern string sc_rev;
-extern bool   debug;
-extern int    win_version_major;
-extern int    win_version_minor;
+extern thread_local string error; // Per-thread so it can be set from worker threads
+extern string              sc_rev;
+extern bool                debug;
+extern int                 win_version_major;
+extern int                 win_version_minor;
 }; // namespace slade::global
 
 // Rust-style numeric type aliases
@@ -39,6 +39,7 @@
 #include "MainEditor/UI/MainWindow.h"
 #include "MainEditor/UI/StartPage.h"
 #include "OpenGL/OpenGL.h"
+#include "TextEditor/SymbolIndex.h"
 #include "UI/WxUtils.h"
 #include "Utility/Parser.h"
 #include "Utility/StringUtils.h"
@@ -61,7 +62,7 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 namespace slade::global
 {
-string error;
+thread_local string error;
 
 #ifdef GIT_DESCRIPTION
 string sc_rev = GIT_DESCRIPTION;
@@ -375,7 +376,8 @@ public:
 // SLADEWxApp Class Functions
 //
 // -----------------------------------------------------------------------------
-IMPLEMENT_APP(SLADEWxApp)
+// (main is in SLADEMain.cpp, so it isn't included in the batch executable)
+IMPLEMENT_APP_NO_MAIN(SLADEWxApp)
 
 
 // -----------------------------------------------------------------------------
@@ -513,6 +515,7 @@ bool SLADEWxApp::OnInit()
 	Bind(wxEVT_WEBREQUEST_STATE, &SLADEWxApp::onVersionCheckCompleted, this);
 	Bind(wxEVT_ACTIVATE_APP, &SLADEWxApp::onActivate, this);
 	Bind(wxEVT_QUERY_END_SESSION, &SLADEWxApp::onEndSession, this);
+	Bind(wxEVT_IDLE, &SLADEWxApp::onIdle, this);
 
 	return true;
 }
@@ -781,6 +784,18 @@ void SLADEWxApp::onEndSession(wxCloseEvent& e)
 	e.Skip();
 }
 
+// -----------------------------------------------------------------------------
+// Called when the application is idle
+// -----------------------------------------------------------------------------
+void SLADEWxApp::onIdle(wxIdleEvent& e)
+{
+	// Read more entries for the symbol index, if any are waiting
+	if (!app::isExiting() && app::symbolIndex().indexNext())
+		e.RequestMore();
+
+	e.Skip();
+}
+
 
 // -----------------------------------------------------------------------------
 //
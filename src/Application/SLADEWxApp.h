@@ -28,6 +28,7 @@ public:
 	void onVersionCheckCompleted(wxWebRequestEvent& e);
 	void onActivate(wxActivateEvent& e);
 	void onEndSession(wxCloseEvent& e);
+	void onIdle(wxIdleEvent& e);
 
 private:
 	wxSingleInstanceChecker* single_instance_checker_ = nullptr;
@@ -31,6 +31,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "Archive.h"
+#include "General/Trace.h"
 #include "General/UndoRedo.h"
 #include "Utility/FileUtils.h"
 #include "Utility/Parser.h"
@@ -643,6 +644,8 @@ bool Archive::write(string_view filename, bool update)
 // -----------------------------------------------------------------------------
 bool Archive::save(string_view filename)
 {
+	TRACE_ZONE("Archive::save");
+
 	bool success = false;
 
 	// Check if the archive is read-only
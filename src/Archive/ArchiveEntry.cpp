@@ -37,6 +37,7 @@
 #include "Archive.h"
 #include "General/Misc.h"
 #include "Utility/StringUtils.h"
+#include <atomic>
 
 using namespace slade;
 
@@ -62,6 +63,8 @@ unsigned maxEntrySizeBytes()
 	constexpr unsigned MB_TO_BYTES = 1024 * 1024;
 	return max_entry_size_mb * MB_TO_BYTES;
 }
+
+std::atomic<uint64_t> entry_version_counter{ 0 };
 }
 
 
@@ -100,6 +103,10 @@ ArchiveEntry::ArchiveEntry(ArchiveEntry& copy) :
 	ex_props_.remove("ZipIndex");
 	ex_props_.remove("Offset");
 	ex_props_.remove("filePath");
+
+	// Copy content hash if it is already known
+	if (copy.content_hash_version_ == copy.version_)
+		setContentHash(copy.content_hash_);
 }
 
 // -----------------------------------------------------------------------------
@@ -178,16 +185,41 @@ MemChunk& ArchiveEntry::data(bool allow_load)
 	// Get parent archive
 	auto parent_archive = parent();
 
-	// Load the data if needed (and possible)
+	// Load the data if needed (and possible). The state is locked while loading
+	// so the entry doesn't get a new version (which would invalidate anything
+	// cached for it) just because its data was read
 	if (allow_load && !isLoaded() && parent_archive && size_ > 0 && size_ <= maxEntrySizeBytes())
 	{
-		data_loaded_ = parent_archive->loadEntryData(this);
+		auto was_locked = state_locked_;
+		lockState();
+		data_loaded_  = parent_archive->loadEntryData(this);
+		state_locked_ = was_locked;
 		setState(State::Unmodified);
 	}
 
 	return data_;
 }
 
+// -----------------------------------------------------------------------------
+// Returns the CRC-32 hash of the entry's data. The hash is cached until the
+// entry is next modified, and if the data had to be loaded to compute it, it
+// is unloaded again afterwards
+// -----------------------------------------------------------------------------
+uint32_t ArchiveEntry::contentHash()
+{
+	if (content_hash_version_ != version_)
+	{
+		bool was_loaded = isLoaded();
+		auto hash       = data().crc();
+		setContentHash(hash);
+
+		if (!was_loaded)
+			unloadData();
+	}
+
+	return content_hash_;
+}
+
 // -----------------------------------------------------------------------------
 // Returns the 'next' entry from this (ie. index + 1) in its parent ArchiveDir,
 // or nullptr if it is the last entry or has no parent dir
@@ -244,8 +276,14 @@ void ArchiveEntry::setState(State state, bool silent)
 
 	if (state == State::Unmodified)
 		state_ = State::Unmodified;
-	else if (state > state_)
-		state_ = state;
+	else
+	{
+		if (state > state_)
+			state_ = state;
+
+		// Anything caching data derived from this entry can check this
+		version_ = nextVersion();
+	}
 
 	// Notify parent archive this entry has been modified
 	if (!silent)
@@ -631,6 +669,14 @@ string ArchiveEntry::sizeString() const
 	return misc::sizeAsString(size());
 }
 
+// -----------------------------------------------------------------------------
+// Returns a new unique entry version id
+// -----------------------------------------------------------------------------
+uint64_t ArchiveEntry::nextVersion()
+{
+	return ++entry_version_counter;
+}
+
 // -----------------------------------------------------------------------------
 // ArchiveEntry::stateChanged
 //
@@ -684,6 +730,15 @@ bool ArchiveEntry::isInNamespace(string_view ns)
 	return parent()->detectNamespace(this) == ns;
 }
 
+// -----------------------------------------------------------------------------
+// Returns true if the entry's data is identical to [other]'s (compared by size
+// and content hash)
+// -----------------------------------------------------------------------------
+bool ArchiveEntry::hasSameContent(ArchiveEntry& other)
+{
+	return size() == other.size() && contentHash() == other.contentHash();
+}
+
 // -----------------------------------------------------------------------------
 // Returns the entry at [path] relative to [base], or failing that, the entry
 // at absolute [path] in the archive (if [allow_absolute_path] is true)
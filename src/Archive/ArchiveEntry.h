@@ -54,6 +54,8 @@ public:
 	Property&                exProp(const string& key) { return ex_props_[key]; }
 	template<typename T> T   exProp(const string& key);
 	State                    state() const { return state_; }
+	uint64_t                 version() const { return version_; }
+	uint32_t                 contentHash();
 	bool                     isLocked() const { return locked_; }
 	bool                     isLoaded() const { return data_loaded_; }
 	Encryption               encryption() const { return encrypted_; }
@@ -79,6 +81,11 @@ public:
 	void unlockState() { state_locked_ = false; }
 	void formatName(const ArchiveFormat& format);
 	void updateSize() { size_ = data_.size(); }
+	void setContentHash(uint32_t hash)
+	{
+		content_hash_         = hash;
+		content_hash_version_ = version_;
+	}
 
 	// Entry modification (will change entry state)
 	bool rename(string_view new_name);
@@ -110,6 +117,7 @@ public:
 	void          setExtensionByType();
 	int           typeReliability() const { return (type_ ? (type()->reliability() * reliability_ / 255) : 0); }
 	bool          isInNamespace(string_view ns);
+	bool          hasSameContent(ArchiveEntry& other);
 	ArchiveEntry* relativeEntry(string_view path, bool allow_absolute_path = true) const;
 
 private:
@@ -128,10 +136,17 @@ private:
 	bool       locked_       = false;            // If true the entry data+info cannot be changed
 	bool       data_loaded_  = true;             // True if the entry's data is currently loaded into the data MemChunk
 	Encryption encrypted_    = Encryption::None; // Is there some encrypting on the archive?
+	uint64_t   version_      = nextVersion();    // Unique id, changes every time the entry is modified
+
+	// Content hash (CRC-32) cache, valid while content_hash_version_ matches version_
+	uint32_t content_hash_         = 0;
+	uint64_t content_hash_version_ = 0;
 
 	// Misc stuff
 	int    reliability_ = 0; // The reliability of the entry's identification
 	size_t index_guess_ = 0; // for speed
+
+	static uint64_t nextVersion();
 };
 
 template<typename T> T ArchiveEntry::exProp(const string& key)
@@ -38,6 +38,7 @@
 #include "General/Console.h"
 #include "General/ResourceManager.h"
 #include "General/UI.h"
+#include "TextEditor/SymbolIndex.h"
 #include "Utility/FileUtils.h"
 #include "Utility/StringUtils.h"
 
@@ -198,6 +199,10 @@ bool ArchiveManager::addArchive(shared_ptr<Archive> archive)
 		// Add to resource manager
 		app::resources().addArchive(archive.get());
 
+		// Add to symbol index (not needed without a user interface)
+		if (!app::isHeadless())
+			app::symbolIndex().addArchive(archive.get());
+
 		// ZDoom also loads any WADs found in the root of a PK3 or directory
 		if ((archive->formatId() == "zip" || archive->formatId() == "folder") && auto_open_wads_root)
 		{
@@ -582,8 +587,9 @@ bool ArchiveManager::closeArchive(int index)
 	// Delete any bookmarked entries contained in the archive
 	deleteBookmarksInArchive(open_archives_[index].archive.get());
 
-	// Remove from resource manager
+	// Remove from resource manager and symbol index
 	app::resources().removeArchive(open_archives_[index].archive.get());
+	app::symbolIndex().removeArchive(open_archives_[index].archive.get());
 
 	// Close any open child archives
 	// Clear out the open_children vector first, lest the children try to remove themselves from it
@@ -35,6 +35,7 @@
 #include "Archive/ArchiveManager.h"
 #include "Archive/Formats/ZipArchive.h"
 #include "General/Console.h"
+#include "General/Trace.h"
 #include "MainEditor/MainEditor.h"
 #include "Utility/Parser.h"
 #include "Utility/StringUtils.h"
@@ -188,12 +189,15 @@ int EntryType::isThisType(ArchiveEntry& entry) const
 	{
 		// Hack for identifying ACS script sources despite DB2 apparently appending
 		// two null bytes to them, which make the memchr test fail.
-		size_t end = entry.size() - 1;
+		// (Uses the size of the data rather than the entry, as the data may only be
+		// partially loaded for type detection, see DirArchive)
+		auto&  data = entry.data();
+		size_t end  = data.size() - 1;
 		if (end > 3)
 			end -= 2;
 		// Text is a special case, as other data formats can sometimes be detected as 'text',
 		// we'll only check for it if text data is specified in the entry type
-		if (entry.size() > 0 && memchr(entry.rawData(), 0, end) != nullptr)
+		if (data.size() > 0 && memchr(data.data(), 0, end) != nullptr)
 			return EntryDataFormat::MATCH_FALSE;
 	}
 	else if (format_ != EntryDataFormat::anyFormat() && entry.size() > 0)
@@ -591,6 +595,8 @@ bool EntryType::loadEntryTypes()
 // -----------------------------------------------------------------------------
 bool EntryType::detectEntryType(ArchiveEntry& entry)
 {
+	TRACE_ZONE("EntryType::detectEntryType");
+
 	// Do nothing if the entry is a folder or a map marker
 	if (entry.type() == etype_folder || entry.type() == etype_map)
 		return false;
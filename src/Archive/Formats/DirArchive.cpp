@@ -34,10 +34,12 @@
 #include "Main.h"
 #include "DirArchive.h"
 #include "App.h"
+#include "General/Trace.h"
 #include "General/UI.h"
 #include "Utility/FileUtils.h"
 #include "Utility/StringUtils.h"
 #include "WadArchive.h"
+#include <filesystem>
 
 using namespace slade;
 
@@ -48,6 +50,8 @@ using namespace slade;
 //
 // -----------------------------------------------------------------------------
 CVAR(Bool, archive_dir_ignore_hidden, true, CVar::Save)
+CVAR(Bool, archive_dir_watch_changes, true, CVar::Save)
+CVAR(Int, archive_dir_detect_read_kb, 64, CVar::Save) // Larger files are detected from their first [x]kb only
 
 
 // -----------------------------------------------------------------------------
@@ -59,6 +63,29 @@ EXTERN_CVAR(Bool, archive_load_data)
 EXTERN_CVAR(Int, max_entry_size_mb)
 
 
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the size of the file at [path] (clamped to 32 bits, as entry sizes
+// are), or 0 if it doesn't exist
+// -----------------------------------------------------------------------------
+uint32_t fileSize(const string& path)
+{
+	std::error_code ec;
+	const auto      size = std::filesystem::file_size(path, ec);
+	if (ec)
+		return 0;
+
+	return static_cast<uint32_t>(std::min<uintmax_t>(size, std::numeric_limits<uint32_t>::max()));
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // DirArchive Class Functions
@@ -87,6 +114,8 @@ DirArchive::DirArchive() : Archive("folder"), ignore_hidden_{ archive_dir_ignore
 // -----------------------------------------------------------------------------
 bool DirArchive::open(string_view filename)
 {
+	TRACE_ZONE("DirArchive::open");
+
 	ui::setSplashProgressMessage("Reading directory structure");
 	ui::setSplashProgress(0);
 	vector<string>      files, dirs;
@@ -110,9 +139,9 @@ bool DirArchive::open(string_view filename)
 
 		// log::info(3, fn.GetPath(true, wxPATH_UNIX));
 
-		// Create entry
+		// Create entry (data is loaded when first needed)
 		auto fn        = strutil::Path{ name };
-		auto new_entry = std::make_shared<ArchiveEntry>(fn.fileName());
+		auto new_entry = std::make_shared<ArchiveEntry>(fn.fileName(), fileSize(files[a]));
 
 		// Setup entry info
 		new_entry->setLoaded(false);
@@ -123,19 +152,10 @@ bool DirArchive::open(string_view filename)
 		ndir->addEntry(new_entry);
 		ndir->dirEntry()->exProp("filePath") = fmt::format("{}{}", filename, fn.path());
 
-		// Read entry data
-		if (!new_entry->importFile(files[a]))
-			return false;
-		new_entry->setLoaded(true);
-
 		file_modification_times_[new_entry.get()] = fileutil::fileModifiedTime(files[a]);
 
 		// Detect entry type
-		EntryType::detectEntryType(*new_entry);
-
-		// Unload data if needed
-		if (!archive_load_data)
-			new_entry->unloadData();
+		detectNewEntryType(*new_entry);
 	}
 
 	// Add empty directories
@@ -164,6 +184,11 @@ bool DirArchive::open(string_view filename)
 	setModified(false);
 	on_disk_ = true;
 
+	// Watch for changes on disk (if supported), so they can be checked without
+	// rescanning the whole directory
+	if (archive_dir_watch_changes)
+		watcher_ = std::make_unique<DirWatcher>(filename, ignore_hidden_);
+
 	ui::setSplashProgressMessage("");
 
 	return true;
@@ -209,6 +234,8 @@ bool DirArchive::write(string_view filename, bool update)
 // -----------------------------------------------------------------------------
 bool DirArchive::save(string_view filename)
 {
+	TRACE_ZONE("DirArchive::save");
+
 	save_errors_ = false;
 
 	// Get flat entry list
@@ -232,6 +259,18 @@ bool DirArchive::save(string_view filename)
 	dir.Traverse(traverser, "", wxDIR_FILES | wxDIR_DIRS);
 	log::info(2, "GetAllFiles took {}ms", app::runTimer() - time);
 
+	// Load data for any entries that need to be written, as their existing
+	// files (eg. renamed entries) may be removed below
+	for (unsigned a = 0; a < entries.size(); a++)
+	{
+		if (entries[a]->type() == EntryType::folderType() || entries[a]->isLoaded())
+			continue;
+
+		if (entries[a]->state() != ArchiveEntry::State::Unmodified
+			|| entries[a]->exProps().getOr<string>("filePath", "") != entry_paths[a])
+			entries[a]->data();
+	}
+
 	// Check for any files to remove
 	time = app::runTimer();
 	for (const auto& removed_file : removed_files_)
@@ -245,21 +284,11 @@ bool DirArchive::save(string_view filename)
 	}
 
 	// Check for any directories to remove
+	const std::unordered_set<string> entry_path_set{ entry_paths.begin(), entry_paths.end() };
 	for (int a = static_cast<int>(dirs.size()) - 1; a >= 0; a--)
 	{
-		// Check if dir path matches an existing dir
-		bool found = false;
-		for (const auto& entry_path : entry_paths)
-		{
-			if (dirs[a] == entry_path)
-			{
-				found = true;
-				break;
-			}
-		}
-
 		// Dir on disk isn't part of the archive in memory
-		if (!found)
+		if (entry_path_set.count(dirs[a]) == 0)
 		{
 			if (!fileutil::removeDir(dirs[a]))
 				save_errors_ = true;
@@ -321,12 +350,29 @@ bool DirArchive::save(string_view filename)
 // -----------------------------------------------------------------------------
 bool DirArchive::loadEntryData(ArchiveEntry* entry)
 {
-	if (entry->importFile(entry->exProp<string>("filePath")))
+	const auto path = entry->exProp<string>("filePath");
+
+	// Only read the start of the file if detecting the entry type (see
+	// detectNewEntryType), the entry isn't considered loaded
+	if (detect_read_size_ > 0)
+	{
+		auto& data = entry->data(false);
+		if (!data.hasData())
+			data.importFile(path, 0, detect_read_size_);
+
+		return false;
+	}
+
+	if (entry->importFile(path))
 	{
-		file_modification_times_[entry] = fileutil::fileModifiedTime(entry->exProp<string>("filePath"));
+		file_modification_times_[entry] = fileutil::fileModifiedTime(path);
 		entry->setLoaded();
 		entry->setState(ArchiveEntry::State::Unmodified);
 
+		// Detect the type properly now all the data is available
+		if (header_typed_entries_.erase(entry) > 0)
+			EntryType::detectEntryType(*entry);
+
 		return true;
 	}
 
@@ -418,6 +464,8 @@ bool DirArchive::removeEntry(ArchiveEntry* entry, bool set_deleted)
 	if (!checkEntry(entry))
 		return false;
 
+	header_typed_entries_.erase(entry);
+
 	if (entry->exProps().contains("filePath"))
 	{
 		// If it exists on disk we need to update removed_files_
@@ -489,6 +537,8 @@ Archive::MapDesc DirArchive::mapDesc(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 vector<Archive::MapDesc> DirArchive::detectMaps()
 {
+	TRACE_ZONE("DirArchive::detectMaps");
+
 	vector<MapDesc> ret;
 
 	// Get the maps directory
@@ -649,6 +699,7 @@ void DirArchive::updateChangedEntries(vector<DirEntryChange>& changes)
 		{
 			auto entry = entryAtPath(change.entry_path);
 			entry->importFile(change.file_path);
+			header_typed_entries_.erase(entry);
 			EntryType::detectEntryType(*entry);
 			file_modification_times_[entry] = fileutil::fileModifiedTime(change.file_path);
 		}
@@ -688,9 +739,9 @@ void DirArchive::updateChangedEntries(vector<DirEntryChange>& changes)
 				name.erase(0, 1);
 			std::replace(name.begin(), name.end(), '\\', '/');
 
-			// Create entry
+			// Create entry (data is loaded when first needed)
 			strutil::Path fn(name);
-			auto          new_entry = std::make_shared<ArchiveEntry>(fn.fileName());
+			auto          new_entry = std::make_shared<ArchiveEntry>(fn.fileName(), fileSize(change.file_path));
 
 			// Setup entry info
 			new_entry->setLoaded(false);
@@ -700,18 +751,10 @@ void DirArchive::updateChangedEntries(vector<DirEntryChange>& changes)
 			auto ndir = createDir(fn.path());
 			Archive::addEntry(new_entry, -1, ndir.get());
 
-			// Read entry data
-			new_entry->importFile(change.file_path);
-			new_entry->setLoaded(true);
-
 			file_modification_times_[new_entry.get()] = fileutil::fileModifiedTime(change.file_path);
 
 			// Detect entry type
-			EntryType::detectEntryType(*new_entry);
-
-			// Unload data if needed
-			if (!archive_load_data)
-				new_entry->unloadData();
+			detectNewEntryType(*new_entry);
 
 			// Set entry not modified
 			new_entry->setState(ArchiveEntry::State::Unmodified);
@@ -753,3 +796,40 @@ bool DirArchive::shouldIgnoreEntryChange(const DirEntryChange& change)
 	// and an unmodified file will never change mtime.)
 	return (old_change.mtime == change.mtime);
 }
+
+// -----------------------------------------------------------------------------
+// Detects the type of [entry] without loading all of its data from disk.
+// Files larger than archive_dir_detect_read_kb are detected from the start of
+// the file only, and detected again once their data is fully loaded (see
+// loadEntryData). Until then, formats that need more than the start of the
+// file to be detected (eg. wads, zips, doom gfx) may not be recognised
+// -----------------------------------------------------------------------------
+void DirArchive::detectNewEntryType(ArchiveEntry& entry)
+{
+	const auto read_size = static_cast<uint32_t>(std::max<int>(archive_dir_detect_read_kb, 1)) * 1024;
+
+	// Maps (wads in the maps folder) need all their data to be detected
+	const bool is_map = entry.parentDir() && entry.parentDir()->parent() == rootDir()
+						&& entry.parentDir()->name() == "maps";
+
+	if (entry.size() <= read_size || is_map)
+	{
+		// Read all data (before detecting, since loading resets the type)
+		entry.data();
+		EntryType::detectEntryType(entry);
+		if (!archive_load_data)
+			entry.unloadData();
+
+		return;
+	}
+
+	// Read the start of the file only
+	detect_read_size_ = read_size;
+	EntryType::detectEntryType(entry);
+	detect_read_size_ = 0;
+	entry.data(false).clear();
+	header_typed_entries_.insert(&entry);
+
+	if (archive_load_data)
+		entry.data();
+}
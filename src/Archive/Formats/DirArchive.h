@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Archive/Archive.h"
+#include "Utility/DirWatcher.h"
 
 namespace slade
 {
@@ -40,6 +41,7 @@ public:
 	time_t                fileModificationTime(ArchiveEntry* entry) { return file_modification_times_[entry]; }
 	bool                  hiddenFilesIgnored() const { return ignore_hidden_; }
 	bool                  saveErrorsOccurred() const { return save_errors_; }
+	DirWatcher*           watcher() const { return watcher_.get(); }
 
 	// Opening
 	bool open(string_view filename) override; // Open from File
@@ -78,13 +80,18 @@ public:
 	bool shouldIgnoreEntryChange(const DirEntryChange& change);
 
 private:
-	char                            separator_;
-	vector<StringPair>              renamed_dirs_;
-	std::map<ArchiveEntry*, time_t> file_modification_times_;
-	vector<string>                  removed_files_;
-	IgnoredFileChanges              ignored_file_changes_;
-	bool                            ignore_hidden_;
-	bool                            save_errors_ = false;
+	char                              separator_;
+	vector<StringPair>                renamed_dirs_;
+	std::map<ArchiveEntry*, time_t>   file_modification_times_;
+	vector<string>                    removed_files_;
+	IgnoredFileChanges                ignored_file_changes_;
+	bool                              ignore_hidden_;
+	bool                              save_errors_ = false;
+	unique_ptr<DirWatcher>            watcher_;
+	std::unordered_set<ArchiveEntry*> header_typed_entries_; // Types detected from partial data
+	uint32_t                          detect_read_size_ = 0;
+
+	void detectNewEntryType(ArchiveEntry& entry);
 };
 
 class DirArchiveTraverser : public wxDirTraverser
@@ -32,6 +32,7 @@
 #include "Main.h"
 #include "WadArchive.h"
 #include "General/Misc.h"
+#include "General/Trace.h"
 #include "General/UI.h"
 #include "Utility/StringUtils.h"
 #include "Utility/Tokenizer.h"
@@ -167,6 +168,8 @@ void WadArchive::setEntryOffset(ArchiveEntry* entry, uint32_t offset)
 // -----------------------------------------------------------------------------
 void WadArchive::updateNamespaces()
 {
+	TRACE_ZONE("WadArchive::updateNamespaces");
+
 	// Clear current namespace info
 	while (!namespaces_.empty())
 		namespaces_.pop_back();
@@ -320,6 +323,8 @@ bool WadArchive::hasFlatHack()
 // -----------------------------------------------------------------------------
 bool WadArchive::open(MemChunk& mc)
 {
+	TRACE_ZONE("WadArchive::open");
+
 	// Check data was given
 	if (!mc.hasData())
 		return false;
@@ -528,6 +533,8 @@ bool WadArchive::open(MemChunk& mc)
 // -----------------------------------------------------------------------------
 bool WadArchive::write(MemChunk& mc, bool update)
 {
+	TRACE_ZONE("WadArchive::write");
+
 	// Don't write if iwad
 	if (iwad_ && iwad_lock)
 	{
@@ -1021,6 +1028,8 @@ Archive::MapDesc WadArchive::mapDesc(ArchiveEntry* maphead)
 // -----------------------------------------------------------------------------
 vector<Archive::MapDesc> WadArchive::detectMaps()
 {
+	TRACE_ZONE("WadArchive::detectMaps");
+
 	vector<MapDesc> maps;
 
 	// Go through all lumps
@@ -1221,6 +1230,8 @@ string WadArchive::detectNamespace(unsigned index, ArchiveDir* dir)
 // -----------------------------------------------------------------------------
 void WadArchive::detectIncludes()
 {
+	TRACE_ZONE("WadArchive::detectIncludes");
+
 	// DECORATE: #include "lumpname"
 	// GLDEFS: #include "lumpname"
 	// SBARINFO: #include "lumpname"
@@ -33,6 +33,7 @@
 #include "ZipArchive.h"
 #include "App.h"
 #include "General/Misc.h"
+#include "General/Trace.h"
 #include "General/UI.h"
 #include "UI/WxUtils.h"
 #include "Utility/FileUtils.h"
@@ -90,6 +91,8 @@ ZipArchive::~ZipArchive()
 // -----------------------------------------------------------------------------
 bool ZipArchive::open(string_view filename)
 {
+	TRACE_ZONE("ZipArchive::open");
+
 	// Check the file exists
 	if (!fileutil::fileExists(filename))
 	{
@@ -163,6 +166,9 @@ bool ZipArchive::open(string_view filename)
 				// Determine its type
 				EntryType::detectEntryType(*new_entry);
 
+				// The zip directory already has the CRC-32 of the data
+				new_entry->setContentHash(static_cast<uint32_t>(zip_entry->GetCrc()));
+
 				// Unload data if needed
 				if (!archive_load_data)
 					new_entry->unloadData();
@@ -232,6 +238,8 @@ bool ZipArchive::open(MemChunk& mc)
 // -----------------------------------------------------------------------------
 bool ZipArchive::write(MemChunk& mc, bool update)
 {
+	TRACE_ZONE("ZipArchive::write");
+
 	bool success = false;
 
 	// Write to a temporary file
@@ -254,6 +262,8 @@ bool ZipArchive::write(MemChunk& mc, bool update)
 // -----------------------------------------------------------------------------
 bool ZipArchive::write(string_view filename, bool update)
 {
+	TRACE_ZONE("ZipArchive::write (file)");
+
 	// Check for entries with duplicate names (not allowed for zips)
 	auto all_dirs = rootDir()->allDirectories();
 	all_dirs.insert(all_dirs.begin(), rootDir());
@@ -519,6 +529,8 @@ Archive::MapDesc ZipArchive::mapDesc(ArchiveEntry* maphead)
 // -----------------------------------------------------------------------------
 vector<Archive::MapDesc> ZipArchive::detectMaps()
 {
+	TRACE_ZONE("ZipArchive::detectMaps");
+
 	vector<MapDesc> ret;
 
 	// Get the maps directory
@@ -0,0 +1,455 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2022 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    BenchMain.cpp
+// Description: Entry point for the slade-bench executable, which runs
+//              benchmarks of archive, map and image hot paths on synthetic
+//              data and writes the results as JSON
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "App.h"
+#include "Archive/EntryType/EntryType.h"
+#include "Benchmark.h"
+#include "Fixtures.h"
+#include "General/ResourceManager.h"
+#include "Graphics/CTexture/CTexture.h"
+#include "Graphics/SImage/SImage.h"
+#include "MapEditor/MapChecks.h"
+#include "SLADEMap/MapFormat/UniversalDoomMapFormat.h"
+#include "SLADEMap/MapObjectCollection.h"
+#include "SLADEMap/SLADEMap.h"
+#include "Utility/FileUtils.h"
+#include "Utility/Polygon2D.h"
+#include "Utility/PolygonTriangulator.h"
+#include "Utility/StringUtils.h"
+#include <random>
+
+using namespace slade;
+using namespace bench;
+
+
+// -----------------------------------------------------------------------------
+//
+// External Variables
+//
+// -----------------------------------------------------------------------------
+EXTERN_CVAR(Int, ctexture_cache_size)
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Fixture sizes
+// -----------------------------------------------------------------------------
+struct Sizes
+{
+	unsigned wad_lumps;
+	unsigned pk3_depth;
+	unsigned pk3_subdirs;
+	unsigned pk3_files;
+	unsigned detect_entries;
+	unsigned map_grid; // Map lines = 2 * grid * (grid + 1)
+	unsigned colour_lookups;
+	unsigned patches;
+	unsigned textures;
+	unsigned polygons;
+};
+const Sizes sizes_full{ 20000, 4, 4, 16, 6000, 100, 1000000, 256, 512, 4000 };
+const Sizes sizes_quick{ 2000, 3, 3, 8, 600, 30, 100000, 32, 64, 400 };
+
+// -----------------------------------------------------------------------------
+// Archive benchmarks: WadArchive::open, ZipArchive::open/write and
+// EntryType::detectEntryType
+// -----------------------------------------------------------------------------
+void benchArchives(Runner& runner, const Sizes& sizes, unsigned seed)
+{
+	if (runner.enabled("wad_open"))
+	{
+		MemChunk wad_data;
+		fixtures::wadData(wad_data, sizes.wad_lumps, seed);
+
+		unique_ptr<WadArchive> wad;
+		runner.run(
+			"wad_open",
+			{ { "lumps", sizes.wad_lumps }, { "bytes", wad_data.size() } },
+			[&]() { wad->open(wad_data); },
+			[&]() { wad = std::make_unique<WadArchive>(); });
+	}
+
+	if (runner.enabled("zip_write") || runner.enabled("zip_open"))
+	{
+		auto   zip      = fixtures::pk3Tree(sizes.pk3_depth, sizes.pk3_subdirs, sizes.pk3_files, seed);
+		Params params   = { { "entries", zip->numEntries() },
+							{ "depth", sizes.pk3_depth },
+							{ "subdirs", sizes.pk3_subdirs },
+							{ "files_per_dir", sizes.pk3_files } };
+		auto   zip_file = app::path("slade-bench.pk3", app::Dir::Temp);
+
+		// Write
+		MemChunk zip_data;
+		runner.run(
+			"zip_write", params, [&]() { zip->write(zip_data, false); }, [&]() { zip_data.clear(); });
+
+		// Open
+		zip->write(zip_file, false);
+		unique_ptr<ZipArchive> opened;
+		runner.run(
+			"zip_open",
+			params,
+			[&]() { opened->open(zip_file); },
+			[&]() { opened = std::make_unique<ZipArchive>(); });
+
+		opened.reset();
+		fileutil::removeFile(zip_file);
+	}
+
+	if (runner.enabled("detect_entry_types"))
+	{
+		auto                  wad = fixtures::mixedEntryWad(sizes.detect_entries, seed);
+		vector<ArchiveEntry*> entries;
+		wad->putEntryTreeAsList(entries);
+
+		runner.run(
+			"detect_entry_types",
+			{ { "entries", static_cast<int64_t>(entries.size()) } },
+			[&]()
+			{
+				for (auto* entry : entries)
+					EntryType::detectEntryType(*entry);
+			});
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Map benchmarks: UniversalDoomMapFormat::readMap/writeMap and map checks
+// -----------------------------------------------------------------------------
+void benchMaps(Runner& runner, const Sizes& sizes, unsigned seed)
+{
+	// Get map checks to run (except unknown textures/flats, which need an
+	// OpenGL context)
+	vector<MapCheck::StandardCheck> checks;
+	for (int a = 0; a < MapCheck::NumStandardChecks; ++a)
+	{
+		auto type = static_cast<MapCheck::StandardCheck>(a);
+		if (type != MapCheck::UnknownTexture && type != MapCheck::UnknownFlat
+			&& runner.enabled(fmt::format("map_check_{}", MapCheck::standardCheckId(type))))
+			checks.push_back(type);
+	}
+
+	if (checks.empty() && !runner.enabled("udmf_read_map") && !runner.enabled("udmf_write_map"))
+		return;
+
+	auto wad  = fixtures::udmfMapWad(sizes.map_grid, seed);
+	auto maps = wad->detectMaps();
+	if (maps.empty())
+	{
+		log::error("Benchmark UDMF map not detected");
+		return;
+	}
+	const auto& map_desc = maps[0];
+
+	Params params = { { "lines", 2 * sizes.map_grid * (sizes.map_grid + 1) },
+					  { "sectors", sizes.map_grid * sizes.map_grid },
+					  { "bytes", map_desc.head.lock()->nextEntry()->size() } };
+
+	// Read
+	UniversalDoomMapFormat          udmf;
+	unique_ptr<MapObjectCollection> map_data;
+	PropertyList                    map_props;
+	runner.run(
+		"udmf_read_map",
+		params,
+		[&]() { udmf.readMap(map_desc, *map_data, map_props); },
+		[&]()
+		{
+			map_data = std::make_unique<MapObjectCollection>();
+			map_props.clear();
+		});
+
+	// Write
+	if (!map_data)
+	{
+		map_data = std::make_unique<MapObjectCollection>();
+		udmf.readMap(map_desc, *map_data, map_props);
+	}
+	runner.run("udmf_write_map", params, [&]() { udmf.writeMap(*map_data, map_props); });
+	map_data.reset();
+
+	// Map checks
+	if (checks.empty())
+		return;
+	SLADEMap map;
+	map.readMap(map_desc);
+	for (auto type : checks)
+	{
+		runner.run(
+			fmt::format("map_check_{}", MapCheck::standardCheckId(type)),
+			params,
+			[&]()
+			{
+				auto check = MapCheck::standardCheck(type, &map);
+				check->doCheck();
+			});
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Graphics benchmarks: Palette::nearestColour and CTexture::toImage
+// -----------------------------------------------------------------------------
+void benchGraphics(Runner& runner, const Sizes& sizes, unsigned seed)
+{
+	auto palette = fixtures::randomPalette(seed);
+
+	if (runner.enabled("palette_nearest_colour"))
+	{
+		// Random colours to look up
+		std::mt19937    rng(seed);
+		vector<ColRGBA> colours(sizes.colour_lookups);
+		for (auto& colour : colours)
+			colour.set(static_cast<uint8_t>(rng()), static_cast<uint8_t>(rng()), static_cast<uint8_t>(rng()), 255);
+
+		// Use a new palette each time, so that lookups aren't already cached
+		unique_ptr<Palette> pal;
+		runner.run(
+			"palette_nearest_colour",
+			{ { "lookups", sizes.colour_lookups } },
+			[&]()
+			{
+				for (const auto& colour : colours)
+					pal->nearestColour(colour);
+			},
+			[&]() { pal = std::make_unique<Palette>(palette); });
+	}
+
+	if (runner.enabled("ctexture_to_image"))
+	{
+		auto wad = fixtures::patchWad(sizes.patches, palette, seed);
+		app::resources().addArchive(wad.get());
+
+		// Textures 256x128, each made of 4 to 12 random patches
+		std::mt19937     rng(seed);
+		vector<CTexture> textures(sizes.textures);
+		for (unsigned a = 0; a < textures.size(); ++a)
+		{
+			auto& tex = textures[a];
+			tex.setName(fmt::format("TEX{:05d}", a));
+			tex.setWidth(256);
+			tex.setHeight(128);
+
+			auto n_patches = 4 + rng() % 9;
+			for (unsigned p = 0; p < n_patches; ++p)
+				tex.addPatch(
+					fmt::format("PAT{:05d}", rng() % sizes.patches),
+					static_cast<int16_t>(static_cast<int>(rng() % 256) - 32),
+					static_cast<int16_t>(static_cast<int>(rng() % 128) - 64));
+		}
+
+		// Disable the patch/texture image cache, so that every iteration
+		// actually composites the textures
+		int cache_size      = ctexture_cache_size;
+		ctexture_cache_size = 0;
+
+		SImage image;
+		runner.run(
+			"ctexture_to_image",
+			{ { "textures", sizes.textures }, { "patches", sizes.patches } },
+			[&]()
+			{
+				for (auto& tex : textures)
+					tex.toImage(image, wad.get(), &palette);
+			});
+
+		ctexture_cache_size = cache_size;
+		app::resources().removeArchive(wad.get());
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Polygon benchmarks: PolygonTriangulator::triangulate.
+// Also checks that each triangulated polygon covers exactly the area it should,
+// returns false if any don't
+// -----------------------------------------------------------------------------
+bool benchPolygons(Runner& runner, const Sizes& sizes, unsigned seed)
+{
+	if (!runner.enabled("triangulate_polygons"))
+		return true;
+
+	auto     polygons = fixtures::polygons(sizes.polygons, seed);
+	unsigned n_edges  = 0;
+	for (const auto& polygon : polygons)
+		n_edges += polygon.edges.size();
+
+	auto triangulate = [](const fixtures::PolygonEdges& polygon, PolygonTriangulator& triangulator, Polygon2D& poly)
+	{
+		for (const auto& edge : polygon.edges)
+			triangulator.addEdge(edge[0], edge[1], edge[2], edge[3]);
+		triangulator.triangulate(&poly);
+	};
+
+	runner.run(
+		"triangulate_polygons",
+		{ { "polygons", sizes.polygons }, { "edges", n_edges } },
+		[&]()
+		{
+			for (const auto& polygon : polygons)
+			{
+				PolygonTriangulator triangulator;
+				Polygon2D           poly;
+				triangulate(polygon, triangulator, poly);
+			}
+		});
+
+	// Check areas (allowing for float vertex precision, as Polygon2D::openSector does)
+	unsigned n_bad = 0;
+	for (unsigned a = 0; a < polygons.size(); ++a)
+	{
+		const auto&         polygon = polygons[a];
+		PolygonTriangulator triangulator;
+		Polygon2D           poly;
+		triangulate(polygon, triangulator, poly);
+
+		auto tolerance = std::max(1., polygon.area * 0.0001);
+		if (std::abs(triangulator.area() - polygon.area) > tolerance || std::abs(poly.area() - polygon.area) > tolerance)
+		{
+			fmt::print(
+				stderr,
+				"Polygon #{} ({}): area {:.1f}, outlines {:.1f}, triangulated {:.1f}\n",
+				a,
+				polygon.shape,
+				polygon.area,
+				triangulator.area(),
+				poly.area());
+			n_bad++;
+		}
+	}
+
+	if (n_bad > 0)
+		fmt::print(stderr, "Triangulator check failed: {} of {} polygons with mismatched area\n", n_bad, polygons.size());
+
+	return n_bad == 0;
+}
+
+// -----------------------------------------------------------------------------
+// Prints command line usage info
+// -----------------------------------------------------------------------------
+void printUsage()
+{
+	fmt::print(
+		"Usage: slade-bench [options]\n"
+		"\n"
+		"  --quick               Use smaller fixtures\n"
+		"  --iterations <n>      Timed iterations per benchmark (default 5)\n"
+		"  --filter <text>       Only run benchmarks with names containing <text>\n"
+		"  --seed <n>            Seed for generating fixtures (default 1234)\n"
+		"  --output <file>       Write JSON results to <file> instead of stdout\n"
+		"\n"
+		"Exits with status 1 if the triangulate_polygons area check fails\n");
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+// Benchmark entry point
+// -----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+	bool     quick      = false;
+	unsigned iterations = 5;
+	unsigned seed       = 1234;
+	string   filter;
+	string   output;
+
+	// Process command line
+	for (int a = 1; a < argc; a++)
+	{
+		string_view arg = argv[a];
+		bool        has_value = a + 1 < argc;
+
+		if (arg == "--quick")
+			quick = true;
+		else if (arg == "--iterations" && has_value)
+			iterations = std::max(1, strutil::asInt(argv[++a]));
+		else if (arg == "--filter" && has_value)
+			filter = argv[++a];
+		else if (arg == "--seed" && has_value)
+			seed = static_cast<unsigned>(strutil::asInt(argv[++a]));
+		else if (arg == "--output" && has_value)
+			output = argv[++a];
+		else
+		{
+			printUsage();
+			return arg == "--help" || arg == "-h" ? 0 : 2;
+		}
+	}
+
+	// Init wx as a console app and SLADE without a user interface (see BatchMain.cpp)
+	wxApp::SetInstance(new wxAppConsole);
+	wxInitializer initializer(argc, argv);
+	if (!initializer.IsOk())
+	{
+		fmt::print(stderr, "Failed to initialise wxWidgets\n");
+		return 1;
+	}
+#ifdef __WINDOWS__
+	wxTheApp->SetAppName("SLADE3");
+#else
+	wxTheApp->SetAppName("slade3");
+#endif
+	if (!app::initHeadless())
+	{
+		fmt::print(stderr, "SLADE initialisation failed\n");
+		for (const auto& msg : log::history())
+			if (msg.type == log::MessageType::Error)
+				fmt::print(stderr, "{}\n", msg.formattedMessageLine());
+		return 1;
+	}
+
+	// Run benchmarks
+	const auto& sizes = quick ? sizes_quick : sizes_full;
+	Runner      runner(iterations, filter);
+	benchArchives(runner, sizes, seed);
+	benchMaps(runner, sizes, seed);
+	benchGraphics(runner, sizes, seed);
+	auto polygons_ok = benchPolygons(runner, sizes, seed);
+
+	// Output results
+	auto json = runner.json(seed, quick);
+	if (output.empty())
+		fmt::print("{}", json);
+	else if (!fileutil::writeStringToFile(json, output))
+		fmt::print(stderr, "Unable to write results to {}\n", output);
+
+	app::exitHeadless();
+
+	return polygons_ok ? 0 : 1;
+}
@@ -0,0 +1,176 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2022 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    Benchmark.cpp
+// Description: Benchmark runner, times benchmark functions over a number of
+//              iterations and writes the results as JSON
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "Benchmark.h"
+#include "App.h"
+#include "Utility/StringUtils.h"
+#include <chrono>
+#include <numeric>
+
+using namespace slade;
+using namespace bench;
+
+
+// -----------------------------------------------------------------------------
+//
+// Result Struct Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns the fastest time (in milliseconds)
+// -----------------------------------------------------------------------------
+double Result::min() const
+{
+	return times_ms.empty() ? 0. : *std::min_element(times_ms.begin(), times_ms.end());
+}
+
+// -----------------------------------------------------------------------------
+// Returns the slowest time (in milliseconds)
+// -----------------------------------------------------------------------------
+double Result::max() const
+{
+	return times_ms.empty() ? 0. : *std::max_element(times_ms.begin(), times_ms.end());
+}
+
+// -----------------------------------------------------------------------------
+// Returns the mean time (in milliseconds)
+// -----------------------------------------------------------------------------
+double Result::mean() const
+{
+	return times_ms.empty() ? 0. : std::accumulate(times_ms.begin(), times_ms.end(), 0.) / times_ms.size();
+}
+
+// -----------------------------------------------------------------------------
+// Returns the median time (in milliseconds)
+// -----------------------------------------------------------------------------
+double Result::median() const
+{
+	if (times_ms.empty())
+		return 0.;
+
+	auto sorted = times_ms;
+	std::sort(sorted.begin(), sorted.end());
+	auto mid = sorted.size() / 2;
+	return sorted.size() % 2 ? sorted[mid] : (sorted[mid - 1] + sorted[mid]) * 0.5;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Runner Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns true if the benchmark [name] should be run (matches the filter)
+// -----------------------------------------------------------------------------
+bool Runner::enabled(string_view name) const
+{
+	return filter_.empty() || strutil::contains(name, filter_);
+}
+
+// -----------------------------------------------------------------------------
+// Runs benchmark [name] with [params]: calls [setup] (untimed, if given) and
+// then [func] (timed) for each iteration, after one untimed warm-up run
+// -----------------------------------------------------------------------------
+void Runner::run(
+	string_view                  name,
+	const Params&                params,
+	const std::function<void()>& func,
+	const std::function<void()>& setup)
+{
+	if (!enabled(name))
+		return;
+
+	Result result{ string{ name }, params, {} };
+
+	// Warm-up
+	if (setup)
+		setup();
+	func();
+
+	for (unsigned a = 0; a < iterations_; ++a)
+	{
+		if (setup)
+			setup();
+
+		auto start = std::chrono::steady_clock::now();
+		func();
+		auto end = std::chrono::steady_clock::now();
+
+		result.times_ms.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+	}
+
+	fmt::print(stderr, "{:<32} median {:10.3f}ms  min {:10.3f}ms\n", name, result.median(), result.min());
+	results_.push_back(std::move(result));
+}
+
+// -----------------------------------------------------------------------------
+// Returns all results as a JSON document, including the fixture [seed] and
+// whether the [quick] (smaller) fixtures were used so runs can be compared
+// -----------------------------------------------------------------------------
+string Runner::json(unsigned seed, bool quick) const
+{
+	string out = "{\n";
+	out += fmt::format("  \"version\": \"{}\",\n", app::version().toString());
+	out += fmt::format("  \"seed\": {},\n", seed);
+	out += fmt::format("  \"quick\": {},\n", quick ? "true" : "false");
+	out += fmt::format("  \"iterations\": {},\n", iterations_);
+	out += "  \"benchmarks\": [\n";
+
+	for (unsigned a = 0; a < results_.size(); ++a)
+	{
+		const auto& result = results_[a];
+
+		string params;
+		for (const auto& [key, value] : result.params)
+			params += fmt::format("{}\"{}\": {}", params.empty() ? "" : ", ", key, value);
+
+		out += fmt::format(
+			"    {{ \"name\": \"{}\", \"params\": {{ {} }}, \"min_ms\": {:.4f}, \"median_ms\": {:.4f}, "
+			"\"mean_ms\": {:.4f}, \"max_ms\": {:.4f} }}{}\n",
+			result.name,
+			params,
+			result.min(),
+			result.median(),
+			result.mean(),
+			result.max(),
+			a + 1 < results_.size() ? "," : "");
+	}
+
+	out += "  ]\n}\n";
+	return out;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+namespace slade::bench
+{
+// A named numeric parameter of a benchmark (eg. number of lumps)
+using Param  = std::pair<string, int64_t>;
+using Params = vector<Param>;
+
+// The timings of a single benchmark
+struct Result
+{
+	string         name;
+	Params         params;
+	vector<double> times_ms;
+
+	double min() const;
+	double max() const;
+	double mean() const;
+	double median() const;
+};
+
+class Runner
+{
+public:
+	Runner(unsigned iterations, string_view filter = "") : iterations_{ iterations }, filter_{ filter } {}
+
+	const vector<Result>& results() const { return results_; }
+
+	bool enabled(string_view name) const;
+	void run(
+		string_view                  name,
+		const Params&                params,
+		const std::function<void()>& func,
+		const std::function<void()>& setup = {});
+
+	string json(unsigned seed, bool quick) const;
+
+private:
+	unsigned       iterations_ = 1;
+	string         filter_;
+	vector<Result> results_;
+};
+} // namespace slade::bench
@@ -0,0 +1,590 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2022 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    Fixtures.cpp
+// Description: Generators for the synthetic data used by the benchmarks
+//              (archives, maps, palettes and images)
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "Fixtures.h"
+#include "Graphics/SImage/SIFormat.h"
+#include "Graphics/SImage/SImage.h"
+#include "Utility/MathStuff.h"
+#include <iterator>
+#include <random>
+
+using namespace slade;
+using namespace bench;
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// Words to build text lumps from, so they look (and compress) like real text
+const char* const words[] = { "actor", "states", "spawn",  "goto",  "loop", "stop", "health", "radius",
+							  "height", "speed", "damage", "monster", "A_Look", "A_Chase", "TNT1", "POSS" };
+
+// -----------------------------------------------------------------------------
+// Returns [size] bytes of random data
+// -----------------------------------------------------------------------------
+vector<uint8_t> randomData(std::mt19937& rng, unsigned size)
+{
+	vector<uint8_t> data(size);
+	for (auto& byte : data)
+		byte = static_cast<uint8_t>(rng());
+
+	return data;
+}
+
+// -----------------------------------------------------------------------------
+// Returns roughly [size] bytes of random (compressible) text
+// -----------------------------------------------------------------------------
+vector<uint8_t> randomText(std::mt19937& rng, unsigned size)
+{
+	string text;
+	while (text.size() < size)
+	{
+		text += words[rng() % std::size(words)];
+		text += rng() % 8 == 0 ? '\n' : ' ';
+	}
+
+	return { text.begin(), text.end() };
+}
+
+// -----------------------------------------------------------------------------
+// Returns a [width]x[height] paletted image written in image [format_id],
+// filled with random columns of colour
+// -----------------------------------------------------------------------------
+vector<uint8_t> randomImage(std::mt19937& rng, int width, int height, Palette& palette, string_view format_id)
+{
+	SImage image;
+	image.create(width, height, SImage::Type::PalMask, &palette);
+	for (int x = 0; x < width; ++x)
+	{
+		// Leave some transparent gaps at the top of columns so posts are split
+		auto top    = static_cast<int>(rng() % (height / 4 + 1));
+		auto colour = static_cast<uint8_t>(rng());
+		for (int y = top; y < height; ++y)
+			image.setPixel(x, y, static_cast<uint8_t>(colour + y / 8));
+	}
+
+	MemChunk data;
+	SIFormat::getFormat(format_id)->saveImage(image, data, &palette);
+	return { data.data(), data.data() + data.size() };
+}
+
+// -----------------------------------------------------------------------------
+// Returns [data] opened as a wad archive
+// -----------------------------------------------------------------------------
+unique_ptr<WadArchive> openWad(MemChunk& data)
+{
+	auto wad = std::make_unique<WadArchive>();
+	wad->open(data);
+	return wad;
+}
+
+// -----------------------------------------------------------------------------
+// Adds an entry named [name] containing [data] to the end of [archive]
+// -----------------------------------------------------------------------------
+void addEntry(Archive& archive, string_view name, const vector<uint8_t>& data, ArchiveDir* dir = nullptr)
+{
+	auto entry = std::make_shared<ArchiveEntry>(name);
+	entry->importMem(data.data(), static_cast<uint32_t>(data.size()));
+	archive.addEntry(entry, 0xFFFFFFFF, dir);
+}
+
+// -----------------------------------------------------------------------------
+// Adds [n_files] files to [dir] in [archive], and [n_subdirs] subdirectories
+// (recursively, [depth] levels deep)
+// -----------------------------------------------------------------------------
+void addTree(
+	ZipArchive&            archive,
+	shared_ptr<ArchiveDir> dir,
+	unsigned               depth,
+	unsigned               n_subdirs,
+	unsigned               n_files,
+	std::mt19937&          rng)
+{
+	for (unsigned a = 0; a < n_files; ++a)
+	{
+		// Mostly text (eg. scripts/definitions), some binary data
+		if (a % 4 == 3)
+			addEntry(archive, fmt::format("data{:03d}.dat", a), randomData(rng, 256 + rng() % 8192), dir.get());
+		else
+			addEntry(archive, fmt::format("text{:03d}.txt", a), randomText(rng, 256 + rng() % 8192), dir.get());
+	}
+
+	if (depth == 0)
+		return;
+
+	for (unsigned a = 0; a < n_subdirs; ++a)
+	{
+		auto subdir = archive.createDir(fmt::format("dir{:02d}", a), dir);
+		addTree(archive, subdir, depth - 1, n_subdirs, n_files, rng);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Adds edges for the closed loop of [points] to [poly], along with the area it
+// adds (clockwise loops) or removes (anticlockwise loops, ie. holes)
+// -----------------------------------------------------------------------------
+void addLoop(fixtures::PolygonEdges& poly, const vector<Vec2d>& points)
+{
+	double sum = 0.;
+	for (unsigned a = 0; a < points.size(); ++a)
+	{
+		auto& p1 = points[a];
+		auto& p2 = points[(a + 1) % points.size()];
+		poly.edges.push_back({ p1.x, p1.y, p2.x, p2.y });
+		sum += p1.x * p2.y - p2.x * p1.y;
+	}
+
+	poly.area -= sum * 0.5;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the points of a clockwise [width]x[height] rectangle at [x,y]
+// -----------------------------------------------------------------------------
+vector<Vec2d> rectangle(double x, double y, double width, double height)
+{
+	return { { x, y }, { x, y + height }, { x + width, y + height }, { x + width, y } };
+}
+
+// -----------------------------------------------------------------------------
+// Returns the points of a clockwise star with [n_points] points around [x,y],
+// alternating between [radius] and a random smaller radius. Points are on
+// whole map units, as most map vertices are
+// -----------------------------------------------------------------------------
+vector<Vec2d> star(std::mt19937& rng, double x, double y, unsigned n_points, double radius)
+{
+	auto          inner = radius * (0.2 + (rng() % 60) / 100.);
+	vector<Vec2d> points;
+	for (unsigned a = 0; a < n_points * 2; ++a)
+	{
+		auto angle = -math::PI * a / n_points;
+		auto r     = a % 2 ? inner : radius;
+		points.emplace_back(std::round(x + std::cos(angle) * r), std::round(y + std::sin(angle) * r));
+	}
+
+	return points;
+}
+
+// -----------------------------------------------------------------------------
+// Returns [points] in reverse order (ie. clockwise <-> anticlockwise)
+// -----------------------------------------------------------------------------
+vector<Vec2d> reversed(vector<Vec2d> points)
+{
+	std::reverse(points.begin(), points.end());
+	return points;
+}
+
+// -----------------------------------------------------------------------------
+// Returns [points] with each edge split into [n_splits] collinear edges
+// -----------------------------------------------------------------------------
+vector<Vec2d> splitEdges(const vector<Vec2d>& points, unsigned n_splits)
+{
+	vector<Vec2d> split;
+	for (unsigned a = 0; a < points.size(); ++a)
+	{
+		auto& p1 = points[a];
+		auto& p2 = points[(a + 1) % points.size()];
+		for (unsigned b = 0; b < n_splits; ++b)
+			split.emplace_back(p1.x + (p2.x - p1.x) * b / n_splits, p1.y + (p2.y - p1.y) * b / n_splits);
+	}
+
+	return split;
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Fixtures Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Writes a wad file with [n_lumps] lumps of random data to [out]
+// -----------------------------------------------------------------------------
+void fixtures::wadData(MemChunk& out, unsigned n_lumps, unsigned seed)
+{
+	std::mt19937 rng(seed);
+
+	WadArchive wad;
+	for (unsigned a = 0; a < n_lumps; ++a)
+		addEntry(wad, fmt::format("LMP{:05d}", a), randomData(rng, rng() % 4096));
+
+	wad.write(out, false);
+}
+
+// -----------------------------------------------------------------------------
+// Returns a zip archive with a directory tree [depth] levels deep, each
+// directory having [n_subdirs] subdirectories and [n_files] files
+// -----------------------------------------------------------------------------
+unique_ptr<ZipArchive> fixtures::pk3Tree(unsigned depth, unsigned n_subdirs, unsigned n_files, unsigned seed)
+{
+	std::mt19937 rng(seed);
+
+	auto zip = std::make_unique<ZipArchive>();
+	addTree(*zip, zip->rootDir(), depth, n_subdirs, n_files, rng);
+	return zip;
+}
+
+// -----------------------------------------------------------------------------
+// Returns a wad archive with [n_entries] entries of various types (graphics,
+// flats, text, sounds and unknown data) for type detection
+// -----------------------------------------------------------------------------
+unique_ptr<WadArchive> fixtures::mixedEntryWad(unsigned n_entries, unsigned seed)
+{
+	std::mt19937 rng(seed);
+	auto         palette = randomPalette(seed);
+
+	WadArchive wad;
+	for (unsigned a = 0; a < n_entries; ++a)
+	{
+		auto name = fmt::format("ENT{:05d}", a);
+		switch (a % 6)
+		{
+		case 0: addEntry(wad, name, randomImage(rng, 32 + rng() % 96, 32 + rng() % 96, palette, "doom")); break;
+		case 1: addEntry(wad, name, randomImage(rng, 32 + rng() % 96, 32 + rng() % 96, palette, "png")); break;
+		case 2: addEntry(wad, name, randomData(rng, 4096)); break; // Flat-sized
+		case 3: addEntry(wad, name, randomText(rng, 512 + rng() % 4096)); break;
+		case 4:
+		{
+			// Doom sound
+			auto n_samples = 1024 + rng() % 8192;
+			auto sound     = randomData(rng, 8 + n_samples);
+			sound[0]       = 3; // Format
+			sound[1]       = 0;
+			sound[2]       = 11025 & 0xFF; // Sample rate
+			sound[3]       = 11025 >> 8;
+			for (unsigned b = 0; b < 4; ++b)
+				sound[4 + b] = (n_samples >> (b * 8)) & 0xFF; // Sample count
+			addEntry(wad, name, sound);
+			break;
+		}
+		default: addEntry(wad, name, randomData(rng, rng() % 2048)); break;
+		}
+	}
+
+	// Reopen so the entries are as they would be when opening a wad normally
+	MemChunk data;
+	wad.write(data, false);
+	return openWad(data);
+}
+
+// -----------------------------------------------------------------------------
+// Returns UDMF TEXTMAP text for a map made of a [grid_size]x[grid_size] grid of
+// square sectors, with a thing in each sector.
+// The number of lines will be 2 * grid_size * (grid_size + 1)
+// -----------------------------------------------------------------------------
+string fixtures::udmfTextmap(unsigned grid_size, unsigned seed)
+{
+	std::mt19937 rng(seed);
+	const int    g    = static_cast<int>(grid_size);
+	const int    size = 128;
+
+	auto vertex = [g](int x, int y) { return y * (g + 1) + x; };
+	auto cell   = [g](int x, int y) { return y * g + x; };
+
+	string out;
+	auto   it = std::back_inserter(out);
+	fmt::format_to(it, "namespace = \"zdoom\";\n");
+
+	// Vertices
+	for (int y = 0; y <= g; ++y)
+		for (int x = 0; x <= g; ++x)
+			fmt::format_to(it, "vertex\n{{\nx = {}.000;\ny = {}.000;\n}}\n", x * size, y * size);
+
+	// Sectors (some tagged)
+	for (int a = 0; a < g * g; ++a)
+	{
+		fmt::format_to(
+			it,
+			"sector\n{{\nheightfloor = {};\nheightceiling = 128;\ntexturefloor = \"FLOOR0_1\";\n"
+			"textureceiling = \"CEIL1_1\";\nlightlevel = {};\n",
+			(rng() % 4) * 8,
+			128 + (rng() % 8) * 16);
+		if (rng() % 32 == 0)
+			fmt::format_to(it, "id = {};\n", 1 + a % 100);
+		fmt::format_to(it, "}}\n");
+	}
+
+	// Lines and sides, the front side of each line is on its right
+	struct Line
+	{
+		int v1, v2, front, back;
+	};
+	vector<Line> lines;
+	for (int y = 0; y <= g; ++y)
+		for (int x = 0; x < g; ++x)
+		{
+			int below = y > 0 ? cell(x, y - 1) : -1;
+			int above = y < g ? cell(x, y) : -1;
+			if (below >= 0)
+				lines.push_back({ vertex(x, y), vertex(x + 1, y), below, above });
+			else
+				lines.push_back({ vertex(x + 1, y), vertex(x, y), above, -1 });
+		}
+	for (int x = 0; x <= g; ++x)
+		for (int y = 0; y < g; ++y)
+		{
+			int right = x < g ? cell(x, y) : -1;
+			int left  = x > 0 ? cell(x - 1, y) : -1;
+			if (right >= 0)
+				lines.push_back({ vertex(x, y), vertex(x, y + 1), right, left });
+			else
+				lines.push_back({ vertex(x, y + 1), vertex(x, y), left, -1 });
+		}
+
+	int n_sides = 0;
+	for (const auto& line : lines)
+	{
+		// Sides
+		if (line.back < 0)
+			fmt::format_to(it, "sidedef\n{{\nsector = {};\ntexturemiddle = \"STARTAN2\";\n}}\n", line.front);
+		else
+		{
+			fmt::format_to(it, "sidedef\n{{\nsector = {};\ntexturetop = \"STARTAN2\";\n}}\n", line.front);
+			fmt::format_to(it, "sidedef\n{{\nsector = {};\ntexturebottom = \"STARTAN2\";\n}}\n", line.back);
+		}
+
+		// Line
+		fmt::format_to(it, "linedef\n{{\nv1 = {};\nv2 = {};\nsidefront = {};\n", line.v1, line.v2, n_sides++);
+		if (line.back < 0)
+			fmt::format_to(it, "blocking = true;\n");
+		else
+		{
+			fmt::format_to(it, "sideback = {};\ntwosided = true;\n", n_sides++);
+			if (rng() % 64 == 0)
+				fmt::format_to(it, "special = 80;\narg0 = {};\nplayeruse = true;\n", 1 + rng() % 100);
+		}
+		fmt::format_to(it, "}}\n");
+	}
+
+	// Things
+	const int thing_types[] = { 2011, 2012, 2014, 3004, 9, 2035 };
+	for (int y = 0; y < g; ++y)
+		for (int x = 0; x < g; ++x)
+		{
+			int type = x == 0 && y == 0 ? 1 : thing_types[rng() % std::size(thing_types)];
+			fmt::format_to(
+				it,
+				"thing\n{{\nx = {}.000;\ny = {}.000;\ntype = {};\nangle = {};\nskill1 = true;\nskill2 = true;\n"
+				"skill3 = true;\nskill4 = true;\nskill5 = true;\nsingle = true;\n}}\n",
+				x * size + size / 2,
+				y * size + size / 2,
+				type,
+				(rng() % 8) * 45);
+		}
+
+	return out;
+}
+
+// -----------------------------------------------------------------------------
+// Returns a wad archive containing a single UDMF map (MAP01), see udmfTextmap
+// -----------------------------------------------------------------------------
+unique_ptr<WadArchive> fixtures::udmfMapWad(unsigned grid_size, unsigned seed)
+{
+	auto textmap = udmfTextmap(grid_size, seed);
+
+	WadArchive wad;
+	addEntry(wad, "MAP01", {});
+	addEntry(wad, "TEXTMAP", { textmap.begin(), textmap.end() });
+	addEntry(wad, "ENDMAP", {});
+
+	MemChunk data;
+	wad.write(data, false);
+	return openWad(data);
+}
+
+// -----------------------------------------------------------------------------
+// Returns a palette of 256 random colours
+// -----------------------------------------------------------------------------
+Palette fixtures::randomPalette(unsigned seed)
+{
+	std::mt19937 rng(seed);
+
+	Palette palette;
+	for (unsigned a = 0; a < 256; ++a)
+		palette.setColour(a, { static_cast<uint8_t>(rng()), static_cast<uint8_t>(rng()), static_cast<uint8_t>(rng()) });
+
+	return palette;
+}
+
+// -----------------------------------------------------------------------------
+// Returns a wad archive with [n_patches] 64x128 Doom format patches (named
+// PAT00000, PAT00001, etc.) between P_START and P_END markers
+// -----------------------------------------------------------------------------
+unique_ptr<WadArchive> fixtures::patchWad(unsigned n_patches, Palette& palette, unsigned seed)
+{
+	std::mt19937 rng(seed);
+
+	WadArchive wad;
+	addEntry(wad, "P_START", {});
+	for (unsigned a = 0; a < n_patches; ++a)
+		addEntry(wad, fmt::format("PAT{:05d}", a), randomImage(rng, 64, 128, palette, "doom"));
+	addEntry(wad, "P_END", {});
+
+	MemChunk data;
+	wad.write(data, false);
+	return openWad(data);
+}
+
+// -----------------------------------------------------------------------------
+// Returns [n_polygons] polygons of various shapes for triangulation, including
+// concave, holed and degenerate (collinear, touching or very thin) ones
+// -----------------------------------------------------------------------------
+vector<fixtures::PolygonEdges> fixtures::polygons(unsigned n_polygons, unsigned seed)
+{
+	std::mt19937 rng(seed);
+
+	vector<PolygonEdges> polygons(n_polygons);
+	for (unsigned a = 0; a < n_polygons; ++a)
+	{
+		auto& poly = polygons[a];
+		switch (a % 8)
+		{
+		case 0:
+		{
+			poly.shape = "star";
+			addLoop(poly, star(rng, 0., 0., 3 + rng() % 60, 256. + rng() % 1024));
+			break;
+		}
+		case 1:
+		{
+			// Rectangles joined along a base, with gaps between them
+			poly.shape = "comb";
+			auto n_teeth = 2 + rng() % 30;
+			auto width   = 8. + rng() % 64;
+			auto base    = 8. + rng() % 64;
+			auto height  = 64. + rng() % 512;
+
+			vector<Vec2d> points{ { 0., 0. } };
+			for (unsigned t = 0; t < n_teeth; ++t)
+			{
+				auto x = t * width * 2;
+				if (t > 0)
+					points.emplace_back(x, base);
+				points.emplace_back(x, base + height);
+				points.emplace_back(x + width, base + height);
+				if (t < n_teeth - 1)
+					points.emplace_back(x + width, base);
+			}
+			points.emplace_back((n_teeth * 2 - 1) * width, 0.);
+			addLoop(poly, points);
+			break;
+		}
+		case 2:
+		{
+			// Rectangle with rectangle and star holes in a grid
+			poly.shape = "holes";
+			auto n_x   = 1 + rng() % 6;
+			auto n_y   = 1 + rng() % 6;
+			addLoop(poly, rectangle(0., 0., n_x * 256., n_y * 256.));
+			for (unsigned x = 0; x < n_x; ++x)
+				for (unsigned y = 0; y < n_y; ++y)
+				{
+					if (rng() % 3 == 0)
+						addLoop(poly, reversed(rectangle(x * 256. + 32., y * 256. + 32., 192., 192.)));
+					else if (rng() % 2 == 0)
+						addLoop(poly, reversed(star(rng, x * 256. + 128., y * 256. + 128., 3 + rng() % 12, 96.)));
+				}
+			break;
+		}
+		case 3:
+		{
+			// Rings of alternating outlines and holes, one within the other
+			poly.shape = "nested";
+			auto n_rings = 1 + rng() % 6;
+			for (unsigned r = 0; r < n_rings * 2; ++r)
+			{
+				auto points = rectangle(r * 64., r * 64., (n_rings * 2 - r) * 128., (n_rings * 2 - r) * 128.);
+				addLoop(poly, r % 2 ? reversed(points) : points);
+			}
+			break;
+		}
+		case 4:
+		{
+			// Rectangle with many collinear vertices along each edge, and a star
+			// hole with some too
+			poly.shape = "collinear";
+			auto n_splits = 2 + rng() % 8;
+			addLoop(poly, splitEdges(rectangle(0., 0., 1024., 512.), n_splits * 4));
+			addLoop(poly, reversed(splitEdges(star(rng, 512., 256., 3 + rng() % 8, 192.), n_splits)));
+			break;
+		}
+		case 5:
+		{
+			// Outlines and holes touching at single vertices: two squares
+			// joined at a corner, the second with a hole touching its edge
+			// and another hole touching that one's corner
+			poly.shape = "touching";
+			addLoop(poly, rectangle(0., 0., 256., 256.));
+			addLoop(
+				poly,
+				{ { 256., 256. },
+				  { 256., 384. },
+				  { 256., 512. },
+				  { 512., 512. },
+				  { 512., 256. } });
+			addLoop(poly, reversed({ { 256., 384. }, { 320., 448. }, { 384., 384. }, { 320., 320. } }));
+			addLoop(poly, reversed(rectangle(384., 384., 64., 64.)));
+			break;
+		}
+		case 6:
+		{
+			// Several separate outlines
+			poly.shape = "disjoint";
+			auto n_parts = 2 + rng() % 6;
+			for (unsigned p = 0; p < n_parts; ++p)
+				addLoop(poly, star(rng, p * 1024., 0., 3 + rng() % 8, 256. + rng() % 256));
+			break;
+		}
+		default:
+		{
+			// Very thin shapes: a 1 unit wide strip, a triangle with a nearly
+			// collinear vertex, and a sliver with fractional coordinates and a
+			// collinear vertex
+			poly.shape  = "thin";
+			auto length = 256. + rng() % 4096;
+			addLoop(poly, rectangle(0., 0., length, 1.));
+			addLoop(poly, { { 0., 16. }, { length / 2, 17. }, { length, 16. } });
+			addLoop(poly, { { 0., 32. }, { length / 2, 32.5 }, { length, 32.25 }, { length / 2, 32.125 } });
+			break;
+		}
+		}
+	}
+
+	return polygons;
+}
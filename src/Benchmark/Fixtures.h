@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Archive/Formats/WadArchive.h"
+#include "Archive/Formats/ZipArchive.h"
+#include "Graphics/Palette/Palette.h"
+#include <array>
+
+// Generators for synthetic benchmark data. All fixtures are generated from a
+// seed, so the same seed always gives the same data
+namespace slade::bench::fixtures
+{
+// A polygon given as directed edges with the interior on their right (as for
+// PolygonTriangulator::addEdge), and the area it covers
+struct PolygonEdges
+{
+	string                        shape;
+	vector<std::array<double, 4>> edges;
+	double                        area = 0.;
+};
+
+void                   wadData(MemChunk& out, unsigned n_lumps, unsigned seed);
+unique_ptr<ZipArchive> pk3Tree(unsigned depth, unsigned n_subdirs, unsigned n_files, unsigned seed);
+unique_ptr<WadArchive> mixedEntryWad(unsigned n_entries, unsigned seed);
+string                 udmfTextmap(unsigned grid_size, unsigned seed);
+unique_ptr<WadArchive> udmfMapWad(unsigned grid_size, unsigned seed);
+Palette                randomPalette(unsigned seed);
+unique_ptr<WadArchive> patchWad(unsigned n_patches, Palette& palette, unsigned seed);
+vector<PolygonEdges>   polygons(unsigned n_polygons, unsigned seed);
+} // namespace slade::bench::fixtures
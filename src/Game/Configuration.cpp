@@ -1753,24 +1753,16 @@ const string& Configuration::spacTriggerUDMFName(unsigned trigger_index)
 }
 
 // -----------------------------------------------------------------------------
-// Returns the UDMF property definition matching [name] for MapObject [type]
+// Returns the UDMF property definition matching [name] for MapObject [type],
+// or null if it isn't defined.
+// This doesn't modify the configuration, so it is safe to call from multiple
+// threads at once (eg. via MapObject property getters in the 3d renderer)
 // -----------------------------------------------------------------------------
 UDMFProperty* Configuration::getUDMFProperty(const string& name, MapObject::Type type)
 {
-	using Type = MapObject::Type;
-
-	if (type == Type::Vertex)
-		return &udmf_vertex_props_[name];
-	else if (type == Type::Line)
-		return &udmf_linedef_props_[name];
-	else if (type == Type::Side)
-		return &udmf_sidedef_props_[name];
-	else if (type == Type::Sector)
-		return &udmf_sector_props_[name];
-	else if (type == Type::Thing)
-		return &udmf_thing_props_[name];
-	else
-		return nullptr;
+	auto& props = allUDMFProperties(type);
+	auto  i     = props.find(name);
+	return i != props.end() ? &i->second : nullptr;
 }
 
 // -----------------------------------------------------------------------------
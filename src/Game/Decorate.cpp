@@ -34,6 +34,7 @@
 #include "Archive/Archive.h"
 #include "Configuration.h"
 #include "Game.h"
+#include "ParseCache.h"
 #include "ThingType.h"
 #include "Utility/StringUtils.h"
 #include "Utility/Tokenizer.h"
@@ -50,7 +51,30 @@ using namespace game;
 namespace
 {
 EntryType* etype_decorate = nullptr;
-}
+
+// Maximum total size of DECORATE entries to keep cached parse results for
+constexpr size_t PARSE_CACHE_MAX_BYTES = 16 * 1024 * 1024;
+
+// A thing definition parsed from a DECORATE entry
+struct ParsedDef
+{
+	bool           actor = true; // False for old-style (non-actor) definitions
+	string         name;
+	string         class_name;
+	string         parent;
+	string         group;
+	int            ednum = -1;
+	vector<string> game_filters;
+	PropertyList   props;
+};
+
+// The thing definitions and #includes parsed from a DECORATE entry
+struct ParsedEntry
+{
+	vector<ParsedDef>           defs;
+	vector<game::ParsedInclude> includes;
+};
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -236,19 +260,20 @@ void parseStates(Tokenizer& tz, PropertyList& props)
 }
 
 // -----------------------------------------------------------------------------
-// Parses a DECORATE 'actor' definition
+// Parses a DECORATE 'actor' definition and adds it to [defs]
 // -----------------------------------------------------------------------------
-void parseDecorateActor(Tokenizer& tz, std::map<int, ThingType>& types, vector<ThingType>& parsed)
+void parseDecorateActor(Tokenizer& tz, vector<ParsedDef>& defs)
 {
+	ParsedDef def;
+
 	// Get actor name
-	auto   name       = tz.next().text;
-	auto   actor_name = name;
-	string parent;
+	def.name       = tz.next().text;
+	def.class_name = def.name;
 
 	// Check for inheritance
 	// string next = tz.peekToken();
 	if (tz.advIfNext(":"))
-		parent = tz.next().text;
+		def.parent = tz.next().text;
 
 	// Check for replaces
 	if (tz.checkNextNC("replaces"))
@@ -259,18 +284,14 @@ void parseDecorateActor(Tokenizer& tz, std::map<int, ThingType>& types, vector<T
 		tz.adv();
 
 	// Check for no editor number (ie can't be placed in the map)
-	int ednum;
 	if (!tz.peek().isInteger())
-		ednum = -1;
+		def.ednum = -1;
 	else
-		tz.next().toInt(ednum);
+		tz.next().toInt(def.ednum);
 
-	PropertyList found_props;
-	bool         available       = false;
-	bool         filters_present = false;
-	bool         sprite_given    = false;
-	bool         title_given     = false;
-	string       group;
+	auto& found_props  = def.props;
+	bool  sprite_given = false;
+	bool  title_given  = false;
 
 	// Skip "native" keyword if present
 	tz.advIfNextNC("native");
@@ -290,27 +311,23 @@ void parseDecorateActor(Tokenizer& tz, std::map<int, ThingType>& types, vector<T
 			// Title
 			else if (tz.checkNC("//$Title"))
 			{
-				name        = tz.getLine();
+				def.name    = tz.getLine();
 				title_given = true;
 				continue;
 			}
 
-			// Game filter
+			// Game filter (checked against the current game when defined)
 			else if (tz.checkNC("game"))
-			{
-				filters_present = true;
-				if (gameDef(configuration().currentGame()).supportsFilter(tz.next().text))
-					available = true;
-			}
+				def.game_filters.push_back(tz.next().text);
 
 			// Tag
 			else if (!title_given && tz.checkNC("tag"))
-				name = tz.next().text;
+				def.name = tz.next().text;
 
 			// Category
 			else if (tz.checkNC("//$Group") || tz.checkNC("//$Category"))
 			{
-				group = tz.getLine();
+				def.group = tz.getLine();
 				continue;
 			}
 
@@ -421,66 +438,84 @@ void parseDecorateActor(Tokenizer& tz, std::map<int, ThingType>& types, vector<T
 			tz.adv();
 		}
 
-		log::info(3, "Parsed actor {}: {}", name, ednum);
+		log::info(3, "Parsed actor {}: {}", def.name, def.ednum);
 	}
 	else
-		log::warning("Warning: Invalid actor definition for {}", name);
+		log::warning("Warning: Invalid actor definition for {}", def.name);
 
-	// Ignore actors filtered for other games,
-	// and actors with a negative or null type
-	if (available || !filters_present)
+	defs.push_back(std::move(def));
+}
+
+// -----------------------------------------------------------------------------
+// Adds/updates the thing type for the parsed DECORATE actor [def] in [types]
+// (or [parsed] if it has no editor number)
+// -----------------------------------------------------------------------------
+void defineActor(const ParsedDef& def, std::map<int, ThingType>& types, vector<ThingType>& parsed)
+{
+	// Ignore actors filtered for other games
+	if (!def.game_filters.empty())
 	{
-		auto group_path = group.empty() ? "Decorate" : "Decorate/" + group;
+		bool available = false;
+		for (const auto& filter : def.game_filters)
+			if (gameDef(configuration().currentGame()).supportsFilter(filter))
+				available = true;
 
-		// Find existing definition or create it
-		ThingType* def = nullptr;
-		if (ednum <= 0)
-		{
-			for (auto& ptype : parsed)
-				if (strutil::equalCI(ptype.className(), actor_name))
-				{
-					def = &ptype;
-					break;
-				}
+		if (!available)
+			return;
+	}
 
-			if (!def)
+	auto group_path = def.group.empty() ? "Decorate" : "Decorate/" + def.group;
+
+	// Find existing definition or create it
+	ThingType* type = nullptr;
+	if (def.ednum <= 0)
+	{
+		for (auto& ptype : parsed)
+			if (strutil::equalCI(ptype.className(), def.class_name))
 			{
-				parsed.emplace_back(name, group_path, actor_name);
-				def = &parsed.back();
+				type = &ptype;
+				break;
 			}
-		}
-		else
-			def = &types[ednum];
-
-		// Add/update definition
-		def->define(ednum, name, group_path);
 
-		// Set group defaults (if any)
-		if (!group.empty())
+		if (!type)
 		{
-			auto& group_defaults = configuration().thingTypeGroupDefaults(group);
-			if (!group_defaults.group().empty())
-				def->copy(group_defaults);
+			parsed.emplace_back(def.name, group_path, def.class_name);
+			type = &parsed.back();
 		}
+	}
+	else
+		type = &types[def.ednum];
 
-		// Inherit from parent
-		if (!parent.empty())
-			for (auto& ptype : parsed)
-				if (strutil::equalCI(ptype.className(), parent))
-				{
-					def->copy(ptype);
-					break;
-				}
+	// Add/update definition
+	type->define(def.ednum, def.name, group_path);
 
-		// Set parsed properties
-		def->loadProps(found_props);
+	// Set group defaults (if any)
+	if (!def.group.empty())
+	{
+		auto& group_defaults = configuration().thingTypeGroupDefaults(def.group);
+		if (!group_defaults.group().empty())
+			type->copy(group_defaults);
 	}
+
+	// Inherit from parent
+	if (!def.parent.empty())
+		for (auto& ptype : parsed)
+			if (strutil::equalCI(ptype.className(), def.parent))
+			{
+				type->copy(ptype);
+				break;
+			}
+
+	// Set parsed properties
+	auto props = def.props;
+	type->loadProps(props);
 }
 
 // -----------------------------------------------------------------------------
-// Parses an old-style (non-actor) DECORATE definition
+// Parses an old-style (non-actor) DECORATE definition and adds it to [defs]
+// (if it has an editor number)
 // -----------------------------------------------------------------------------
-void parseDecorateOld(Tokenizer& tz, std::map<int, ThingType>& types)
+void parseDecorateOld(Tokenizer& tz, vector<ParsedDef>& defs)
 {
 	string       name, sprite, group;
 	bool         spritefound = false;
@@ -556,11 +591,13 @@ void parseDecorateOld(Tokenizer& tz, std::map<int, ThingType>& types)
 		if (spritefound && framefound)
 			found_props["sprite"] = sprite + frame + '?';
 
-		// Add type
-		types[type].define(type, name, group.empty() ? "Decorate" : "Decorate/" + group);
-
-		// Set parsed properties
-		types[type].loadProps(found_props);
+		ParsedDef def;
+		def.actor = false;
+		def.name  = name;
+		def.group = group;
+		def.ednum = type;
+		def.props = found_props;
+		defs.push_back(std::move(def));
 
 		log::info(3, "Parsed {} {}: {}", group.length() ? group : "decoration", name, type);
 	}
@@ -569,15 +606,32 @@ void parseDecorateOld(Tokenizer& tz, std::map<int, ThingType>& types)
 }
 
 // -----------------------------------------------------------------------------
-// Parses all DECORATE thing definitions in [entry] and adds them to [types]
+// Adds/updates the thing type for the parsed old-style DECORATE definition
+// [def] in [types]
+// -----------------------------------------------------------------------------
+void defineOld(const ParsedDef& def, std::map<int, ThingType>& types)
+{
+	// Add type
+	types[def.ednum].define(def.ednum, def.name, def.group.empty() ? "Decorate" : "Decorate/" + def.group);
+
+	// Set parsed properties
+	auto props = def.props;
+	types[def.ednum].loadProps(props);
+}
+
+// -----------------------------------------------------------------------------
+// Parses all DECORATE thing definitions and #includes in [data]. Doesn't
+// modify anything else, so can be run on a worker thread
 // -----------------------------------------------------------------------------
-void parseDecorateEntry(ArchiveEntry* entry, std::map<int, ThingType>& types, vector<ThingType>& parsed)
+shared_ptr<ParsedEntry> parseDecorateEntry(const MemChunk& data, const string& name)
 {
+	auto result = std::make_shared<ParsedEntry>();
+
 	// Init tokenizer
 	Tokenizer tz;
 	tz.setSpecialCharacters(":,{}");
 	tz.enableDecorate(true);
-	tz.openMem(entry->data(), entry->name());
+	tz.openMem(data, name);
 
 	// --- Parse ---
 	while (!tz.atEnd())
@@ -585,36 +639,116 @@ void parseDecorateEntry(ArchiveEntry* entry, std::map<int, ThingType>& types, ve
 		// Check for #include
 		if (tz.checkNC("#include"))
 		{
-			auto inc_entry = entry->relativeEntry(tz.next().text);
-
-			// Check #include path could be resolved
-			if (!inc_entry)
-			{
-				log::warning(
-					"Warning parsing DECORATE entry {}: "
-					"Unable to find #included entry \"{}\" at line {}, skipping",
-					entry->name(),
-					tz.current().text,
-					tz.current().line_no);
-			}
-			else
-				parseDecorateEntry(inc_entry, types, parsed);
-
+			auto path = tz.next().text;
+			result->includes.push_back({ static_cast<unsigned>(result->defs.size()), path, tz.current().line_no });
 			tz.adv();
 		}
 
 		// Check for actor definition
 		else if (tz.checkNC("actor"))
-			parseDecorateActor(tz, types, parsed);
+			parseDecorateActor(tz, result->defs);
 		else
-			parseDecorateOld(tz, types); // Old DECORATE definitions might be found
+			parseDecorateOld(tz, result->defs); // Old DECORATE definitions might be found
 
 		tz.advIf("}");
 	}
 
+	return result;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the cache of parsed DECORATE entries
+// -----------------------------------------------------------------------------
+game::ParseCache<ParsedEntry>& parseCache()
+{
+	static game::ParseCache<ParsedEntry> cache(parseDecorateEntry, PARSE_CACHE_MAX_BYTES);
+	return cache;
+}
+
+// -----------------------------------------------------------------------------
+// Adds all thing definitions parsed from [entry] (and any entries it
+// #includes, in order) to [types]. [results] must contain the parse results
+// for [entry] and its #includes
+// -----------------------------------------------------------------------------
+void defineEntry(
+	ArchiveEntry*                                 entry,
+	const game::ParseCache<ParsedEntry>::Results& results,
+	std::map<int, ThingType>&                     types,
+	vector<ThingType>&                            parsed,
+	vector<ArchiveEntry*>&                        entry_stack)
+{
+	auto result = results.find(entry);
+	if (result == results.end())
+		return;
+
+	const auto& defs      = result->second->defs;
+	unsigned    def_index = 0;
+	auto        define_to = [&](unsigned end)
+	{
+		for (; def_index < end; ++def_index)
+		{
+			if (defs[def_index].actor)
+				defineActor(defs[def_index], types, parsed);
+			else
+				defineOld(defs[def_index], types);
+		}
+	};
+
+	entry_stack.push_back(entry);
+
+	for (const auto& include : result->second->includes)
+	{
+		define_to(include.position);
+
+		auto inc_entry = entry->relativeEntry(include.path);
+
+		// Check #include path could be resolved
+		if (!inc_entry)
+		{
+			log::warning(
+				"Warning parsing DECORATE entry {}: "
+				"Unable to find #included entry \"{}\" at line {}, skipping",
+				entry->name(),
+				include.path,
+				include.line);
+		}
+		else if (VECTOR_EXISTS(entry_stack, inc_entry))
+		{
+			log::warning(
+				"Warning parsing DECORATE entry {}: "
+				"Detected circular #include \"{}\" on line {}, skipping",
+				entry->name(),
+				include.path,
+				include.line);
+		}
+		else
+			defineEntry(inc_entry, results, types, parsed, entry_stack);
+	}
+
+	define_to(defs.size());
+
 	// Set entry type
 	if (etype_decorate && entry->type() != etype_decorate)
 		entry->setType(etype_decorate);
+
+	entry_stack.pop_back();
+}
+
+// -----------------------------------------------------------------------------
+// Parses all DECORATE thing definitions in [entries] (and any entries they
+// #include) and adds them to [types]. Entries are parsed in parallel (or taken
+// from the cache if unchanged), then added in order
+// -----------------------------------------------------------------------------
+void readDecorateEntries(
+	const vector<ArchiveEntry*>& entries,
+	std::map<int, ThingType>&    types,
+	vector<ThingType>&           parsed)
+{
+	auto results = parseCache().parseTree(entries);
+
+	vector<ArchiveEntry*> entry_stack;
+	for (auto entry : entries)
+		defineEntry(entry, results, types, parsed, entry_stack);
 }
 
 } // namespace
@@ -651,8 +785,7 @@ bool game::readDecorateDefs(Archive* archive, std::map<int, ThingType>& types, v
 		etype_decorate = nullptr;
 
 	// Parse DECORATE entries
-	for (auto entry : decorate_entries)
-		parseDecorateEntry(entry, types, parsed);
+	readDecorateEntries(decorate_entries, types, parsed);
 
 	return true;
 }
@@ -682,7 +815,7 @@ CONSOLE_COMMAND(test_decorate, 0, false)
 	{
 		auto entry = archive->entryAtPath(args[0]);
 		if (entry)
-			parseDecorateEntry(entry, types, parsed);
+			readDecorateEntries({ entry }, types, parsed);
 		else
 			log::console("Entry not found");
 	}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "Archive/ArchiveEntry.h"
+#include "Utility/ThreadPool.h"
+#include <unordered_set>
+
+namespace slade::game
+{
+// An #include found while parsing a DECORATE/ZScript entry
+struct ParsedInclude
+{
+	unsigned position; // Number of definitions parsed before the #include
+	string   path;
+	unsigned line;
+};
+
+// Caches the results of parsing DECORATE/ZScript entries, keyed by the content
+// hash and size of the entry data, so unchanged entries aren't parsed again
+// each time definitions are reloaded. [T] is the parse result type, which
+// must have a vector<ParsedInclude> 'includes' member.
+// Entries not in the cache are parsed in parallel on worker threads, and the
+// results are only ever read on the main thread
+template<typename T> class ParseCache
+{
+public:
+	using ParseFunc = std::function<shared_ptr<T>(const MemChunk& data, const string& name)>;
+	using Results   = std::unordered_map<const ArchiveEntry*, shared_ptr<const T>>;
+
+	ParseCache(ParseFunc parse, size_t max_bytes) : parse_{ std::move(parse) }, max_bytes_{ max_bytes } {}
+
+	void clear()
+	{
+		cache_.clear();
+		cached_bytes_ = 0;
+	}
+
+	// Returns the parse results for [roots] and all entries they (recursively)
+	// #include. Includes that can't be resolved are left out
+	Results parseTree(const vector<ArchiveEntry*>& roots)
+	{
+		Results                           results;
+		std::unordered_set<ArchiveEntry*> queued;
+		vector<ArchiveEntry*>             pass;
+		for (auto* root : roots)
+			if (queued.insert(root).second)
+				pass.push_back(root);
+
+		++generation_;
+		while (!pass.empty())
+		{
+			// Get cached results, entry data is loaded here as loading isn't
+			// thread-safe
+			vector<ArchiveEntry*> to_parse;
+			vector<uint64_t>      keys;
+			for (auto* entry : pass)
+			{
+				entry->data();
+				auto key = (static_cast<uint64_t>(entry->contentHash()) << 32) | entry->size();
+
+				auto cached = cache_.find(key);
+				if (cached != cache_.end())
+				{
+					cached->second.last_used = generation_;
+					results[entry]           = cached->second.result;
+				}
+				else
+				{
+					to_parse.push_back(entry);
+					keys.push_back(key);
+				}
+			}
+
+			// Parse the rest in parallel
+			vector<shared_ptr<T>> parsed(to_parse.size());
+			threadpool::parallelFor(
+				to_parse.size(),
+				[this, &to_parse, &parsed](size_t index)
+				{ parsed[index] = parse_(to_parse[index]->data(false), to_parse[index]->name()); });
+			for (unsigned a = 0; a < to_parse.size(); ++a)
+			{
+				// (Entries with identical content in the same pass are parsed twice)
+				auto& cached = cache_[keys[a]];
+				if (!cached.result)
+					cached_bytes_ += to_parse[a]->size();
+				cached               = { parsed[a], generation_, to_parse[a]->size() };
+				results[to_parse[a]] = parsed[a];
+			}
+
+			// Next pass parses any #included entries not seen yet
+			vector<ArchiveEntry*> next;
+			for (auto* entry : pass)
+				for (const auto& include : results[entry]->includes)
+				{
+					auto inc_entry = entry->relativeEntry(include.path);
+					if (inc_entry && queued.insert(inc_entry).second)
+						next.push_back(inc_entry);
+				}
+			pass = std::move(next);
+		}
+
+		prune();
+		return results;
+	}
+
+private:
+	struct Cached
+	{
+		shared_ptr<const T> result;
+		unsigned            last_used;
+		size_t              size;
+	};
+
+	ParseFunc                            parse_;
+	size_t                               max_bytes_;
+	std::unordered_map<uint64_t, Cached> cache_;
+	size_t                               cached_bytes_ = 0;
+	unsigned                             generation_   = 0;
+
+	// Removes the least recently used results until the total size of the
+	// cached entries is within the limit
+	void prune()
+	{
+		while (cached_bytes_ > max_bytes_ && !cache_.empty())
+		{
+			auto oldest = cache_.begin();
+			for (auto i = cache_.begin(); i != cache_.end(); ++i)
+				if (i->second.last_used < oldest->second.last_used)
+					oldest = i;
+
+			// Keep anything used by the last parse
+			if (oldest->second.last_used == generation_)
+				break;
+
+			cached_bytes_ -= oldest->second.size;
+			cache_.erase(oldest);
+		}
+	}
+};
+} // namespace slade::game
@@ -34,6 +34,7 @@
 #include "App.h"
 #include "Archive/Archive.h"
 #include "Archive/ArchiveManager.h"
+#include "ParseCache.h"
 #include "Utility/StringUtils.h"
 #include "Utility/Tokenizer.h"
 
@@ -64,6 +65,16 @@ bool dump_parsed_states    = false;
 bool dump_parsed_functions = false;
 
 string db_comment = "//$";
+
+// Maximum total size of ZScript entries to keep cached parse results for
+constexpr size_t PARSE_CACHE_MAX_BYTES = 16 * 1024 * 1024;
+
+// The statements/blocks and #includes parsed from a ZScript entry
+struct ParsedEntry
+{
+	vector<ParsedStatement>     statements;
+	vector<game::ParsedInclude> includes;
+};
 } // namespace slade::zscript
 
 
@@ -185,17 +196,18 @@ bool checkKeywordValueStatement(const vector<string>& tokens, unsigned index, st
 }
 
 // -----------------------------------------------------------------------------
-// Parses all statements/blocks in [entry], adding them to [parsed]
+// Parses all statements/blocks and #includes in [data]. Doesn't modify
+// anything else, so can be run on a worker thread
 // -----------------------------------------------------------------------------
-void parseBlocks(ArchiveEntry* entry, vector<ParsedStatement>& parsed, vector<ArchiveEntry*>& entry_stack)
+shared_ptr<ParsedEntry> parseEntryBlocks(const MemChunk& data, const string& name)
 {
+	auto result = std::make_shared<ParsedEntry>();
+
 	Tokenizer tz;
 	tz.setSpecialCharacters(Tokenizer::DEFAULT_SPECIAL_CHARACTERS + "()+-[]&!?.<>");
 	tz.enableDecorate(true);
 	tz.setCommentTypes(Tokenizer::CommentTypes::CPPStyle | Tokenizer::CommentTypes::CStyle);
-	tz.openMem(entry->data(), "ZScript");
-
-	entry_stack.push_back(entry);
+	tz.openMem(data, "ZScript");
 
 	while (!tz.atEnd())
 	{
@@ -204,29 +216,9 @@ void parseBlocks(ArchiveEntry* entry, vector<ParsedStatement>& parsed, vector<Ar
 		{
 			if (tz.checkNC("#include"))
 			{
-				auto inc_entry = entry->relativeEntry(tz.next().text);
-
-				// Check #include path could be resolved
-				if (!inc_entry)
-				{
-					log::warning(
-						"Warning parsing ZScript entry {}: "
-						"Unable to find #included entry \"{}\" at line {}, skipping",
-						entry->name(),
-						tz.current().text,
-						tz.current().line_no);
-				}
-				else if (VECTOR_EXISTS(entry_stack, inc_entry))
-				{
-					log::warning(
-						"Warning parsing ZScript entry {}: "
-						"Detected circular #include \"{}\" on line {}, skipping",
-						entry->name(),
-						tz.current().text,
-						tz.current().line_no);
-				}
-				else
-					parseBlocks(inc_entry, parsed, entry_stack);
+				auto path = tz.next().text;
+				result->includes.push_back(
+					{ static_cast<unsigned>(result->statements.size()), path, tz.current().line_no });
 			}
 
 			tz.advToNextLine();
@@ -241,12 +233,92 @@ void parseBlocks(ArchiveEntry* entry, vector<ParsedStatement>& parsed, vector<Ar
 		}
 
 		// ZScript
-		parsed.push_back({});
-		parsed.back().entry = entry;
-		if (!parsed.back().parse(tz))
-			parsed.pop_back();
+		result->statements.push_back({});
+		if (!result->statements.back().parse(tz))
+			result->statements.pop_back();
+	}
+
+	return result;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the cache of parsed ZScript entries
+// -----------------------------------------------------------------------------
+game::ParseCache<ParsedEntry>& parseCache()
+{
+	static game::ParseCache<ParsedEntry> cache(parseEntryBlocks, PARSE_CACHE_MAX_BYTES);
+	return cache;
+}
+
+// -----------------------------------------------------------------------------
+// Sets the entry of [statement] and all statements in its block to [entry]
+// -----------------------------------------------------------------------------
+void setStatementEntry(ParsedStatement& statement, ArchiveEntry* entry)
+{
+	statement.entry = entry;
+	for (auto& child : statement.block)
+		setStatementEntry(child, entry);
+}
+
+// -----------------------------------------------------------------------------
+// Adds all statements/blocks parsed from [entry] (and any entries it
+// #includes, in order) to [parsed]. [results] must contain the parse results
+// for [entry] and its #includes
+// -----------------------------------------------------------------------------
+void parseBlocks(
+	ArchiveEntry*                                 entry,
+	const game::ParseCache<ParsedEntry>::Results& results,
+	vector<ParsedStatement>&                      parsed,
+	vector<ArchiveEntry*>&                        entry_stack)
+{
+	auto result = results.find(entry);
+	if (result == results.end())
+		return;
+
+	const auto& statements      = result->second->statements;
+	unsigned    statement_index = 0;
+	auto        add_to          = [&](unsigned end)
+	{
+		for (; statement_index < end; ++statement_index)
+		{
+			parsed.push_back(statements[statement_index]);
+			setStatementEntry(parsed.back(), entry);
+		}
+	};
+
+	entry_stack.push_back(entry);
+
+	for (const auto& include : result->second->includes)
+	{
+		add_to(include.position);
+
+		auto inc_entry = entry->relativeEntry(include.path);
+
+		// Check #include path could be resolved
+		if (!inc_entry)
+		{
+			log::warning(
+				"Warning parsing ZScript entry {}: "
+				"Unable to find #included entry \"{}\" at line {}, skipping",
+				entry->name(),
+				include.path,
+				include.line);
+		}
+		else if (VECTOR_EXISTS(entry_stack, inc_entry))
+		{
+			log::warning(
+				"Warning parsing ZScript entry {}: "
+				"Detected circular #include \"{}\" on line {}, skipping",
+				entry->name(),
+				include.path,
+				include.line);
+		}
+		else
+			parseBlocks(inc_entry, results, parsed, entry_stack);
 	}
 
+	add_to(statements.size());
+
 	// Set entry type
 	if (etype_zscript && entry->type() != etype_zscript)
 		entry->setType(etype_zscript);
@@ -967,12 +1039,22 @@ void Definitions::clear()
 bool Definitions::parseZScript(ArchiveEntry* entry)
 {
 	// Parse into tree of expressions and blocks
-	auto                    start = app::runTimer();
+	auto                    start   = app::runTimer();
+	auto                    results = parseCache().parseTree({ entry });
 	vector<ParsedStatement> parsed;
 	vector<ArchiveEntry*>   entry_stack;
-	parseBlocks(entry, parsed, entry_stack);
+	parseBlocks(entry, results, parsed, entry_stack);
 	log::debug(2, "parseBlocks: {}ms", app::runTimer() - start);
-	start = app::runTimer();
+
+	return parseStatements(parsed);
+}
+
+// -----------------------------------------------------------------------------
+// Adds the classes, structs and enums in [parsed] statements/blocks
+// -----------------------------------------------------------------------------
+bool Definitions::parseStatements(vector<ParsedStatement>& parsed)
+{
+	auto start = app::runTimer();
 
 	for (auto& block : parsed)
 	{
@@ -1055,11 +1137,22 @@ bool Definitions::parseZScript(Archive* archive)
 	if (etype_zscript == EntryType::unknownType())
 		etype_zscript = nullptr;
 
-	// Parse ZScript entries
+	// Parse all ZScript entries (and their #includes) into trees of expressions
+	// and blocks, in parallel
+	auto start   = app::runTimer();
+	auto results = parseCache().parseTree(zscript_enries);
+	log::debug(2, "parseBlocks: {}ms", app::runTimer() - start);
+
+	// Parse ZScript entries, in order
 	bool ok = true;
 	for (auto entry : zscript_enries)
-		if (!parseZScript(entry))
+	{
+		vector<ParsedStatement> parsed;
+		vector<ArchiveEntry*>   entry_stack;
+		parseBlocks(entry, results, parsed, entry_stack);
+		if (!parseStatements(parsed))
 			ok = false;
+	}
 
 	return ok;
 }
@@ -1263,7 +1356,10 @@ CONSOLE_COMMAND(test_parseblocks, 1, false)
 	vector<ArchiveEntry*>   entry_stack;
 	for (auto a = 0; a < num; ++a)
 	{
-		parseBlocks(entry, parsed, entry_stack);
+		// Clear the parse cache so each iteration actually parses the entry
+		// (and its #includes) rather than just reusing cached results
+		parseCache().clear();
+		parseBlocks(entry, parseCache().parseTree({ entry }), parsed, entry_stack);
 		parsed.clear();
 	}
 	log::console(fmt::format("Took {}ms", app::runTimer() - start));
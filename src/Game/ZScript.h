@@ -198,6 +198,8 @@ namespace zscript
 		vector<Enumerator> enumerators_;
 		vector<Variable>   variables_;
 		vector<Function>   functions_; // needed? dunno if global functions are a thing
+
+		bool parseStatements(vector<ParsedStatement>& parsed);
 	};
 } // namespace zscript
 } // namespace slade
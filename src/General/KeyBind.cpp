@@ -527,6 +527,8 @@ void KeyBind::initBinds()
 	addBind("ted_replacenext", Keypress("R", KPM_ALT), "Replace next", group);
 	addBind("ted_replaceall", Keypress("R", KPM_ALT | KPM_SHIFT), "Replace all", group);
 	addBind("ted_jumptoline", Keypress("G", KPM_CTRL), "Jump to Line", group);
+	addBind("ted_goto_definition", Keypress("f12"), "Go to Definition", group);
+	addBind("ted_find_usages", Keypress("f12", KPM_SHIFT), "Find Usages", group);
 	addBind("ted_fold_foldall", Keypress("[", KPM_CTRL | KPM_SHIFT), "Fold All", group);
 	addBind("ted_fold_unfoldall", Keypress("]", KPM_CTRL | KPM_SHIFT), "Fold All", group);
 	addBind("ted_line_comment", Keypress("/", KPM_CTRL), "Line Comment", group);
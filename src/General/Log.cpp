@@ -34,6 +34,7 @@
 #include <fmt/chrono.h>
 #include <fmt/format.h>
 #include <fstream>
+#include <mutex>
 
 using namespace slade;
 
@@ -47,6 +48,7 @@ namespace slade::log
 {
 vector<Message> log;
 std::ofstream   log_file;
+std::mutex      log_mutex; // Messages can be logged from worker threads
 } // namespace slade::log
 CVAR(Int, log_verbosity, 1, CVar::Flag::Save)
 
@@ -124,10 +126,22 @@ string log::Message::formattedMessageLine() const
 // Initialises the log file and logging stuff
 // -----------------------------------------------------------------------------
 void log::init()
+{
+	init(app::path("slade3.log", app::Dir::User));
+}
+
+// -----------------------------------------------------------------------------
+// Initialises logging, writing the log to [file_path].
+// If [file_path] is empty, messages are kept in the log history only
+// -----------------------------------------------------------------------------
+void log::init(const string& file_path)
 {
 	// Redirect sf::err output to the log file
-	log_file.open(app::path("slade3.log", app::Dir::User));
-	sf::err().rdbuf(log_file.rdbuf());
+	if (!file_path.empty())
+	{
+		log_file.open(file_path);
+		sf::err().rdbuf(log_file.rdbuf());
+	}
 
 	// Write logfile header
 	auto t  = std::time(nullptr);
@@ -187,6 +201,8 @@ void log::setVerbosity(int verbosity)
 // -----------------------------------------------------------------------------
 void log::message(MessageType type, string_view text)
 {
+	std::lock_guard lock(log_mutex);
+
 	// Add log message
 	auto t = std::time(nullptr);
 	log.emplace_back(text, type, *std::localtime(&t));
@@ -258,6 +274,8 @@ void log::message(MessageType type, int level, string_view text)
 	if (level > log_verbosity)
 		return;
 
+	std::lock_guard lock(log_mutex);
+
 	// Add log message
 	auto t = std::time(nullptr);
 	log.emplace_back(text, type, *std::localtime(&t));
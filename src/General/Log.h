@@ -33,6 +33,7 @@ namespace log
 	int                    verbosity();
 	void                   setVerbosity(int verbosity);
 	void                   init();
+	void                   init(const string& file_path);
 	void                   message(MessageType type, int level, string_view text);
 	void                   message(MessageType type, string_view text);
 	void                   message(MessageType type, int level, string_view text, fmt::format_args args);
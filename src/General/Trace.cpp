@@ -0,0 +1,271 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2022 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    Trace.cpp
+// Description: Scoped tracing zones for profiling, captured events can be
+//              saved in the Chrome trace_event JSON format
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "Trace.h"
+#include "App.h"
+#include "General/Console.h"
+#include "Utility/FileUtils.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace slade::trace
+{
+struct Event
+{
+	const char* name;
+	int64_t     start; // Nanoseconds since capture start
+	int64_t     duration;
+	unsigned    thread;
+};
+
+// Stop recording after this many events so a forgotten capture can't use up
+// all available memory (~48MB)
+constexpr unsigned MAX_EVENTS = 2000000;
+
+std::atomic<bool>     capture_running = false;
+int64_t               capture_start   = 0; // Clock time of capture start (only accessed with events_mutex locked)
+vector<Event>         events;
+bool                  events_dropped = false;
+std::mutex            events_mutex; // Zones can end on worker threads
+std::atomic<unsigned> next_thread_id = 0;
+thread_local unsigned thread_id      = next_thread_id++;
+unsigned              main_thread_id = 0;
+} // namespace slade::trace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the current (steady) clock time in nanoseconds
+// -----------------------------------------------------------------------------
+int64_t clockTime()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+		.count();
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Zone Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Zone class constructor, records the start time if a capture is running
+// -----------------------------------------------------------------------------
+trace::Zone::Zone(const char* name) : name_{ name }
+{
+	if (capture_running.load(std::memory_order_acquire))
+		start_ = clockTime();
+}
+
+// -----------------------------------------------------------------------------
+// Zone class destructor, adds an event for the zone to the capture (if it was
+// started while the current capture was running)
+// -----------------------------------------------------------------------------
+trace::Zone::~Zone()
+{
+	if (start_ < 0)
+		return;
+
+	auto end = clockTime();
+
+	// Ignore zones started before the current capture (eg. during a previous
+	// one), they would have negative start times
+	std::lock_guard lock(events_mutex);
+	if (!capture_running || start_ < capture_start)
+		return;
+	if (events.size() >= MAX_EVENTS)
+	{
+		events_dropped = true;
+		return;
+	}
+	events.push_back({ name_, start_ - capture_start, end - start_, thread_id });
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Trace Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns true if a trace capture is currently running
+// -----------------------------------------------------------------------------
+bool trace::capturing()
+{
+	return capture_running;
+}
+
+// -----------------------------------------------------------------------------
+// Starts a new trace capture, clearing any previously captured events
+// -----------------------------------------------------------------------------
+void trace::startCapture()
+{
+	std::lock_guard lock(events_mutex);
+	events.clear();
+	events_dropped  = false;
+	main_thread_id  = thread_id; // Captures are started from the main thread
+	capture_start   = clockTime();
+	capture_running = true;
+}
+
+// -----------------------------------------------------------------------------
+// Stops the current trace capture. Captured events are kept until the next
+// capture is started
+// -----------------------------------------------------------------------------
+void trace::stopCapture()
+{
+	std::lock_guard lock(events_mutex);
+	capture_running = false;
+
+	if (events_dropped)
+		log::warning("Trace capture reached the maximum of {} events, later events were dropped", MAX_EVENTS);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the number of events in the current (or last) capture
+// -----------------------------------------------------------------------------
+unsigned trace::numEvents()
+{
+	std::lock_guard lock(events_mutex);
+	return events.size();
+}
+
+// -----------------------------------------------------------------------------
+// Returns the captured events as a Chrome trace_event format JSON document
+// -----------------------------------------------------------------------------
+string trace::json()
+{
+	std::lock_guard lock(events_mutex);
+
+	string out = "{\"traceEvents\":[\n";
+	out.reserve(events.size() * 96);
+
+	// Name the main thread
+	out += fmt::format(
+		"{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},\"args\":{{\"name\":\"Main\"}}}}",
+		main_thread_id);
+
+	// Complete ('X') events, times are in microseconds
+	for (const auto& event : events)
+		out += fmt::format(
+			",\n{{\"name\":\"{}\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}}",
+			event.name,
+			event.thread,
+			event.start / 1000.,
+			event.duration / 1000.);
+
+	out += "\n],\"displayTimeUnit\":\"ms\"}\n";
+	return out;
+}
+
+// -----------------------------------------------------------------------------
+// Writes the captured events to [filename] as Chrome trace_event format JSON
+// -----------------------------------------------------------------------------
+bool trace::save(string_view filename)
+{
+	return fileutil::writeStringToFile(json(), string{ filename });
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Controls trace capturing:
+// trace start        - starts a new capture
+// trace stop [file]  - stops the capture and saves it to [file] (or trace.json
+//                      in the user directory)
+// trace status       - shows whether a capture is running
+// -----------------------------------------------------------------------------
+CONSOLE_COMMAND(trace, 1, true)
+{
+#ifdef NO_TRACING
+	log::console("Note: This build of SLADE was compiled without tracing zones");
+#endif
+
+	if (args[0] == "start")
+	{
+		trace::startCapture();
+		log::console("Trace capture started");
+	}
+	else if (args[0] == "stop")
+	{
+		if (!trace::capturing())
+		{
+			log::console("No trace capture is running");
+			return;
+		}
+
+		trace::stopCapture();
+
+		auto filename = args.size() > 1 ? args[1] : app::path("trace.json", app::Dir::User);
+		if (trace::save(filename))
+			log::console(fmt::format("Saved {} trace events to {}", trace::numEvents(), filename));
+		else
+			log::console(fmt::format("Unable to write trace to {}", filename));
+	}
+	else if (args[0] == "status")
+	{
+		if (trace::capturing())
+			log::console(fmt::format("Trace capture running, {} events so far", trace::numEvents()));
+		else
+			log::console("No trace capture is running");
+	}
+	else
+		log::console("Usage: trace <start|stop [file]|status>");
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+// Lightweight scoped tracing zones, for profiling. While a capture is running,
+// each zone records its start time and duration, and the capture can be saved
+// in the Chrome trace_event JSON format (viewable in chrome://tracing or
+// https://ui.perfetto.dev). Zones only cost a single check when no capture is
+// running, and are compiled out completely if NO_TRACING is defined
+namespace slade::trace
+{
+class Zone
+{
+public:
+	// [name] must be a string literal (or otherwise outlive the capture)
+	Zone(const char* name);
+	~Zone();
+
+	// Non-copyable
+	Zone(const Zone&)            = delete;
+	Zone& operator=(const Zone&) = delete;
+
+private:
+	const char* name_;
+	int64_t     start_ = -1; // Clock time in nanoseconds, -1 if no capture was running
+};
+
+bool     capturing();
+void     startCapture();
+void     stopCapture();
+unsigned numEvents();
+string   json();
+bool     save(string_view filename);
+} // namespace slade::trace
+
+#ifdef NO_TRACING
+#define TRACE_ZONE(name)
+#else
+#define TRACE_ZONE_VAR2(line) trace_zone_##line
+#define TRACE_ZONE_VAR(line)  TRACE_ZONE_VAR2(line)
+#define TRACE_ZONE(name)      slade::trace::Zone TRACE_ZONE_VAR(__LINE__)(name)
+#endif
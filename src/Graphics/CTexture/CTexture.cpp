@@ -36,6 +36,7 @@
 #include "General/Misc.h"
 #include "General/ResourceManager.h"
 #include "Graphics/SImage/SImage.h"
+#include "Graphics/SImage/SImageCache.h"
 #include "TextureXList.h"
 #include "Utility/StringUtils.h"
 #include "Utility/Tokenizer.h"
@@ -43,6 +44,83 @@
 using namespace slade;
 
 
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+CVAR(Int, ctexture_cache_size, 128, CVar::Flag::Save) // In MB
+
+
+// -----------------------------------------------------------------------------
+//
+// External Variables
+//
+// -----------------------------------------------------------------------------
+EXTERN_CVAR(Int, col_match)
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the cache used for decoded patch and composited texture images
+// -----------------------------------------------------------------------------
+SImageCache& imageCache()
+{
+	static SImageCache cache(0);
+	cache.setMaxSize(static_cast<size_t>(std::max(0, static_cast<int>(ctexture_cache_size))) * 1024 * 1024);
+	return cache;
+}
+
+// -----------------------------------------------------------------------------
+// Returns a hash of the colours in [pal] (0 if no palette)
+// -----------------------------------------------------------------------------
+uint64_t paletteHash(const Palette* pal)
+{
+	if (!pal)
+		return 0;
+
+	// FNV-1a
+	uint64_t hash = 14695981039346656037ull;
+	for (const auto& col : pal->colours())
+		for (auto c : { col.r, col.g, col.b, col.a })
+		{
+			hash ^= c;
+			hash *= 1099511628211ull;
+		}
+
+	return hash;
+}
+
+// -----------------------------------------------------------------------------
+// Loads the image in patch [entry] into [image], using the cached image if the
+// entry hasn't been modified since it was last loaded
+// -----------------------------------------------------------------------------
+bool loadPatchEntryImage(SImage& image, ArchiveEntry* entry)
+{
+	if (!entry)
+		return false;
+
+	// The entry version changes when it is modified (and is unique to each
+	// entry), so a stale image can't be picked up here
+	auto key = fmt::format("patch:{}:{}", fmt::ptr(entry), entry->version());
+	if (imageCache().get(key, image))
+		return true;
+
+	if (!misc::loadImageFromEntry(&image, entry))
+		return false;
+
+	imageCache().add(key, image);
+	return true;
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // CTPatch Class Functions
@@ -812,6 +890,16 @@ bool CTexture::convertRegular()
 // -----------------------------------------------------------------------------
 bool CTexture::toImage(SImage& image, Archive* parent, Palette* pal, bool force_rgba)
 {
+	// Check for a cached image of this texture. Defined textures aren't cached
+	// here since their size and scale are updated from the patch image below
+	string cache_key;
+	if (!defined_)
+	{
+		cache_key = compositeCacheKey(image, parent, pal, force_rgba);
+		if (!cache_key.empty() && imageCache().get(cache_key, image))
+			return true;
+	}
+
 	// Init image
 	image.clear();
 	image.resize(size_.x, size_.y);
@@ -920,11 +1008,14 @@ bool CTexture::toImage(SImage& image, Archive* parent, Palette* pal, bool force_
 		// Add each patch to image
 		for (auto& patch : patches_)
 		{
-			if (misc::loadImageFromEntry(&p_img, patch->patchEntry(parent)))
+			if (loadPatchEntryImage(p_img, patch->patchEntry(parent)))
 				image.drawImage(p_img, patch->xOffset(), patch->yOffset(), dp, pal, pal);
 		}
 	}
 
+	if (!cache_key.empty())
+		imageCache().add(cache_key, image);
+
 	return true;
 }
 
@@ -938,51 +1029,106 @@ bool CTexture::loadPatchImage(unsigned pindex, SImage& image, Archive* parent, P
 	if (pindex >= patches_.size())
 		return false;
 
+	// Texture-as-patch
+	if (auto* tex = texturePatch(pindex, parent))
+		return tex->toImage(image, parent, pal, force_rgba);
+
+	// Load entry to image if valid
+	return loadPatchEntryImage(image, patchImageEntry(pindex, parent));
+}
+
+// -----------------------------------------------------------------------------
+// Returns the texture used as the patch at [pindex], or nullptr if the patch
+// isn't a texture-as-patch
+// -----------------------------------------------------------------------------
+CTexture* CTexture::texturePatch(unsigned pindex, Archive* parent) const
+{
 	auto* patch = patches_[pindex].get();
 
-	// If the texture is extended, search for textures-as-patches first
+	// Only extended textures can use textures as patches
 	// (as long as the patch name is different from this texture's name)
-	if (extended_ && !strutil::equalCI(patch->name(), name_))
+	if (!extended_ || strutil::equalCI(patch->name(), name_))
+		return nullptr;
+
+	// Search the texture list we're in first
+	if (in_list_)
 	{
-		// Search the texture list we're in first
-		if (in_list_)
+		for (unsigned a = 0; a < in_list_->size(); a++)
 		{
-			for (unsigned a = 0; a < in_list_->size(); a++)
-			{
-				auto* tex = in_list_->texture(a);
+			auto* tex = in_list_->texture(a);
 
-				// Don't look past this texture in the list
-				if (tex->name() == name_)
-					break;
+			// Don't look past this texture in the list
+			if (tex->name() == name_)
+				break;
 
-				// Check for name match
-				if (strutil::equalCI(tex->name(), patch->name()))
-				{
-					// Load texture to image
-					return tex->toImage(image, parent, pal, force_rgba);
-				}
-			}
+			// Check for name match
+			if (strutil::equalCI(tex->name(), patch->name()))
+				return tex;
 		}
-
-		// Otherwise, try the resource manager
-		// TODO: Something has to be ignored here. The entire archive or just the current list?
-		auto* tex = app::resources().getTexture(patch->name(), "", parent);
-		if (tex)
-			return tex->toImage(image, parent, pal, force_rgba);
 	}
 
-	// Get patch entry
-	auto* entry = patch->patchEntry(parent);
+	// Otherwise, try the resource manager
+	// TODO: Something has to be ignored here. The entire archive or just the current list?
+	return app::resources().getTexture(patch->name(), "", parent);
+}
 
-	// Load entry to image if valid
-	if (entry)
-		return misc::loadImageFromEntry(&image, entry);
+// -----------------------------------------------------------------------------
+// Returns the entry containing the image for the patch at [pindex]
+// -----------------------------------------------------------------------------
+ArchiveEntry* CTexture::patchImageEntry(unsigned pindex, Archive* parent) const
+{
+	auto* patch = patches_[pindex].get();
+
+	// Get patch entry
+	if (auto* entry = patch->patchEntry(parent))
+		return entry;
 
 	// Maybe it's a texture?
-	entry = app::resources().getTextureEntry(patch->name(), "", parent);
+	return app::resources().getTextureEntry(patch->name(), "", parent);
+}
 
-	if (entry)
-		return misc::loadImageFromEntry(&image, entry);
+// -----------------------------------------------------------------------------
+// Returns a key identifying the result of toImage (with the given parameters)
+// in the image cache. The key includes the texture definition, the version of
+// each patch entry, the palette and the initial type of [image], so any change
+// to those will give a different key.
+// Returns an empty string if the image shouldn't be cached (ie. it uses
+// textures as patches, which aren't tracked)
+// -----------------------------------------------------------------------------
+string CTexture::compositeCacheKey(const SImage& image, Archive* parent, Palette* pal, bool force_rgba) const
+{
+	auto key = fmt::format(
+		"texture:{}:{}x{}:{}:{}:{}:{:x}:{}",
+		name_,
+		size_.x,
+		size_.y,
+		extended_,
+		static_cast<int>(image.type()),
+		force_rgba,
+		paletteHash(pal),
+		static_cast<int>(col_match));
+
+	auto out = std::back_inserter(key);
+	for (unsigned a = 0; a < patches_.size(); ++a)
+	{
+		auto*         patch = patches_[a].get();
+		ArchiveEntry* entry;
+		if (extended_)
+		{
+			if (texturePatch(a, parent))
+				return {};
+
+			key += dynamic_cast<CTPatchEx*>(patch)->asText();
+			entry = patchImageEntry(a, parent);
+		}
+		else
+		{
+			fmt::format_to(out, "\n{},{},{}", patch->name(), patch->xOffset(), patch->yOffset());
+			entry = patch->patchEntry(parent);
+		}
+
+		fmt::format_to(out, "@{}:{}", fmt::ptr(entry), entry ? entry->version() : 0);
+	}
 
-	return false;
+	return key;
 }
@@ -215,5 +215,9 @@ private:
 
 	// Signals
 	Signals signals_;
+
+	CTexture*     texturePatch(unsigned pindex, Archive* parent) const;
+	ArchiveEntry* patchImageEntry(unsigned pindex, Archive* parent) const;
+	string        compositeCacheKey(const SImage& image, Archive* parent, Palette* pal, bool force_rgba) const;
 };
 } // namespace slade
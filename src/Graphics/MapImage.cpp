@@ -0,0 +1,231 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2022 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    MapImage.cpp
+// Description: Functions for drawing map overview images in software, so they
+//              can be generated without an OpenGL context (or on worker
+//              threads)
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "MapImage.h"
+#include "General/ColourConfiguration.h"
+#include "Graphics/SImage/SImage.h"
+
+using namespace slade;
+using namespace gfx;
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// A simple RGBA pixel buffer to draw into
+// -----------------------------------------------------------------------------
+struct RGBABuffer
+{
+	vector<uint8_t> pixels;
+	int             width;
+	int             height;
+
+	RGBABuffer(int width, int height, const ColRGBA& fill) :
+		pixels(static_cast<size_t>(width) * height * 4), width{ width }, height{ height }
+	{
+		for (size_t a = 0; a < pixels.size(); a += 4)
+		{
+			pixels[a]     = fill.r;
+			pixels[a + 1] = fill.g;
+			pixels[a + 2] = fill.b;
+			pixels[a + 3] = fill.a;
+		}
+	}
+
+	// Blends [colour] over the pixel at [x,y] with [coverage] (0-1)
+	void blend(int x, int y, const ColRGBA& colour, float coverage)
+	{
+		auto* p = &pixels[(static_cast<size_t>(y) * width + x) * 4];
+		auto  a = colour.a / 255.f * coverage;
+		auto  i = 1.f - a;
+
+		p[0] = static_cast<uint8_t>(colour.r * a + p[0] * i + 0.5f);
+		p[1] = static_cast<uint8_t>(colour.g * a + p[1] * i + 0.5f);
+		p[2] = static_cast<uint8_t>(colour.b * a + p[2] * i + 0.5f);
+		p[3] = static_cast<uint8_t>(255.f * a + p[3] * i + 0.5f);
+	}
+};
+
+// -----------------------------------------------------------------------------
+// Draws an anti-aliased line [thickness] pixels wide from [p1] to [p2] (in
+// pixel coordinates) into [buffer].
+// Each pixel's coverage is taken from the distance between its centre and the
+// line, so only the pixels within the (rounded) line's outline are visited
+// -----------------------------------------------------------------------------
+void drawLineAA(RGBABuffer& buffer, Vec2d p1, Vec2d p2, const ColRGBA& colour, double thickness)
+{
+	const double half  = thickness * 0.5;
+	const double reach = half + 0.5; // Pixels further than this from the line aren't touched
+	const double dx    = p2.x - p1.x;
+	const double dy    = p2.y - p1.y;
+	const double len2  = dx * dx + dy * dy;
+	const double len   = std::sqrt(len2);
+
+	// Get rows to draw
+	const int    y_start = std::max(0, static_cast<int>(std::floor(std::min(p1.y, p2.y) - reach)));
+	const int    y_end   = std::min(buffer.height - 1, static_cast<int>(std::ceil(std::max(p1.y, p2.y) + reach)));
+	const double x_min   = std::min(p1.x, p2.x) - reach;
+	const double x_max   = std::max(p1.x, p2.x) + reach;
+
+	for (int y = y_start; y <= y_end; ++y)
+	{
+		const double cy = y + 0.5;
+
+		// Get the span of the line on this row
+		double xa = x_min;
+		double xb = x_max;
+		if (std::abs(dy) > 0.0001)
+		{
+			const double xc = p1.x + (cy - p1.y) * dx / dy;
+			const double hw = reach * len / std::abs(dy);
+			xa              = std::max(xa, xc - hw);
+			xb              = std::min(xb, xc + hw);
+		}
+
+		const int x_start = std::max(0, static_cast<int>(std::floor(xa)));
+		const int x_end   = std::min(buffer.width - 1, static_cast<int>(std::ceil(xb)));
+		for (int x = x_start; x <= x_end; ++x)
+		{
+			const double cx = x + 0.5;
+
+			// Get distance from pixel centre to the line
+			const double t    = len2 > 0. ? std::clamp(((cx - p1.x) * dx + (cy - p1.y) * dy) / len2, 0., 1.) : 0.;
+			const double ox   = cx - (p1.x + t * dx);
+			const double oy   = cy - (p1.y + t * dy);
+			const double dist = std::sqrt(ox * ox + oy * oy);
+
+			// Draw pixel with coverage based on distance
+			auto coverage = static_cast<float>(std::min(1., reach - dist));
+			if (coverage > 0.f)
+				buffer.blend(x, y, colour, coverage);
+		}
+	}
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Gfx Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns the map image colours from the current colour configuration.
+// Colour configuration isn't thread-safe, so call this from the main thread
+// -----------------------------------------------------------------------------
+MapImageColours gfx::mapImageColours()
+{
+	return { colourconfig::colour("map_image_background"),
+			 colourconfig::colour("map_image_line_1s"),
+			 colourconfig::colour("map_image_line_2s"),
+			 colourconfig::colour("map_image_line_special"),
+			 colourconfig::colour("map_image_line_macro") };
+}
+
+// -----------------------------------------------------------------------------
+// Draws [lines] scaled to fit a [width]x[height] image in [image], using
+// [colours] and lines [thickness] pixels wide.
+// This doesn't depend on anything global, so it can be run on worker threads
+// (eg. to draw images for many maps at once)
+// -----------------------------------------------------------------------------
+void gfx::drawMapImage(
+	SImage&                     image,
+	const vector<MapImageLine>& lines,
+	int                         width,
+	int                         height,
+	const MapImageColours&      colours,
+	double                      thickness)
+{
+	if (width <= 0 || height <= 0)
+		return;
+
+	RGBABuffer buffer(width, height, colours.background);
+
+	// Find extents of map
+	Vec2d m_min{ 999999.0, 999999.0 };
+	Vec2d m_max{ -999999.0, -999999.0 };
+	for (const auto& line : lines)
+	{
+		m_min.x = std::min({ m_min.x, line.start.x, line.end.x });
+		m_min.y = std::min({ m_min.y, line.start.y, line.end.y });
+		m_max.x = std::max({ m_max.x, line.start.x, line.end.x });
+		m_max.y = std::max({ m_max.y, line.start.y, line.end.y });
+	}
+	const double map_width  = m_max.x - m_min.x;
+	const double map_height = m_max.y - m_min.y;
+
+	if (!lines.empty() && map_width > 0 && map_height > 0)
+	{
+		// Zoom/offset to show the whole map, centered
+		const Vec2d  offset{ m_min.x + map_width * 0.5, m_min.y + map_height * 0.5 };
+		const double zoom = std::min(width / map_width, height / map_height) * 0.95;
+		const Vec2d  middle{ static_cast<double>(width >> 1), static_cast<double>(height >> 1) };
+
+		// Map -> image coordinates (map y-axis goes up)
+		auto toImage = [&](const Vec2d& pos) -> Vec2d {
+			return { middle.x + (pos.x - offset.x) * zoom, height - (middle.y + (pos.y - offset.y) * zoom) };
+		};
+
+		// Draw 2s lines first, so 1s lines are drawn over them
+		for (int pass = 0; pass < 2; ++pass)
+		{
+			for (const auto& line : lines)
+			{
+				if (line.twosided != (pass == 0))
+					continue;
+
+				const ColRGBA* colour;
+				if (line.special)
+					colour = &colours.line_special;
+				else if (line.macro)
+					colour = &colours.line_macro;
+				else if (line.twosided)
+					colour = &colours.line_2s;
+				else
+					colour = &colours.line_1s;
+
+				drawLineAA(buffer, toImage(line.start), toImage(line.end), *colour, thickness);
+			}
+		}
+	}
+
+	image.setImageData(buffer.pixels, width, height, SImage::Type::RGBA);
+}
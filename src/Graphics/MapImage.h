@@ -0,0 +1,44 @@
+#pragma once
+
+namespace slade
+{
+class SImage;
+
+namespace gfx
+{
+	// A line to draw in a map image (in map coordinates)
+	struct MapImageLine
+	{
+		Vec2d start;
+		Vec2d end;
+		bool  twosided = false;
+		bool  special  = false;
+		bool  macro    = false;
+
+		MapImageLine(Vec2d start, Vec2d end, bool twosided = false, bool special = false, bool macro = false) :
+			start{ start }, end{ end }, twosided{ twosided }, special{ special }, macro{ macro }
+		{
+		}
+	};
+
+	// The colours to draw a map image with
+	struct MapImageColours
+	{
+		ColRGBA background;
+		ColRGBA line_1s;
+		ColRGBA line_2s;
+		ColRGBA line_special;
+		ColRGBA line_macro;
+	};
+
+	MapImageColours mapImageColours();
+
+	void drawMapImage(
+		SImage&                     image,
+		const vector<MapImageLine>& lines,
+		int                         width,
+		int                         height,
+		const MapImageColours&      colours,
+		double                      thickness = 1.5);
+} // namespace gfx
+} // namespace slade
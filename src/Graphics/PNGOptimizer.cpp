@@ -0,0 +1,519 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2022 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         https://slade.mancubus.net
+// Filename:    PNGOptimizer.cpp
+// Description: Built-in lossless PNG optimizer. Tries each PNG row filter
+//              strategy with a few zlib compression strategies and rewrites
+//              the PNG with the smallest result, dropping ancillary chunks
+//              that don't affect how the image is used or displayed.
+//              Animated PNGs are left unchanged
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "PNGOptimizer.h"
+#include "Archive/ArchiveEntry.h"
+#include "General/Misc.h"
+#include "Utility/Compression.h"
+#include "Utility/ThreadPool.h"
+#include <zlib.h>
+
+using namespace slade;
+using namespace gfx;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+const uint8_t png_signature[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+
+// Row filter modes to try, 0-4 are the PNG filter types applied to every row
+const unsigned filter_adaptive = 5;
+const unsigned n_filter_modes  = 6;
+
+const int deflate_strategies[] = { Z_DEFAULT_STRATEGY, Z_FILTERED, Z_RLE };
+
+struct PNGChunk
+{
+	string   type;
+	uint32_t offset; // Offset of the chunk data
+	uint32_t size;
+};
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Reads the chunk list of the PNG in [png] up to (and including) IEND.
+// Returns false and sets [error] if it isn't a valid PNG
+// -----------------------------------------------------------------------------
+bool readChunks(const MemChunk& png, vector<PNGChunk>& chunks, string& error)
+{
+	if (png.size() < 8 || memcmp(png.data(), png_signature, 8) != 0)
+	{
+		error = "Invalid PNG signature";
+		return false;
+	}
+
+	uint32_t pos = 8;
+	while (pos + 12 <= png.size())
+	{
+		auto size = png.readB32(pos);
+		if (size > png.size() - pos - 12)
+		{
+			error = "Invalid PNG chunk size";
+			return false;
+		}
+
+		chunks.push_back({ string(reinterpret_cast<const char*>(png.data() + pos + 4), 4), pos + 8, size });
+		if (chunks.back().type == "IEND")
+			return true;
+
+		pos += size + 12;
+	}
+
+	error = "PNG has no IEND chunk";
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the chunk [type] is critical (can't be dropped)
+// -----------------------------------------------------------------------------
+bool isCritical(const string& type)
+{
+	return isupper(static_cast<unsigned char>(type[0]));
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the ancillary chunk [type] should be kept when optimizing:
+// transparency, offsets (grAb/alPh) and colour space info
+// -----------------------------------------------------------------------------
+bool keepChunk(const string& type)
+{
+	static const std::set<string> keep = { "tRNS", "grAb", "alPh", "gAMA", "cHRM", "sRGB", "iCCP", "sBIT" };
+
+	return keep.count(type) > 0;
+}
+
+// -----------------------------------------------------------------------------
+// Writes a PNG chunk of [type] with [size] bytes of [data] to [out]
+// -----------------------------------------------------------------------------
+void writeChunk(MemChunk& out, const string& type, const uint8_t* data, uint32_t size)
+{
+	auto start = out.currentPos();
+	auto csize = wxUINT32_SWAP_ON_LE(size);
+	out.write(&csize, 4);
+	out.write(type.data(), 4);
+	if (size > 0)
+		out.write(data, size);
+	auto crc = wxUINT32_SWAP_ON_LE(misc::crc(out.data() + start + 4, size + 4));
+	out.write(&crc, 4);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the PNG Paeth predictor for [a] (left), [b] (up) and [c] (up-left)
+// -----------------------------------------------------------------------------
+uint8_t paeth(int a, int b, int c)
+{
+	int p  = a + b - c;
+	int pa = std::abs(p - a);
+	int pb = std::abs(p - b);
+	int pc = std::abs(p - c);
+	if (pa <= pb && pa <= pc)
+		return a;
+	if (pb <= pc)
+		return b;
+	return c;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the value predicted for byte [x] of row [cur] by [filter]. [prev] is
+// the previous (unfiltered) row, [bpp] the number of bytes per complete pixel
+// -----------------------------------------------------------------------------
+uint8_t predict(unsigned filter, const uint8_t* cur, const uint8_t* prev, unsigned x, unsigned bpp)
+{
+	int a = x >= bpp ? cur[x - bpp] : 0;
+	int b = prev[x];
+	int c = x >= bpp ? prev[x - bpp] : 0;
+
+	switch (filter)
+	{
+	case 1:  return a;
+	case 2:  return b;
+	case 3:  return (a + b) / 2;
+	case 4:  return paeth(a, b, c);
+	default: return 0;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Reverses the row filters of the inflated image data in [filtered], writing
+// the raw rows to [pixels]. Returns false if the data is invalid
+// -----------------------------------------------------------------------------
+bool unfilterRows(
+	const MemChunk&  filtered,
+	vector<uint8_t>& pixels,
+	unsigned         height,
+	unsigned         row_bytes,
+	unsigned         bpp)
+{
+	if (filtered.size() != static_cast<uint64_t>(height) * (row_bytes + 1))
+		return false;
+
+	pixels.assign(static_cast<size_t>(height) * row_bytes, 0);
+	const vector<uint8_t> zero_row(row_bytes, 0);
+	for (unsigned y = 0; y < height; ++y)
+	{
+		auto src    = filtered.data() + y * (row_bytes + 1);
+		auto cur    = pixels.data() + y * row_bytes;
+		auto prev   = y > 0 ? cur - row_bytes : zero_row.data();
+		auto filter = src[0];
+		if (filter > 4)
+			return false;
+
+		for (unsigned x = 0; x < row_bytes; ++x)
+			cur[x] = src[x + 1] + predict(filter, cur, prev, x, bpp);
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Writes row [cur] to [out] (filter type byte first) filtered with [filter]
+// -----------------------------------------------------------------------------
+void filterRow(unsigned filter, const uint8_t* cur, const uint8_t* prev, unsigned row_bytes, unsigned bpp, uint8_t* out)
+{
+	out[0] = filter;
+	for (unsigned x = 0; x < row_bytes; ++x)
+		out[x + 1] = cur[x] - predict(filter, cur, prev, x, bpp);
+}
+
+// -----------------------------------------------------------------------------
+// Filters the raw image rows in [pixels] using filter [mode] to [out]. The
+// adaptive mode picks the filter for each row with the lowest sum of absolute
+// (signed) differences, the usual heuristic from libpng
+// -----------------------------------------------------------------------------
+void filterRows(
+	const vector<uint8_t>& pixels,
+	MemChunk&              out,
+	unsigned               height,
+	unsigned               row_bytes,
+	unsigned               bpp,
+	unsigned               mode)
+{
+	out.reSize(height * (row_bytes + 1), false);
+	const vector<uint8_t> zero_row(row_bytes, 0);
+	vector<uint8_t>       row(row_bytes + 1);
+	for (unsigned y = 0; y < height; ++y)
+	{
+		auto cur  = pixels.data() + y * row_bytes;
+		auto prev = y > 0 ? cur - row_bytes : zero_row.data();
+		auto dest = out.data() + y * (row_bytes + 1);
+		if (mode != filter_adaptive)
+		{
+			filterRow(mode, cur, prev, row_bytes, bpp, dest);
+			continue;
+		}
+
+		unsigned best_sum = std::numeric_limits<unsigned>::max();
+		for (unsigned filter = 0; filter <= 4; ++filter)
+		{
+			filterRow(filter, cur, prev, row_bytes, bpp, row.data());
+			unsigned sum = 0;
+			for (unsigned x = 1; x <= row_bytes && sum < best_sum; ++x)
+				sum += std::abs(static_cast<int8_t>(row[x]));
+
+			if (sum < best_sum)
+			{
+				best_sum = sum;
+				memcpy(dest, row.data(), row_bytes + 1);
+			}
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Deflates [filtered] with each zlib strategy at maximum compression, writing
+// the smallest result to [out] if it is smaller than [out] already is
+// -----------------------------------------------------------------------------
+void deflateSmallest(MemChunk& filtered, MemChunk& out)
+{
+	for (auto strategy : deflate_strategies)
+	{
+		MemChunk compressed;
+		if (!compression::zlibDeflate(filtered, compressed, 9, strategy))
+			continue;
+
+		if (!out.hasData() || compressed.size() < out.size())
+			out.importMem(compressed);
+	}
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// PNGOptimizeStats Struct Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns a summary of the optimization stats as a string
+// -----------------------------------------------------------------------------
+string PNGOptimizeStats::asString() const
+{
+	auto saved = bytes_in > bytes_out ? bytes_in - bytes_out : 0;
+	return fmt::format(
+		"{} PNGs optimized, {} unchanged, {} failed in {:.2f}s ({} saved, {} -> {})",
+		n_optimized,
+		n_unchanged,
+		n_failed,
+		seconds,
+		misc::sizeAsString(saved),
+		misc::sizeAsString(bytes_in),
+		misc::sizeAsString(bytes_out));
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Gfx Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Losslessly optimizes the PNG in [in], writing the result to [out].
+// Each row filter strategy is tried with each zlib strategy (in parallel) and
+// the smallest image data is kept. Interlaced images are only recompressed, as
+// their rows aren't stored in order, and animated PNGs aren't changed at all.
+// Returns true if a smaller PNG was written to [out], or false if it couldn't
+// be made any smaller or [in] isn't a valid PNG (in which case [error] is set)
+// -----------------------------------------------------------------------------
+bool gfx::optimizePNG(const MemChunk& in, MemChunk& out, string* error)
+{
+	string           err;
+	vector<PNGChunk> chunks;
+	MemChunk         idat;
+	const PNGChunk*  ihdr = nullptr;
+	if (!readChunks(in, chunks, err))
+	{
+		if (error)
+			*error = err;
+		return false;
+	}
+
+	// Check chunks, and join the image data from all IDAT chunks
+	for (const auto& chunk : chunks)
+	{
+		if (chunk.type == "IHDR")
+			ihdr = &chunk;
+		else if (chunk.type == "IDAT")
+			idat.write(in.data() + chunk.offset, chunk.size);
+		else if (chunk.type == "acTL")
+			return false; // Leave animated PNGs as they are, the frame chunks would need rewriting too
+		else if (isCritical(chunk.type) && chunk.type != "PLTE" && chunk.type != "IEND")
+			err = fmt::format("Unsupported PNG chunk {}", chunk.type);
+	}
+	if (!ihdr || ihdr->size < 13 || !idat.hasData())
+		err = "PNG has no IHDR or IDAT chunk";
+
+	// Inflate image data
+	MemChunk filtered;
+	if (err.empty() && !compression::zlibInflate(idat, filtered))
+		err = "Invalid PNG image data";
+
+	if (!err.empty())
+	{
+		if (error)
+			*error = err;
+		return false;
+	}
+
+	// Get image info from the header
+	auto     width      = in.readB32(ihdr->offset);
+	auto     height     = in.readB32(ihdr->offset + 4);
+	unsigned bit_depth  = in[ihdr->offset + 8];
+	unsigned colour     = in[ihdr->offset + 9];
+	bool     interlaced = in[ihdr->offset + 12] != 0;
+	unsigned channels   = 1;
+	if (colour == 2)
+		channels = 3;
+	else if (colour == 4)
+		channels = 2;
+	else if (colour == 6)
+		channels = 4;
+	auto bits_per_pixel = channels * bit_depth;
+	auto bpp            = std::max(1u, bits_per_pixel / 8);
+	auto row_bytes      = static_cast<unsigned>((static_cast<uint64_t>(width) * bits_per_pixel + 7) / 8);
+
+	// Get raw image rows (unless interlaced)
+	vector<uint8_t> pixels;
+	bool            refilter = !interlaced && unfilterRows(filtered, pixels, height, row_bytes, bpp);
+
+	// Try each filter mode on worker threads
+	vector<MemChunk> results(refilter ? n_filter_modes : 1);
+	threadpool::parallelFor(
+		results.size(),
+		[&](size_t index)
+		{
+			if (!refilter)
+			{
+				deflateSmallest(filtered, results[index]);
+				return;
+			}
+
+			MemChunk mode_filtered;
+			filterRows(pixels, mode_filtered, height, row_bytes, bpp, index);
+			deflateSmallest(mode_filtered, results[index]);
+		});
+
+	// Pick the smallest image data, keeping the original if nothing was smaller
+	const MemChunk* best = &idat;
+	for (const auto& result : results)
+		if (result.hasData() && result.size() < best->size())
+			best = &result;
+
+	// Rebuild the PNG with the needed chunks only and a single IDAT chunk
+	out.clear();
+	out.write(png_signature, 8);
+	bool idat_written = false;
+	for (const auto& chunk : chunks)
+	{
+		if (chunk.type == "IDAT")
+		{
+			if (!idat_written)
+				writeChunk(out, chunk.type, best->data(), best->size());
+			idat_written = true;
+		}
+		else if (isCritical(chunk.type) || keepChunk(chunk.type))
+			writeChunk(out, chunk.type, in.data() + chunk.offset, chunk.size);
+	}
+
+	return out.size() < in.size();
+}
+
+// -----------------------------------------------------------------------------
+// Optimizes the PNG entries in [items] on the global thread pool. Results (and
+// any errors) are set in each item, entries are not modified (see
+// writeOptimizedPNGs)
+// -----------------------------------------------------------------------------
+PNGOptimizeStats gfx::optimizePNGs(vector<PNGOptimizeItem>& items)
+{
+	PNGOptimizeStats stats;
+	const sf::Clock  timer;
+
+	// Load entry data on this thread first, since it isn't thread-safe
+	for (auto& item : items)
+	{
+		item.status = PNGOptimizeItem::Status::Pending;
+		item.error.clear();
+		item.data.clear();
+
+		if (item.entry)
+			item.entry->data();
+		else
+		{
+			item.status = PNGOptimizeItem::Status::Failed;
+			item.error  = "No entry given";
+		}
+	}
+
+	// Optimize on worker threads
+	threadpool::parallelFor(
+		items.size(),
+		[&items](size_t index)
+		{
+			auto& item = items[index];
+			if (item.status != PNGOptimizeItem::Status::Pending)
+				return;
+
+			if (optimizePNG(item.entry->data(false), item.data, &item.error))
+				item.status = PNGOptimizeItem::Status::Optimized;
+			else if (item.error.empty())
+				item.status = PNGOptimizeItem::Status::Unchanged;
+			else
+				item.status = PNGOptimizeItem::Status::Failed;
+		});
+
+	for (const auto& item : items)
+	{
+		if (item.status == PNGOptimizeItem::Status::Failed)
+		{
+			stats.n_failed++;
+			continue;
+		}
+
+		auto size = item.entry->size();
+		stats.bytes_in += size;
+		if (item.status == PNGOptimizeItem::Status::Optimized)
+		{
+			stats.n_optimized++;
+			stats.bytes_out += item.data.size();
+		}
+		else
+		{
+			stats.n_unchanged++;
+			stats.bytes_out += size;
+		}
+	}
+
+	stats.seconds = timer.getElapsedTime().asSeconds();
+	log::info(2, "PNG optimization: {}", stats.asString());
+
+	return stats;
+}
+
+// -----------------------------------------------------------------------------
+// Writes the data of all optimized [items] back to their entries, in order.
+// Must be called from the main thread.
+// Returns the number of entries written
+// -----------------------------------------------------------------------------
+unsigned gfx::writeOptimizedPNGs(vector<PNGOptimizeItem>& items)
+{
+	unsigned count = 0;
+	for (auto& item : items)
+	{
+		if (item.status != PNGOptimizeItem::Status::Optimized || !item.entry || !item.data.hasData())
+			continue;
+
+		item.entry->importMemChunk(item.data);
+		count++;
+	}
+
+	return count;
+}
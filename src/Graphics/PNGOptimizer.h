@@ -0,0 +1,48 @@
+#pragma once
+
+namespace slade
+{
+class ArchiveEntry;
+
+namespace gfx
+{
+	// A PNG entry to optimize as part of a batch
+	struct PNGOptimizeItem
+	{
+		enum class Status
+		{
+			Pending,
+			Optimized, // A smaller PNG was written to [data]
+			Unchanged, // The PNG couldn't be made any smaller
+			Failed     // The entry data couldn't be read as a PNG
+		};
+
+		// Input
+		ArchiveEntry* entry = nullptr;
+
+		// Output
+		Status   status = Status::Pending;
+		MemChunk data;
+		string   error;
+
+		PNGOptimizeItem(ArchiveEntry* entry = nullptr) : entry{ entry } {}
+	};
+
+	// Info about a completed batch optimization
+	struct PNGOptimizeStats
+	{
+		unsigned n_optimized = 0;
+		unsigned n_unchanged = 0;
+		unsigned n_failed    = 0;
+		size_t   bytes_in    = 0;
+		size_t   bytes_out   = 0;
+		double   seconds     = 0.;
+
+		string asString() const;
+	};
+
+	bool             optimizePNG(const MemChunk& in, MemChunk& out, string* error = nullptr);
+	PNGOptimizeStats optimizePNGs(vector<PNGOptimizeItem>& items);
+	unsigned         writeOptimizedPNGs(vector<PNGOptimizeItem>& items);
+} // namespace gfx
+} // namespace slade
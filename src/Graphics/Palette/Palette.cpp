@@ -55,6 +55,13 @@ CVAR(Float, col_match_l, 1.0, CVar::Flag::Save)
 EXTERN_CVAR(Float, col_greyscale_r)
 EXTERN_CVAR(Float, col_greyscale_g)
 EXTERN_CVAR(Float, col_greyscale_b)
+EXTERN_CVAR(Float, col_cie_kl)
+EXTERN_CVAR(Float, col_cie_k1)
+EXTERN_CVAR(Float, col_cie_k2)
+EXTERN_CVAR(Float, col_cie_kc)
+EXTERN_CVAR(Float, col_cie_kh)
+EXTERN_CVAR(Float, col_cie_tristim_x)
+EXTERN_CVAR(Float, col_cie_tristim_z)
 
 
 // -----------------------------------------------------------------------------
@@ -110,6 +117,8 @@ bool Palette::loadMem(MemChunk& mc)
 	}
 	mc.seek(0, SEEK_SET);
 
+	nearest_cache_.clear();
+
 	return true;
 }
 
@@ -136,6 +145,8 @@ bool Palette::loadMem(const uint8_t* data, uint32_t size)
 			break;
 	}
 
+	nearest_cache_.clear();
+
 	return true;
 }
 
@@ -462,6 +473,7 @@ void Palette::setColour(uint8_t index, const ColRGBA& col)
 	colours_[index].index = index;
 	colours_lab_[index]   = colours_[index].asLAB();
 	colours_hsl_[index]   = colours_[index].asHSL();
+	nearest_cache_.clear();
 }
 
 // -----------------------------------------------------------------------------
@@ -472,6 +484,7 @@ void Palette::setColourR(uint8_t index, uint8_t val)
 	colours_[index].r   = val;
 	colours_lab_[index] = colours_[index].asLAB();
 	colours_hsl_[index] = colours_[index].asHSL();
+	nearest_cache_.clear();
 }
 
 // -----------------------------------------------------------------------------
@@ -482,6 +495,7 @@ void Palette::setColourG(uint8_t index, uint8_t val)
 	colours_[index].g   = val;
 	colours_lab_[index] = colours_[index].asLAB();
 	colours_hsl_[index] = colours_[index].asHSL();
+	nearest_cache_.clear();
 }
 
 // -----------------------------------------------------------------------------
@@ -492,6 +506,7 @@ void Palette::setColourB(uint8_t index, uint8_t val)
 	colours_[index].b   = val;
 	colours_lab_[index] = colours_[index].asLAB();
 	colours_hsl_[index] = colours_[index].asHSL();
+	nearest_cache_.clear();
 }
 
 // -----------------------------------------------------------------------------
@@ -527,6 +542,8 @@ void Palette::setGradient(uint8_t startIndex, uint8_t endIndex, const ColRGBA& s
 			a + startIndex);
 		colours_[a + startIndex].set(gradCol);
 	}
+
+	nearest_cache_.clear();
 }
 
 // -----------------------------------------------------------------------------
@@ -604,15 +621,11 @@ double Palette::colourDiff(const ColRGBA& rgb, const ColHSL& hsl, const ColLAB&
 }
 
 // -----------------------------------------------------------------------------
-// Returns the index of the closest colour in the palette to [colour]
+// Returns the colour matching settings used by nearestColour for [match]
+// (or the col_match cvar if Default), including the cvars that affect it
 // -----------------------------------------------------------------------------
-short Palette::nearestColour(const ColRGBA& colour, ColourMatch match)
+Palette::MatchSettings Palette::matchSettings(ColourMatch match)
 {
-	double min_d = 999999;
-	short  index = 0;
-	ColHSL chsl  = colour.asHSL();
-	ColLAB clab  = colour.asLAB();
-
 	// Be nice if there was an easier way to convert from int -> enum class,
 	// but then that's kind of the point of them I guess
 	static vector<ColourMatch> cm_convert = {
@@ -622,6 +635,103 @@ short Palette::nearestColour(const ColRGBA& colour, ColourMatch match)
 	if (match == ColourMatch::Default)
 		match = cm_convert[col_match];
 
+	// The RGB and HSL methods are also affected by weighting cvars, and the CIE
+	// methods by the colorimetry cvars
+	MatchSettings settings;
+	settings.match = match;
+	if (match == ColourMatch::RGB)
+	{
+		settings.params[0] = col_match_r;
+		settings.params[1] = col_match_g;
+		settings.params[2] = col_match_b;
+	}
+	else if (match == ColourMatch::HSL)
+	{
+		settings.params[0] = col_match_h;
+		settings.params[1] = col_match_s;
+		settings.params[2] = col_match_l;
+	}
+	else if (match == ColourMatch::C76 || match == ColourMatch::C94 || match == ColourMatch::C2K)
+	{
+		settings.params[0] = col_cie_kl;
+		settings.params[1] = col_cie_k1;
+		settings.params[2] = col_cie_k2;
+		settings.params[3] = col_cie_kc;
+		settings.params[4] = col_cie_kh;
+		settings.params[5] = col_cie_tristim_x;
+		settings.params[6] = col_cie_tristim_z;
+	}
+
+	return settings;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the index of the closest colour in the palette to [colour].
+// Results are cached per RGB value (for the current match method and its
+// settings), so repeated lookups of the same colour don't need to search the
+// palette again
+// -----------------------------------------------------------------------------
+short Palette::nearestColour(const ColRGBA& colour, ColourMatch match)
+{
+	// Cached results depend on the match method and its settings
+	auto settings = matchSettings(match);
+	match         = settings.match;
+
+	auto block_index = (colour.r >> 4) << 8 | (colour.g >> 4) << 4 | colour.b >> 4;
+	auto col_index   = (colour.r & 15) << 8 | (colour.g & 15) << 4 | (colour.b & 15);
+
+	// Check cache
+	{
+		std::lock_guard lock(nearest_cache_.mutex);
+
+		// Reset if the match method or its parameters changed since the cache
+		// was filled
+		auto& cache = nearest_cache_;
+		if (cache.settings != settings)
+		{
+			cache.blocks.clear();
+			cache.settings = settings;
+		}
+
+		if (!cache.blocks.empty() && cache.blocks[block_index] && cache.blocks[block_index][col_index] >= 0)
+			return cache.blocks[block_index][col_index];
+	}
+
+	// Not cached, search the palette (outside the lock, this is the slow part)
+	auto index = nearestColourSearch(colour, match);
+
+	// Add to cache
+	std::lock_guard lock(nearest_cache_.mutex);
+	auto&           cache = nearest_cache_;
+	if (cache.settings == settings)
+	{
+		if (cache.blocks.empty())
+			cache.blocks.resize(4096);
+
+		auto& block = cache.blocks[block_index];
+		if (!block)
+		{
+			block = std::make_unique<int16_t[]>(4096);
+			std::fill_n(block.get(), 4096, -1);
+		}
+
+		block[col_index] = index;
+	}
+
+	return index;
+}
+
+// -----------------------------------------------------------------------------
+// Searches the palette for the closest colour to [colour] using the colour
+// matching method [match], and returns its index
+// -----------------------------------------------------------------------------
+short Palette::nearestColourSearch(const ColRGBA& colour, ColourMatch match)
+{
+	double min_d = 999999;
+	short  index = 0;
+	ColHSL chsl  = colour.asHSL();
+	ColLAB clab  = colour.asLAB();
+
 	double delta;
 	for (short a = 0; a < 256; a++)
 	{
@@ -808,6 +918,8 @@ void Palette::saturate(float amount, int start, int end)
 		colours_[i]     = colours_hsl_[i].asRGB();
 		colours_lab_[i] = colours_[i].asLAB();
 	}
+
+	nearest_cache_.clear();
 }
 
 // -----------------------------------------------------------------------------
@@ -836,6 +948,8 @@ void Palette::illuminate(float amount, int start, int end)
 		colours_[i]     = colours_hsl_[i].asRGB();
 		colours_lab_[i] = colours_[i].asLAB();
 	}
+
+	nearest_cache_.clear();
 }
 
 // -----------------------------------------------------------------------------
@@ -864,6 +978,8 @@ void Palette::shift(float amount, int start, int end)
 		colours_[i]     = colours_hsl_[i].asRGB();
 		colours_lab_[i] = colours_[i].asLAB();
 	}
+
+	nearest_cache_.clear();
 }
 
 // -----------------------------------------------------------------------------
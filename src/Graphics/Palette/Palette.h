@@ -1,5 +1,6 @@
 #pragma once
 #include "Utility/Colour.h"
+#include <mutex>
 
 namespace slade
 {
@@ -28,6 +29,22 @@ public:
 		Stop,
 	};
 
+	// A colour matching method and the values of any cvars that affect its
+	// results (RGB/HSL weights or CIE colorimetry settings)
+	struct MatchSettings
+	{
+		static const unsigned N_PARAMS = 7;
+
+		ColourMatch match            = ColourMatch::Default;
+		float       params[N_PARAMS] = {};
+
+		bool operator==(const MatchSettings& other) const
+		{
+			return match == other.match && memcmp(params, other.params, sizeof(params)) == 0;
+		}
+		bool operator!=(const MatchSettings& other) const { return !(*this == other); }
+	};
+
 	Palette(unsigned size = 256);
 	Palette(const Palette& pal) : Palette(pal.colours_.size()) { copyPalette(&pal); }
 	~Palette() = default;
@@ -68,12 +85,40 @@ public:
 	// For automated palette generation
 	void idtint(int r, int g, int b, int shift, int steps);
 
+	static MatchSettings matchSettings(ColourMatch match = ColourMatch::Default);
+
 private:
-	vector<ColRGBA> colours_;
-	vector<ColHSL>  colours_hsl_;
-	vector<ColLAB>  colours_lab_;
-	short           index_trans_;
+	// Cache of nearestColour results for each RGB value, split into blocks of
+	// 16x16x16 colours that are only allocated when first needed.
+	// Copying a palette doesn't copy the cache
+	struct NearestColourCache
+	{
+		MatchSettings                 settings; // Colour matching settings the cache is for
+		vector<unique_ptr<int16_t[]>> blocks;
+		std::mutex                    mutex;
+
+		NearestColourCache() = default;
+		NearestColourCache(const NearestColourCache&) {}
+		NearestColourCache& operator=(const NearestColourCache&)
+		{
+			clear();
+			return *this;
+		}
+
+		void clear()
+		{
+			std::lock_guard lock(mutex);
+			blocks.clear();
+		}
+	};
+
+	vector<ColRGBA>    colours_;
+	vector<ColHSL>     colours_hsl_;
+	vector<ColLAB>     colours_lab_;
+	short              index_trans_;
+	NearestColourCache nearest_cache_;
 
 	double colourDiff(const ColRGBA& rgb, const ColHSL& hsl, const ColLAB& lab, int index, ColourMatch match);
+	short  nearestColourSearch(const ColRGBA& colour, ColourMatch match);
 };
 } // namespace slade
@@ -0,0 +1,218 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2022 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         https://slade.mancubus.net
+// Filename:    BatchConvert.cpp
+// Description: Functions for converting many images at once, loading,
+//              converting and writing them on worker threads
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "BatchConvert.h"
+#include "Archive/ArchiveEntry.h"
+#include "General/Misc.h"
+#include "Utility/StringUtils.h"
+#include "Utility/ThreadPool.h"
+
+using namespace slade;
+using namespace gfx;
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Loads, converts and writes the image for [item] as needed.
+// This is run on worker threads, so it must only touch [item]
+// -----------------------------------------------------------------------------
+void processItem(BatchConvertItem& item, SIFormat* format, bool convert, bool write)
+{
+	if (item.status != BatchConvertItem::Status::Pending)
+		return;
+
+	if (item.format)
+		format = item.format;
+
+	// Load image from entry if needed
+	if (!item.image.isValid())
+	{
+		if (!item.entry || !misc::loadImageFromEntry(&item.image, item.entry))
+		{
+			item.status = BatchConvertItem::Status::LoadFailed;
+			item.error  = global::error;
+			return;
+		}
+	}
+
+	if (!format)
+	{
+		item.status = BatchConvertItem::Status::NotWritable;
+		item.error  = "No image format given";
+		return;
+	}
+
+	// Convert
+	if (convert)
+	{
+		if (format->canWrite(item.image) == SIFormat::Writable::No
+			|| (item.options.col_format != SImage::Type::Unknown && !format->canWriteType(item.options.col_format)))
+		{
+			item.status = BatchConvertItem::Status::NotWritable;
+			item.error  = fmt::format("Image can't be converted to {}", format->name());
+			return;
+		}
+
+		format->convertWritable(item.image, item.options);
+	}
+
+	// Write
+	if (write && !format->saveImage(item.image, item.data, item.write_palette))
+	{
+		item.status = BatchConvertItem::Status::WriteFailed;
+		item.error  = global::error;
+		return;
+	}
+
+	item.status = BatchConvertItem::Status::Done;
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// BatchConvertStats Struct Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns a summary of the conversion stats as a string
+// -----------------------------------------------------------------------------
+string BatchConvertStats::asString() const
+{
+	auto per_sec = seconds > 0. ? static_cast<double>(n_done) / seconds : 0.;
+	return fmt::format(
+		"{} images converted, {} failed in {:.2f}s ({:.1f} images/sec, {} in, {} out)",
+		n_done,
+		n_failed,
+		seconds,
+		per_sec,
+		misc::sizeAsString(bytes_in),
+		misc::sizeAsString(bytes_out));
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Gfx Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Processes all [items] on the global thread pool. Each item's image is loaded
+// from its entry (unless it already has a valid image), then converted to be
+// writable as [format] (or the item's own format, if set) using the item's
+// options if [convert] is true, then written to the item's data if [write] is
+// true.
+// Results (and any errors) are set in each item, entries are not modified (see
+// writeConvertedImages)
+// -----------------------------------------------------------------------------
+BatchConvertStats gfx::convertImages(vector<BatchConvertItem>& items, SIFormat* format, bool convert, bool write)
+{
+	BatchConvertStats stats;
+	const sf::Clock   timer;
+
+	// Get entries ready on this thread first, since loading entry data and
+	// detecting entry types aren't safe to do from multiple threads at once
+	for (auto& item : items)
+	{
+		item.status = BatchConvertItem::Status::Pending;
+		item.error.clear();
+		item.data.clear();
+
+		if (item.image.isValid() || !item.entry)
+			continue;
+
+		item.entry->data();
+		if (item.entry->type() == EntryType::unknownType())
+			EntryType::detectEntryType(*item.entry);
+		stats.bytes_in += item.entry->size();
+
+		// Jaguar images need data from other entries to load, so load those here
+		if (strutil::startsWith(item.entry->type()->formatId(), "img_jaguar")
+			&& !misc::loadImageFromEntry(&item.image, item.entry))
+		{
+			item.status = BatchConvertItem::Status::LoadFailed;
+			item.error  = global::error;
+		}
+	}
+
+	// Process items on worker threads
+	threadpool::parallelFor(items.size(), [&](size_t index) { processItem(items[index], format, convert, write); });
+
+	for (const auto& item : items)
+	{
+		if (item.status == BatchConvertItem::Status::Done)
+		{
+			stats.n_done++;
+			stats.bytes_out += item.data.size();
+		}
+		else
+			stats.n_failed++;
+	}
+
+	stats.seconds = timer.getElapsedTime().asSeconds();
+	log::info(2, "Batch image conversion: {}", stats.asString());
+
+	return stats;
+}
+
+// -----------------------------------------------------------------------------
+// Writes the data of all successfully converted [items] back to their entries,
+// in order. Must be called from the main thread.
+// Returns the number of entries written
+// -----------------------------------------------------------------------------
+unsigned gfx::writeConvertedImages(vector<BatchConvertItem>& items)
+{
+	unsigned count = 0;
+	for (auto& item : items)
+	{
+		if (item.status != BatchConvertItem::Status::Done || !item.entry || !item.data.hasData())
+			continue;
+
+		item.entry->importMemChunk(item.data);
+		EntryType::detectEntryType(*item.entry);
+		item.entry->setExtensionByType();
+		count++;
+	}
+
+	return count;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "SIFormat.h"
+#include "SImage.h"
+
+namespace slade
+{
+class ArchiveEntry;
+
+namespace gfx
+{
+	// An image to convert as part of a batch
+	struct BatchConvertItem
+	{
+		enum class Status
+		{
+			Pending,
+			Done,
+			LoadFailed,  // Couldn't load the image from the entry
+			NotWritable, // The image can't be converted to the target format
+			WriteFailed  // The image couldn't be written in the target format
+		};
+
+		// Input
+		ArchiveEntry*            entry = nullptr; // Image is loaded from here if [image] isn't valid
+		SImage                   image;
+		SIFormat*                format = nullptr;        // If set, used instead of the batch format
+		SIFormat::ConvertOptions options;                 // Only used if converting
+		Palette*                 write_palette = nullptr; // Only used if writing
+
+		// Output
+		Status   status = Status::Pending;
+		MemChunk data; // The written image data (if writing)
+		string   error;
+
+		BatchConvertItem(ArchiveEntry* entry = nullptr) : entry{ entry } {}
+	};
+
+	// Info about a completed batch conversion
+	struct BatchConvertStats
+	{
+		unsigned n_done    = 0;
+		unsigned n_failed  = 0;
+		size_t   bytes_in  = 0;
+		size_t   bytes_out = 0;
+		double   seconds   = 0.;
+
+		string asString() const;
+	};
+
+	BatchConvertStats convertImages(
+		vector<BatchConvertItem>& items,
+		SIFormat*                 format  = nullptr,
+		bool                      convert = true,
+		bool                      write   = true);
+	unsigned writeConvertedImages(vector<BatchConvertItem>& items);
+} // namespace gfx
+} // namespace slade
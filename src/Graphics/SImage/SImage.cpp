@@ -36,8 +36,17 @@
 #include "Graphics/Translation.h"
 #include "SIFormat.h"
 #include "Utility/MathStuff.h"
+#include <atomic>
+#include <mutex>
 #undef BOOL
 
+// SSE2 blending is only used when the compiler can't fuse multiply-adds in the
+// scalar version, otherwise results could differ slightly between the two
+#if (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)) && !defined(__FMA__)
+#include <emmintrin.h>
+#define SIMAGE_SSE2
+#endif
+
 using namespace slade;
 
 
@@ -51,6 +60,272 @@ EXTERN_CVAR(Float, col_greyscale_g)
 EXTERN_CVAR(Float, col_greyscale_b)
 
 
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the result of blending [colour] onto [d_colour] using [blend]
+// -----------------------------------------------------------------------------
+ColRGBA blendColour(const ColRGBA& colour, ColRGBA d_colour, SImage::BlendType blend)
+{
+	const float alpha = static_cast<float>(colour.a) / 255.0f;
+
+	// Additive blending
+	if (blend == SImage::BlendType::Add)
+	{
+		d_colour.set(
+			math::clamp(d_colour.r + colour.r * alpha, 0, 255),
+			math::clamp(d_colour.g + colour.g * alpha, 0, 255),
+			math::clamp(d_colour.b + colour.b * alpha, 0, 255),
+			math::clamp(d_colour.a + colour.a, 0, 255));
+	}
+
+	// Subtractive blending
+	else if (blend == SImage::BlendType::Subtract)
+	{
+		d_colour.set(
+			math::clamp(d_colour.r - colour.r * alpha, 0, 255),
+			math::clamp(d_colour.g - colour.g * alpha, 0, 255),
+			math::clamp(d_colour.b - colour.b * alpha, 0, 255),
+			math::clamp(d_colour.a + colour.a, 0, 255));
+	}
+
+	// Reverse-Subtractive blending
+	else if (blend == SImage::BlendType::ReverseSubtract)
+	{
+		d_colour.set(
+			math::clamp((-d_colour.r) + colour.r * alpha, 0, 255),
+			math::clamp((-d_colour.g) + colour.g * alpha, 0, 255),
+			math::clamp((-d_colour.b) + colour.b * alpha, 0, 255),
+			math::clamp(d_colour.a + colour.a, 0, 255));
+	}
+
+	// 'Modulate' blending
+	else if (blend == SImage::BlendType::Modulate)
+	{
+		d_colour.set(
+			math::clamp(colour.r * static_cast<double>(d_colour.r) / 255., 0, 255),
+			math::clamp(colour.g * static_cast<double>(d_colour.g) / 255., 0, 255),
+			math::clamp(colour.b * static_cast<double>(d_colour.b) / 255., 0, 255),
+			math::clamp(d_colour.a + colour.a, 0, 255));
+	}
+
+	// Normal blending (or unknown blend type)
+	else
+	{
+		const float inv_alpha = 1.0f - alpha;
+		d_colour.set(
+			d_colour.r * inv_alpha + colour.r * alpha,
+			d_colour.g * inv_alpha + colour.g * alpha,
+			d_colour.b * inv_alpha + colour.b * alpha,
+			math::clamp(d_colour.a + colour.a, 0, 255));
+	}
+
+	return d_colour;
+}
+
+// Function to blend a row of pixels onto RGBA pixel data
+using RGBARowBlender = void (*)(const ColRGBA* src, uint8_t* dest, unsigned count);
+
+#ifdef SIMAGE_SSE2
+// -----------------------------------------------------------------------------
+// SSE2 version of blendColour for RGBA pixels, blends [colour] onto the pixel
+// at [dest]. Gives exactly the same result as blendColour (the same single
+// precision operations are done for each channel, just all at once)
+// -----------------------------------------------------------------------------
+template<SImage::BlendType Blend> void blendPixelSSE2(const ColRGBA& colour, uint8_t* dest)
+{
+	const auto zero = _mm_setzero_si128();
+
+	// Load source and dest pixels as 4 floats each
+	int32_t s_packed = colour.r | colour.g << 8 | colour.b << 16 | colour.a << 24;
+	int32_t d_packed;
+	memcpy(&d_packed, dest, 4);
+	auto s = _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(s_packed), zero), zero));
+	auto d = _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(d_packed), zero), zero));
+
+	const float alpha   = static_cast<float>(colour.a) / 255.0f;
+	auto        s_alpha = _mm_mul_ps(s, _mm_set1_ps(alpha));
+
+	__m128 result;
+	if constexpr (Blend == SImage::BlendType::Add)
+		result = _mm_add_ps(d, s_alpha);
+	else if constexpr (Blend == SImage::BlendType::Subtract)
+		result = _mm_sub_ps(d, s_alpha);
+	else if constexpr (Blend == SImage::BlendType::ReverseSubtract)
+		result = _mm_sub_ps(s_alpha, d);
+	else
+		result = _mm_add_ps(_mm_mul_ps(d, _mm_set1_ps(1.0f - alpha)), s_alpha);
+
+	// Clamp, truncate and pack back into 4 bytes
+	result        = _mm_min_ps(_mm_max_ps(result, _mm_setzero_ps()), _mm_set1_ps(255.0f));
+	auto packed   = _mm_cvttps_epi32(result);
+	packed        = _mm_packus_epi16(_mm_packs_epi32(packed, zero), zero);
+	auto r_packed = _mm_cvtsi128_si32(packed);
+	memcpy(dest, &r_packed, 3);
+
+	// Alpha is always added
+	dest[3] = std::min(dest[3] + colour.a, 255);
+}
+#endif
+
+// -----------------------------------------------------------------------------
+// Blends a row of [count] [src] pixels onto RGBA pixel data at [dest] using
+// [Blend]. Source pixels should already have the draw alpha applied, any with
+// 0 alpha are skipped
+// -----------------------------------------------------------------------------
+template<SImage::BlendType Blend> void blendRowRGBA(const ColRGBA* src, uint8_t* dest, unsigned count)
+{
+	for (unsigned a = 0; a < count; ++a, dest += 4)
+	{
+		const auto& colour = src[a];
+		if (colour.a == 0)
+			continue;
+
+		// Simple case (normal blending, no transparency involved)
+		if (Blend == SImage::BlendType::Normal && colour.a == 255)
+		{
+			colour.write(dest);
+			continue;
+		}
+
+#ifdef SIMAGE_SSE2
+		if constexpr (Blend != SImage::BlendType::Modulate)
+		{
+			blendPixelSSE2<Blend>(colour, dest);
+			continue;
+		}
+#endif
+
+		blendColour(colour, ColRGBA(dest[0], dest[1], dest[2], dest[3]), Blend).write(dest);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns the row blending function to use for RGBA images with [blend]
+// -----------------------------------------------------------------------------
+RGBARowBlender rgbaRowBlender(SImage::BlendType blend)
+{
+	switch (blend)
+	{
+	case SImage::BlendType::Add:             return &blendRowRGBA<SImage::BlendType::Add>;
+	case SImage::BlendType::Subtract:        return &blendRowRGBA<SImage::BlendType::Subtract>;
+	case SImage::BlendType::ReverseSubtract: return &blendRowRGBA<SImage::BlendType::ReverseSubtract>;
+	case SImage::BlendType::Modulate:        return &blendRowRGBA<SImage::BlendType::Modulate>;
+	default:                                 return &blendRowRGBA<SImage::BlendType::Normal>;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Lookup tables for blending paletted pixels onto paletted pixels, giving the
+// resulting palette index for each source index, source alpha and dest index.
+// Opaque normal blending doesn't depend on the dest index, so it uses a single
+// 256 entry map filled in on creation. Tables for each other alpha value are
+// created and filled in as they are needed.
+//
+// Tables are cached for reuse by later draws with the same palettes and blend
+// type (see get), and can be used from multiple threads at once
+// -----------------------------------------------------------------------------
+class PaletteBlendTable
+{
+public:
+	PaletteBlendTable(const Palette& pal_src, const Palette& pal_dest, SImage::BlendType blend) :
+		pal_src_{ pal_src },
+		pal_dest_{ pal_dest },
+		blend_{ blend },
+		settings_{ Palette::matchSettings() }
+	{
+		for (unsigned a = 0; a < 256; ++a)
+			opaque_[a] = pal_dest_.nearestColour(pal_src_.colour(a), settings_.match);
+	}
+
+	uint8_t blend(uint8_t src_index, uint8_t alpha, uint8_t dest_index)
+	{
+		if (alpha == 255 && blend_ == SImage::BlendType::Normal)
+			return opaque_[src_index];
+
+		auto& result = alphaTable(alpha)[src_index << 8 | dest_index];
+		auto  index  = result.load(std::memory_order_relaxed);
+		if (index < 0)
+		{
+			auto colour = pal_src_.colour(src_index);
+			colour.a    = alpha;
+			index       = pal_dest_.nearestColour(
+				  blendColour(colour, pal_dest_.colour(dest_index), blend_), settings_.match);
+			result.store(index, std::memory_order_relaxed);
+		}
+
+		return static_cast<uint8_t>(index);
+	}
+
+	// Returns a (cached) blend table for [pal_src], [pal_dest] and [blend]
+	static shared_ptr<PaletteBlendTable> get(const Palette& pal_src, const Palette& pal_dest, SImage::BlendType blend)
+	{
+		static std::mutex                            mutex;
+		static vector<shared_ptr<PaletteBlendTable>> cache;
+
+		auto            settings = Palette::matchSettings();
+		std::lock_guard lock(mutex);
+		for (const auto& table : cache)
+			if (table->blend_ == blend && table->settings_ == settings && sameColours(table->pal_src_, pal_src)
+				&& sameColours(table->pal_dest_, pal_dest))
+				return table;
+
+		// Not cached, add (removing the oldest table if the cache is full)
+		if (cache.size() >= MAX_CACHED)
+			cache.erase(cache.begin());
+		return cache.emplace_back(std::make_shared<PaletteBlendTable>(pal_src, pal_dest, blend));
+	}
+
+private:
+	static const unsigned MAX_CACHED = 8;
+
+	Palette                                    pal_src_;
+	Palette                                    pal_dest_;
+	SImage::BlendType                          blend_;
+	Palette::MatchSettings                     settings_;
+	uint8_t                                    opaque_[256];
+	std::atomic<std::atomic<int16_t>*>         tables_[256] = {};
+	vector<unique_ptr<std::atomic<int16_t>[]>> table_data_; // Owns the tables in tables_
+	std::mutex                                 mutex_;
+
+	// Returns the table for [alpha], creating it if needed
+	std::atomic<int16_t>* alphaTable(uint8_t alpha)
+	{
+		auto table = tables_[alpha].load(std::memory_order_acquire);
+		if (table)
+			return table;
+
+		std::lock_guard lock(mutex_);
+		table = tables_[alpha].load(std::memory_order_relaxed);
+		if (!table)
+		{
+			table = table_data_.emplace_back(std::make_unique<std::atomic<int16_t>[]>(65536)).get();
+			for (unsigned a = 0; a < 65536; ++a)
+				table[a].store(-1, std::memory_order_relaxed);
+			tables_[alpha].store(table, std::memory_order_release);
+		}
+
+		return table;
+	}
+
+	static bool sameColours(const Palette& left, const Palette& right)
+	{
+		return std::equal(
+			left.colours().begin(),
+			left.colours().end(),
+			right.colours().begin(),
+			right.colours().end(),
+			[](const ColRGBA& l, const ColRGBA& r) { return l.equals(r, true); });
+	}
+};
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // SImage Class Functions
@@ -1439,58 +1714,7 @@ bool SImage::drawPixel(int x, int y, ColRGBA colour, DrawProps& properties, Pale
 		d_colour = pal->colour(data_[p]);
 	else
 		d_colour.set(data_[p], data_[p + 1], data_[p + 2], data_[p + 3]);
-	const float alpha = static_cast<float>(colour.a) / 255.0f;
-
-	// Additive blending
-	if (properties.blend == BlendType::Add)
-	{
-		d_colour.set(
-			math::clamp(d_colour.r + colour.r * alpha, 0, 255),
-			math::clamp(d_colour.g + colour.g * alpha, 0, 255),
-			math::clamp(d_colour.b + colour.b * alpha, 0, 255),
-			math::clamp(d_colour.a + colour.a, 0, 255));
-	}
-
-	// Subtractive blending
-	else if (properties.blend == BlendType::Subtract)
-	{
-		d_colour.set(
-			math::clamp(d_colour.r - colour.r * alpha, 0, 255),
-			math::clamp(d_colour.g - colour.g * alpha, 0, 255),
-			math::clamp(d_colour.b - colour.b * alpha, 0, 255),
-			math::clamp(d_colour.a + colour.a, 0, 255));
-	}
-
-	// Reverse-Subtractive blending
-	else if (properties.blend == BlendType::ReverseSubtract)
-	{
-		d_colour.set(
-			math::clamp((-d_colour.r) + colour.r * alpha, 0, 255),
-			math::clamp((-d_colour.g) + colour.g * alpha, 0, 255),
-			math::clamp((-d_colour.b) + colour.b * alpha, 0, 255),
-			math::clamp(d_colour.a + colour.a, 0, 255));
-	}
-
-	// 'Modulate' blending
-	else if (properties.blend == BlendType::Modulate)
-	{
-		d_colour.set(
-			math::clamp(colour.r * static_cast<double>(d_colour.r) / 255., 0, 255),
-			math::clamp(colour.g * static_cast<double>(d_colour.g) / 255., 0, 255),
-			math::clamp(colour.b * static_cast<double>(d_colour.b) / 255., 0, 255),
-			math::clamp(d_colour.a + colour.a, 0, 255));
-	}
-
-	// Normal blending (or unknown blend type)
-	else
-	{
-		const float inv_alpha = 1.0f - alpha;
-		d_colour.set(
-			d_colour.r * inv_alpha + colour.r * alpha,
-			d_colour.g * inv_alpha + colour.g * alpha,
-			d_colour.b * inv_alpha + colour.b * alpha,
-			math::clamp(d_colour.a + colour.a, 0, 255));
-	}
+	d_colour = blendColour(colour, d_colour, properties.blend);
 
 	// Apply new colour
 	if (type_ == Type::PalMask)
@@ -1523,57 +1747,101 @@ bool SImage::drawImage(SImage& img, int x_pos, int y_pos, DrawProps& properties,
 	if (has_palette_ || !pal_dest)
 		pal_dest = &palette_;
 
-	// Go through pixels
-	const unsigned s_stride = img.stride();
-	const uint8_t  s_bpp    = img.bpp();
-	unsigned       sp       = 0;
-	for (int y = y_pos; y < y_pos + img.height_; y++) // Rows
+	// Get the area of this image to draw to
+	const int x_start = std::max(x_pos, 0);
+	const int x_end   = std::min(x_pos + img.width_, width_);
+	const int y_start = std::max(y_pos, 0);
+	const int y_end   = std::min(y_pos + img.height_, height_);
+	if (x_start >= x_end || y_start >= y_end)
+		return true;
+
+	// Setup blending for the image types and blend mode once here, rather
+	// than working it out for every pixel
+	const bool                    src_paletted = img.type_ == Type::PalMask;
+	RGBARowBlender                rgba_blender = nullptr;
+	shared_ptr<PaletteBlendTable> pal_table;
+	if (type_ == Type::RGBA)
+		rgba_blender = rgbaRowBlender(properties.blend);
+	else if (type_ == Type::PalMask && src_paletted)
+		pal_table = PaletteBlendTable::get(*pal_src, *pal_dest, properties.blend);
+
+	// Go through rows
+	const unsigned  s_stride = img.stride();
+	const uint8_t   s_bpp    = img.bpp();
+	const unsigned  count    = x_end - x_start;
+	vector<ColRGBA> row(count);
+	vector<uint8_t> row_indices(src_paletted ? count : 0);
+	for (int y = y_start; y < y_end; y++)
 	{
-		// Skip out-of-bounds rows
-		if (y < 0 || y >= height_)
+		// Read source row as RGBA
+		unsigned sp = (y - y_pos) * s_stride + (x_start - x_pos) * s_bpp;
+		for (unsigned a = 0; a < count; ++a, sp += s_bpp)
+		{
+			if (src_paletted)
+			{
+				row[a]         = pal_src->colour(img.data_[sp]);
+				row[a].a       = img.mask_[sp];
+				row_indices[a] = img.data_[sp];
+			}
+			else if (img.type_ == Type::RGBA)
+				row[a].set(img.data_[sp], img.data_[sp + 1], img.data_[sp + 2], img.data_[sp + 3]);
+			else if (img.type_ == Type::AlphaMap)
+				row[a].set(img.data_[sp], img.data_[sp], img.data_[sp], img.data_[sp]);
+		}
+
+		// Alpha maps aren't really drawn on to, just draw pixel-by-pixel
+		if (type_ != Type::RGBA && type_ != Type::PalMask)
 		{
-			sp += s_stride;
+			for (unsigned a = 0; a < count; ++a)
+				if (row[a].a > 0)
+					drawPixel(x_start + a, y, row[a], properties, pal_dest);
 			continue;
 		}
 
-		for (int x = x_pos; x < x_pos + img.width_; x++) // Columns
+		// Setup alpha (fully transparent source pixels are left at 0 to skip)
+		for (auto& colour : row)
 		{
-			// Skip out-of-bounds columns
-			if (x < 0 || x >= width_)
-			{
-				sp += s_bpp;
+			if (colour.a == 0)
 				continue;
-			}
 
-			// Skip if source pixel is fully transparent
-			if ((img.type_ == Type::PalMask && img.mask_[sp] == 0)
-				|| (img.type_ == Type::AlphaMap && img.data_[sp] == 0)
-				|| (img.type_ == Type::RGBA && img.data_[sp + 3] == 0))
-			{
-				sp += s_bpp;
+			if (properties.src_alpha)
+				colour.a *= properties.alpha;
+			else
+				colour.a = 255 * properties.alpha;
+		}
+
+		// RGBA
+		const unsigned p = y * stride() + x_start * bpp();
+		if (rgba_blender)
+		{
+			rgba_blender(row.data(), data_.data() + p, count);
+			continue;
+		}
+
+		// Paletted
+		auto* dest      = data_.data() + p;
+		auto* dest_mask = mask_.data() + p;
+		for (unsigned a = 0; a < count; ++a)
+		{
+			const auto& colour = row[a];
+			if (colour.a == 0)
 				continue;
-			}
 
-			// Draw pixel
-			if (img.type_ == Type::PalMask)
+			// Simple case (normal blending, no transparency involved)
+			if (colour.a == 255 && properties.blend == BlendType::Normal)
 			{
-				ColRGBA col = pal_src->colour(img.data_[sp]);
-				col.a       = img.mask_[sp];
-				drawPixel(x, y, col, properties, pal_dest);
+				dest[a]      = pal_table ? pal_table->blend(row_indices[a], colour.a, dest[a]) :
+										   pal_dest->nearestColour(colour);
+				dest_mask[a] = colour.a;
+				continue;
 			}
-			else if (img.type_ == Type::RGBA)
-				drawPixel(
-					x,
-					y,
-					ColRGBA(img.data_[sp], img.data_[sp + 1], img.data_[sp + 2], img.data_[sp + 3]),
-					properties,
-					pal_dest);
-			else if (img.type_ == Type::AlphaMap)
-				drawPixel(
-					x, y, ColRGBA(img.data_[sp], img.data_[sp], img.data_[sp], img.data_[sp]), properties, pal_dest);
 
-			// Go to next source pixel
-			sp += s_bpp;
+			auto d_colour = pal_dest->colour(dest[a]);
+			if (pal_table)
+				dest[a] = pal_table->blend(row_indices[a], colour.a, dest[a]);
+			else
+				dest[a] = pal_dest->nearestColour(blendColour(colour, d_colour, properties.blend));
+			dest_mask[a] = std::min(d_colour.a + colour.a, 255);
 		}
 	}
 
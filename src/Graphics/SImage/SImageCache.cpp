@@ -0,0 +1,153 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2022 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         https://slade.mancubus.net
+// Filename:    SImageCache.cpp
+// Description: SImageCache class - A size-limited LRU cache of images, used to
+//              avoid repeatedly decoding/compositing the same images
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "SImageCache.h"
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the (approximate) memory used by [image]'s pixel data
+// -----------------------------------------------------------------------------
+size_t imageMemorySize(const SImage& image)
+{
+	// Paletted images also have a mask (1 byte per pixel)
+	auto bytes_per_pixel = image.type() == SImage::Type::PalMask ? 2 : image.bpp();
+	return static_cast<size_t>(image.width()) * image.height() * bytes_per_pixel + sizeof(SImage);
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// SImageCache Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Sets the maximum total size of cached images to [max_size] bytes, removing
+// least recently used images if needed
+// -----------------------------------------------------------------------------
+void SImageCache::setMaxSize(size_t max_size)
+{
+	std::lock_guard lock(mutex_);
+
+	max_size_ = max_size;
+	evict(max_size_);
+}
+
+// -----------------------------------------------------------------------------
+// Copies the cached image for [key] into [image].
+// Returns false if there is no cached image for [key]
+// -----------------------------------------------------------------------------
+bool SImageCache::get(const string& key, SImage& image)
+{
+	shared_ptr<SImage> cached;
+	{
+		std::lock_guard lock(mutex_);
+
+		auto i = lookup_.find(key);
+		if (i == lookup_.end())
+			return false;
+
+		// Move to front (most recently used)
+		images_.splice(images_.begin(), images_, i->second);
+		cached = i->second->image;
+	}
+
+	// Copy outside the lock, copyImage will signal that [image] has changed
+	return image.copyImage(cached.get());
+}
+
+// -----------------------------------------------------------------------------
+// Adds a copy of [image] to the cache for [key], replacing any existing cached
+// image for [key]
+// -----------------------------------------------------------------------------
+void SImageCache::add(const string& key, const SImage& image)
+{
+	auto size = imageMemorySize(image);
+
+	std::lock_guard lock(mutex_);
+
+	// Remove existing image for key
+	if (auto i = lookup_.find(key); i != lookup_.end())
+	{
+		current_size_ -= i->second->size;
+		images_.erase(i->second);
+		lookup_.erase(i);
+	}
+
+	// Don't bother with images that would take up most of the cache
+	if (size > max_size_ / 2)
+		return;
+
+	// Make room and add
+	evict(max_size_ - size);
+	images_.emplace_front(key, image, size);
+	lookup_[key] = images_.begin();
+	current_size_ += size;
+}
+
+// -----------------------------------------------------------------------------
+// Removes all cached images
+// -----------------------------------------------------------------------------
+void SImageCache::clear()
+{
+	std::lock_guard lock(mutex_);
+
+	images_.clear();
+	lookup_.clear();
+	current_size_ = 0;
+}
+
+// -----------------------------------------------------------------------------
+// Removes least recently used images until the total size of cached images is
+// at most [max_size] bytes
+// -----------------------------------------------------------------------------
+void SImageCache::evict(size_t max_size)
+{
+	while (current_size_ > max_size && !images_.empty())
+	{
+		current_size_ -= images_.back().size;
+		lookup_.erase(images_.back().key);
+		images_.pop_back();
+	}
+}
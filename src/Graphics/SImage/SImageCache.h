@@ -0,0 +1,58 @@
+#pragma once
+
+#include "SImage.h"
+#include <list>
+#include <mutex>
+
+namespace slade
+{
+// -----------------------------------------------------------------------------
+// A cache of images keyed by string, with a maximum total size (in bytes).
+// When adding an image would go over the maximum size, the least recently used
+// images are removed until it fits.
+//
+// Keys should include everything the image depends on (eg. entry version,
+// palette), so stale images simply stop being requested and age out
+// -----------------------------------------------------------------------------
+class SImageCache
+{
+public:
+	SImageCache(size_t max_size) : max_size_{ max_size } {}
+	~SImageCache() = default;
+
+	// Non-copyable
+	SImageCache(const SImageCache&)            = delete;
+	SImageCache& operator=(const SImageCache&) = delete;
+
+	size_t maxSize() const { return max_size_; }
+	size_t currentSize() const { return current_size_; }
+	size_t nImages() const { return lookup_.size(); }
+
+	void setMaxSize(size_t max_size);
+
+	bool get(const string& key, SImage& image);
+	void add(const string& key, const SImage& image);
+	void clear();
+
+private:
+	struct CachedImage
+	{
+		string             key;
+		shared_ptr<SImage> image; // Shared so it can be copied from outside the lock
+		size_t             size;
+
+		CachedImage(const string& key, const SImage& image, size_t size) :
+			key{ key }, image{ std::make_shared<SImage>(image) }, size{ size }
+		{
+		}
+	};
+
+	size_t                                                       max_size_;
+	size_t                                                       current_size_ = 0;
+	std::list<CachedImage>                                       images_; // Most recently used first
+	std::unordered_map<string, std::list<CachedImage>::iterator> lookup_;
+	std::mutex                                                   mutex_;
+
+	void evict(size_t max_size);
+};
+} // namespace slade
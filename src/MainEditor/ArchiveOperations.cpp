@@ -62,7 +62,7 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 typedef std::map<wxString, int>                   StrIntMap;
 typedef std::map<wxString, vector<ArchiveEntry*>> PathMap;
-typedef std::map<int, vector<ArchiveEntry*>>      CRCMap;
+typedef std::map<uint64_t, vector<ArchiveEntry*>> CRCMap; // Key is (size << 32 | crc)
 
 
 // -----------------------------------------------------------------------------
@@ -369,7 +369,7 @@ void archiveoperations::removeEntriesUnchangedFromIWAD(Archive* archive)
 		other                  = bra->findLast(search);
 
 		// If there is one, and it is identical, remove it
-		if (other != nullptr && (other->data().crc() == entry->data().crc()))
+		if (other != nullptr && other->hasSameContent(*entry))
 		{
 			++count;
 			dups += wxString::Format("%s\n", search.match_name);
@@ -882,17 +882,16 @@ bool archiveoperations::checkZDoomOverriddenEntriesInIWAD(Archive* archive)
 }
 
 // -----------------------------------------------------------------------------
-// Checks [archive] for multiple entries with the same data, and displays a list
-// of the duplicate entries' names if any are found
+// Returns a list of groups of entries in [archive] that have the same data. The
+// first entry in each group is the one the others duplicate
 // -----------------------------------------------------------------------------
-bool archiveoperations::checkDuplicateEntryContent(const Archive* archive)
+vector<vector<ArchiveEntry*>> archiveoperations::findDuplicateEntryContent(const Archive* archive)
 {
 	CRCMap map_entries;
 
 	// Get list of all entries in archive
 	vector<ArchiveEntry*> entries;
 	archive->putEntryTreeAsList(entries);
-	wxString dups = "";
 
 	// Go through list
 	for (auto& entry : entries)
@@ -906,28 +905,38 @@ bool archiveoperations::checkDuplicateEntryContent(const Archive* archive)
 			continue;
 
 		// Enqueue entries
-		map_entries[entry->data().crc()].push_back(entry);
+		map_entries[static_cast<uint64_t>(entry->size()) << 32 | entry->contentHash()].push_back(entry);
 	}
 
-	// Now iterate through the dupes to list the name of the duplicated entries
-	auto i = map_entries.begin();
-	while (i != map_entries.end())
+	// Get groups of duplicates
+	vector<vector<ArchiveEntry*>> duplicates;
+	for (auto& i : map_entries)
+		if (i.second.size() > 1)
+			duplicates.push_back(std::move(i.second));
+
+	return duplicates;
+}
+
+// -----------------------------------------------------------------------------
+// Checks [archive] for multiple entries with the same data, and displays a list
+// of the duplicate entries' names if any are found
+// -----------------------------------------------------------------------------
+bool archiveoperations::checkDuplicateEntryContent(const Archive* archive)
+{
+	wxString dups = "";
+
+	// Iterate through the dupes to list the name of the duplicated entries
+	for (const auto& group : findDuplicateEntryContent(archive))
 	{
-		if (i->second.size() > 1)
+		wxString name = group[0]->path(true);
+		name.Remove(0, 1);
+		dups += wxString::Format("\n%s\t(%8x) duplicated by", name, group[0]->contentHash());
+		for (unsigned a = 1; a < group.size(); a++)
 		{
-			wxString name = i->second[0]->path(true);
+			name = group[a]->path(true);
 			name.Remove(0, 1);
-			dups += wxString::Format("\n%s\t(%8x) duplicated by", name, i->first);
-			auto j = i->second.begin() + 1;
-			while (j != i->second.end())
-			{
-				name = (*j)->path(true);
-				name.Remove(0, 1);
-				dups += wxString::Format("\t%s", name);
-				++j;
-			}
+			dups += wxString::Format("\t%s", name);
 		}
-		++i;
 	}
 
 	// If no duplicates exist, do nothing
@@ -973,11 +982,20 @@ struct TexUsed
 	TexUsed() : used(false) {}
 };
 WX_DECLARE_STRING_HASH_MAP(TexUsed, TexUsedMap);
-void archiveoperations::removeUnusedTextures(Archive* archive)
+
+// -----------------------------------------------------------------------------
+// Returns a list of textures in [archive]'s TEXTUREx lists that aren't used in
+// any of its maps. Textures whose switch counterpart is used, or that also
+// exist in the base resource, are marked as not safe to remove.
+// Returns an empty list if [archive] contains no maps
+// -----------------------------------------------------------------------------
+vector<archiveoperations::UnusedTexture> archiveoperations::findUnusedTextures(Archive* archive)
 {
+	vector<UnusedTexture> unused;
+
 	// Check archive was given
 	if (!archive)
-		return;
+		return unused;
 
 	// --- Build list of used textures ---
 	TexUsedMap used_textures;
@@ -1057,7 +1075,7 @@ void archiveoperations::removeUnusedTextures(Archive* archive)
 
 	// Check if any maps were found
 	if (total_maps == 0)
-		return;
+		return unused;
 
 	// Find all TEXTUREx entries
 	opt.match_name  = "";
@@ -1106,13 +1124,6 @@ void archiveoperations::removeUnusedTextures(Archive* archive)
 		}
 	}
 
-	// Pop up a dialog with a checkbox list of unused textures
-	wxMultiChoiceDialog dialog(
-		theMainWindow,
-		"The following textures are not used in any map,\nselect which textures to delete",
-		"Delete Unused Textures",
-		unused_tex);
-
 	// Get base resource textures (if any)
 	auto                  base_resource = app::archiveManager().baseResourceArchive();
 	vector<ArchiveEntry*> base_tx_entries;
@@ -1126,8 +1137,7 @@ void archiveoperations::removeUnusedTextures(Archive* archive)
 	for (unsigned a = 0; a < tx.size(); a++)
 		base_resource_textures.emplace_back(tx.texture(a)->name());
 
-	// Determine which textures to check initially
-	wxArrayInt selection;
+	// Determine which textures are safe to remove
 	for (unsigned a = 0; a < unused_tex.size(); a++)
 	{
 		bool swtex = false;
@@ -1166,40 +1176,96 @@ void archiveoperations::removeUnusedTextures(Archive* archive)
 			}
 		}
 
-		if (!swtex && !br_tex)
-			selection.Add(a);
+		unused.push_back({ unused_tex[a], !swtex && !br_tex });
 	}
-	dialog.SetSelections(selection);
 
-	int n_removed = 0;
-	if (dialog.ShowModal() == wxID_OK)
+	return unused;
+}
+
+// -----------------------------------------------------------------------------
+// Removes all textures in [textures] from the TEXTUREx lists in [archive].
+// Returns the number of textures removed
+// -----------------------------------------------------------------------------
+int archiveoperations::removeTextures(Archive* archive, const vector<wxString>& textures)
+{
+	if (!archive)
+		return 0;
+
+	// Find all TEXTUREx entries
+	Archive::SearchOptions opt;
+	opt.match_type  = EntryType::fromId("texturex");
+	auto tx_entries = archive->findAll(opt);
+
+	// Go through texture lists
+	PatchTable ptable; // Dummy patch table, patch info not needed here
+	int        n_removed = 0;
+	for (auto& entry : tx_entries)
 	{
-		// Get selected textures
-		selection = dialog.GetSelections();
+		TextureXList txlist;
+		txlist.readTEXTUREXData(entry, ptable);
 
-		// Go through texture lists
-		for (auto& entry : tx_entries)
+		// Go through textures to delete
+		for (const auto& name : textures)
 		{
-			TextureXList txlist;
-			txlist.readTEXTUREXData(entry, ptable);
+			// Get texture index
+			int index = txlist.textureIndex(wxutil::strToView(name));
 
-			// Go through selected textures to delete
-			for (int i : selection)
+			// Delete it from the list (if found)
+			if (index >= 0)
 			{
-				// Get texture index
-				int index = txlist.textureIndex(wxutil::strToView(unused_tex[i]));
-
-				// Delete it from the list (if found)
-				if (index >= 0)
-				{
-					txlist.removeTexture(index);
-					n_removed++;
-				}
+				txlist.removeTexture(index);
+				n_removed++;
 			}
-
-			// Write texture list data back to entry
-			txlist.writeTEXTUREXData(entry, ptable);
 		}
+
+		// Write texture list data back to entry
+		txlist.writeTEXTUREXData(entry, ptable);
+	}
+
+	return n_removed;
+}
+
+// -----------------------------------------------------------------------------
+// Finds textures in [archive] that aren't used in any of its maps, and lets the
+// user select which of them to remove
+// -----------------------------------------------------------------------------
+void archiveoperations::removeUnusedTextures(Archive* archive)
+{
+	// Check archive was given
+	if (!archive)
+		return;
+
+	// Find unused textures (none will be found if there are no maps)
+	auto unused = findUnusedTextures(archive);
+	if (unused.empty())
+		return;
+
+	// Determine which textures to check initially
+	wxArrayString unused_tex;
+	wxArrayInt    selection;
+	for (unsigned a = 0; a < unused.size(); a++)
+	{
+		unused_tex.Add(unused[a].name);
+		if (unused[a].safe_to_remove)
+			selection.Add(a);
+	}
+
+	// Pop up a dialog with a checkbox list of unused textures
+	wxMultiChoiceDialog dialog(
+		theMainWindow,
+		"The following textures are not used in any map,\nselect which textures to delete",
+		"Delete Unused Textures",
+		unused_tex);
+	dialog.SetSelections(selection);
+
+	int n_removed = 0;
+	if (dialog.ShowModal() == wxID_OK)
+	{
+		// Remove selected textures
+		vector<wxString> to_remove;
+		for (int i : dialog.GetSelections())
+			to_remove.push_back(unused_tex[i]);
+		n_removed = removeTextures(archive, to_remove);
 	}
 
 	wxMessageBox(wxString::Format("Removed %d unused textures", n_removed));
@@ -4,6 +4,12 @@
 
 namespace slade::archiveoperations
 {
+struct UnusedTexture
+{
+	wxString name;
+	bool     safe_to_remove;
+};
+
 bool save(Archive& archive);
 bool saveAs(Archive& archive);
 
@@ -19,6 +25,11 @@ void removeEntriesUnchangedFromIWAD(Archive* archive);
 bool checkOverriddenEntriesInIWAD(Archive* archive);
 bool checkZDoomOverriddenEntriesInIWAD(Archive* archive);
 
+// Without any dialogs (eg. for batch mode)
+vector<vector<ArchiveEntry*>> findDuplicateEntryContent(const Archive* archive);
+vector<UnusedTexture>         findUnusedTextures(Archive* archive);
+int                           removeTextures(Archive* archive, const vector<wxString>& textures);
+
 // Search and replace in maps
 size_t replaceThings(Archive* archive, int oldtype, int newtype);
 size_t replaceTextures(
@@ -39,6 +39,8 @@
 #include "General/Console.h"
 #include "General/Misc.h"
 #include "Graphics/Graphics.h"
+#include "Graphics/PNGOptimizer.h"
+#include "Graphics/SImage/BatchConvert.h"
 #include "Graphics/SImage/SIFormat.h"
 #include "MainEditor/MainEditor.h"
 #include "SLADEWxApp.h"
@@ -1179,9 +1181,49 @@ bool entryoperations::exportAsPNG(ArchiveEntry* entry, const wxString& filename)
 }
 
 // -----------------------------------------------------------------------------
-// Attempts to optimize [entry] using external PNG optimizers.
+// Exports all [entries] as PNG images to files in [path], named from the entry
+// names. The images are loaded and written on worker threads.
+// Returns the number of entries successfully exported
 // -----------------------------------------------------------------------------
-bool entryoperations::optimizePNG(ArchiveEntry* entry)
+int entryoperations::exportAsPNG(const vector<ArchiveEntry*>& entries, const wxString& path)
+{
+	// Setup batch (palettes must be found on this thread)
+	vector<gfx::BatchConvertItem> items;
+	items.reserve(entries.size());
+	for (auto* entry : entries)
+	{
+		auto& item         = items.emplace_back(entry);
+		item.write_palette = maineditor::currentPalette(entry);
+	}
+
+	// Load and write png data
+	gfx::convertImages(items, SIFormat::getFormat("png"), false, true);
+
+	// Export files
+	auto count = 0;
+	for (const auto& item : items)
+	{
+		if (item.status != gfx::BatchConvertItem::Status::Done)
+		{
+			log::error(wxString::Format("Error converting %s: %s", item.entry->name(), item.error));
+			continue;
+		}
+
+		wxFileName fn(item.entry->name());
+		fn.SetPath(path);
+		fn.SetExt("png");
+		if (item.data.exportFile(fn.GetFullPath().ToStdString()))
+			count++;
+	}
+
+	return count;
+}
+
+// -----------------------------------------------------------------------------
+// Attempts to optimize [entry] using the built-in PNG optimizer (if [builtin]
+// is true), then any external PNG optimizers that are configured
+// -----------------------------------------------------------------------------
+bool entryoperations::optimizePNG(ArchiveEntry* entry, bool builtin)
 {
 	// Check entry was given
 	if (!entry)
@@ -1198,13 +1240,34 @@ bool entryoperations::optimizePNG(ArchiveEntry* entry)
 		return false;
 	}
 
-	// Check if the PNG tools path are set up, at least one of them should be
+	// Run built-in optimizer
+	if (builtin)
+	{
+		MemChunk optimized;
+		string   error;
+		auto     oldsize = entry->size();
+		if (gfx::optimizePNG(entry->data(), optimized, &error))
+		{
+			entry->importMemChunk(optimized);
+			log::info("PNG {} size {} =SLADE=> {}", entry->name(), oldsize, entry->size());
+		}
+		else if (!error.empty())
+		{
+			log::error("Unable to optimize PNG {}: {}", entry->name(), error);
+			return false;
+		}
+	}
+
+	// Check if the PNG tools path are set up, if none are there's nothing more to do
 	wxString pngpathc = path_pngcrush;
 	wxString pngpatho = path_pngout;
 	wxString pngpathd = path_deflopt;
 	if ((pngpathc.IsEmpty() || !wxFileExists(pngpathc)) && (pngpatho.IsEmpty() || !wxFileExists(pngpatho))
 		&& (pngpathd.IsEmpty() || !wxFileExists(pngpathd)))
 	{
+		if (builtin)
+			return true;
+
 		log::error(1, "PNG tool paths not defined or invalid, no optimization done.");
 		return false;
 	}
@@ -24,7 +24,8 @@ namespace entryoperations
 	bool cleanZdTextureSinglePatch(const vector<ArchiveEntry*>& entries);
 	bool compileACS(ArchiveEntry* entry, bool hexen = false, ArchiveEntry* target = nullptr, wxFrame* parent = nullptr);
 	bool exportAsPNG(ArchiveEntry* entry, const wxString& filename);
-	bool optimizePNG(ArchiveEntry* entry);
+	int  exportAsPNG(const vector<ArchiveEntry*>& entries, const wxString& path);
+	bool optimizePNG(ArchiveEntry* entry, bool builtin = true);
 
 	// ANIMATED/SWITCHES
 	bool convertAnimated(ArchiveEntry* entry, MemChunk* animdata, bool animdefs);
@@ -89,7 +89,7 @@ wxDEFINE_EVENT(wxEVT_COMMAND_DIRARCHIVECHECK_COMPLETED, wxThreadEvent);
 DirArchiveCheck::DirArchiveCheck(wxEvtHandler* handler, DirArchive* archive) :
 	handler_{ handler },
 	dir_path_{ archive->filename() },
-	removed_files_{ archive->removedFiles() },
+	removed_files_{ archive->removedFiles().begin(), archive->removedFiles().end() },
 	change_list_{ archive, {} },
 	ignore_hidden_{ archive->hiddenFilesIgnored() }
 {
@@ -98,6 +98,7 @@ DirArchiveCheck::DirArchiveCheck(wxEvtHandler* handler, DirArchive* archive) :
 	archive->putEntryTreeAsList(entries);
 
 	// Build entry info list
+	entry_info_.reserve(entries.size());
 	for (auto& entry : entries)
 	{
 		entry_info_.emplace_back(
@@ -106,6 +107,11 @@ DirArchiveCheck::DirArchiveCheck(wxEvtHandler* handler, DirArchive* archive) :
 			entry->type() == EntryType::folderType(),
 			archive->fileModificationTime(entry));
 	}
+
+	// If the archive directory is being watched, only the paths that have
+	// changed since the last check need to be looked at
+	if (auto watcher = archive->watcher())
+		full_check_ = !watcher->changedPaths(changed_paths_);
 }
 
 // -----------------------------------------------------------------------------
@@ -118,9 +124,9 @@ void DirArchiveCheck::addChange(DirEntryChange change)
 }
 
 // -----------------------------------------------------------------------------
-// DirArchiveCheck thread entry function
+// Checks the entire directory on disk for changes
 // -----------------------------------------------------------------------------
-wxThread::ExitCode DirArchiveCheck::Entry()
+void DirArchiveCheck::fullCheck()
 {
 	// Get current directory structure
 	vector<string>      files, dirs;
@@ -130,78 +136,120 @@ wxThread::ExitCode DirArchiveCheck::Entry()
 
 	// Check for deleted files
 	for (auto& info : entry_info_)
-	{
-		auto path = info.file_path.ToStdString();
-
-		// Ignore if not on disk
-		if (path.empty())
-			continue;
-
-		if (info.is_dir)
-		{
-			if (!wxDirExists(path))
-				addChange(DirEntryChange(DirEntryChange::Action::DeletedDir, path, info.entry_path.ToStdString()));
-		}
-		else
-		{
-			if (!wxFileExists(path))
-				addChange(DirEntryChange(DirEntryChange::Action::DeletedFile, path, info.entry_path.ToStdString()));
-		}
-	}
+		checkDeleted(info);
 
 	// Check for new/updated files
 	for (const auto& file : files)
-	{
-		// Ignore files removed from archive since last save
-		if (VECTOR_EXISTS(removed_files_, file))
-			continue;
+		checkFile(file);
 
-		// Find file in archive
-		EntryInfo inf;
-		bool      found = false;
-		for (auto& info : entry_info_)
-		{
-			if (info.file_path == file)
-			{
-				inf   = info;
-				found = true;
-				break;
-			}
-		}
+	// Check for new dirs
+	for (const auto& subdir : dirs)
+		checkDir(subdir);
+}
 
-		time_t mod = wxFileModificationTime(file);
+// -----------------------------------------------------------------------------
+// Checks only the paths reported as changed by the archive's DirWatcher
+// -----------------------------------------------------------------------------
+void DirArchiveCheck::changedPathsCheck()
+{
+	log::info(2, "{} changed paths to check", changed_paths_.size());
+
+	// Check for deleted files and sort changed paths into files and dirs
+	vector<string> files, dirs;
+	for (const auto& path : changed_paths_)
+	{
+		if (auto i = file_entry_info_.find(path); i != file_entry_info_.end())
+			checkDeleted(*i->second);
 
-		// No match, added to archive
-		if (!found)
-			addChange(DirEntryChange(DirEntryChange::Action::AddedFile, file, "", mod));
-		// Matched, check modification time
-		else if (mod > inf.file_modified)
-			addChange(DirEntryChange(DirEntryChange::Action::Updated, file, inf.entry_path.ToStdString(), mod));
+		if (wxDirExists(path))
+			dirs.push_back(path);
+		else if (wxFileExists(path))
+			files.push_back(path);
 	}
+	std::sort(files.begin(), files.end());
+	std::sort(dirs.begin(), dirs.end());
+
+	// Check for new/updated files
+	for (const auto& file : files)
+		checkFile(file);
 
 	// Check for new dirs
 	for (const auto& subdir : dirs)
+		checkDir(subdir);
+}
+
+// -----------------------------------------------------------------------------
+// Checks if the file or dir for entry [info] has been deleted
+// -----------------------------------------------------------------------------
+void DirArchiveCheck::checkDeleted(const EntryInfo& info)
+{
+	// Ignore if not on disk
+	if (info.file_path.empty())
+		return;
+
+	if (info.is_dir)
 	{
-		// Ignore dirs removed from archive since last save
-		if (VECTOR_EXISTS(removed_files_, subdir))
-			continue;
+		if (!wxDirExists(info.file_path))
+			addChange(DirEntryChange(DirEntryChange::Action::DeletedDir, info.file_path, info.entry_path));
+	}
+	else
+	{
+		if (!wxFileExists(info.file_path))
+			addChange(DirEntryChange(DirEntryChange::Action::DeletedFile, info.file_path, info.entry_path));
+	}
+}
 
-		bool found = false;
-		for (auto& info : entry_info_)
-		{
-			if (info.file_path == subdir)
-			{
-				found = true;
-				break;
-			}
-		}
+// -----------------------------------------------------------------------------
+// Checks if [file] on disk is new or has been updated
+// -----------------------------------------------------------------------------
+void DirArchiveCheck::checkFile(const string& file)
+{
+	// Ignore files removed from archive since last save
+	if (removed_files_.count(file) > 0)
+		return;
 
-		time_t mod = wxDateTime::Now().GetTicks();
+	time_t mod = wxFileModificationTime(file);
 
-		// No match, added to archive
-		if (!found)
-			addChange(DirEntryChange(DirEntryChange::Action::AddedDir, subdir, "", mod));
-	}
+	// Find file in archive
+	auto i = file_entry_info_.find(file);
+
+	// No match, added to archive
+	if (i == file_entry_info_.end())
+		addChange(DirEntryChange(DirEntryChange::Action::AddedFile, file, "", mod));
+	// Matched, check modification time
+	else if (mod > i->second->file_modified)
+		addChange(DirEntryChange(DirEntryChange::Action::Updated, file, i->second->entry_path, mod));
+}
+
+// -----------------------------------------------------------------------------
+// Checks if directory [dir] on disk is new
+// -----------------------------------------------------------------------------
+void DirArchiveCheck::checkDir(const string& dir)
+{
+	// Ignore dirs removed from archive since last save
+	if (removed_files_.count(dir) > 0)
+		return;
+
+	// No match, added to archive
+	if (file_entry_info_.find(dir) == file_entry_info_.end())
+		addChange(DirEntryChange(DirEntryChange::Action::AddedDir, dir, "", wxDateTime::Now().GetTicks()));
+}
+
+// -----------------------------------------------------------------------------
+// DirArchiveCheck thread entry function
+// -----------------------------------------------------------------------------
+wxThread::ExitCode DirArchiveCheck::Entry()
+{
+	// Build file path -> entry lookup
+	file_entry_info_.reserve(entry_info_.size());
+	for (const auto& info : entry_info_)
+		if (!info.file_path.empty())
+			file_entry_info_.emplace(info.file_path, &info);
+
+	if (full_check_)
+		fullCheck();
+	else
+		changedPathsCheck();
 
 	// Send changes via event
 	auto event = new wxThreadEvent(wxEVT_COMMAND_DIRARCHIVECHECK_COMPLETED);
@@ -2262,7 +2310,13 @@ void ArchiveManagerPanel::onDirArchiveCheckCompleted(wxThreadEvent& e)
 			else
 			{
 				DirArchiveUpdateDialog dlg(maineditor::windowWx(), archive, change_list.changes);
-				dlg.ShowModal();
+				if (dlg.ShowModal() != wxID_OK && archive->watcher())
+				{
+					// Dialog was closed without dealing with the changes, make
+					// sure they are checked again next time
+					for (const auto& change : change_list.changes)
+						archive->watcher()->markChanged(change.file_path);
+				}
 			}
 
 			checked_dir_archive_changes_ = false;
@@ -5,6 +5,7 @@
 #include "General/Sigslot.h"
 #include "UI/Controls/DockPanel.h"
 #include "UI/Lists/ListView.h"
+#include <unordered_set>
 
 wxDECLARE_EVENT(wxEVT_COMMAND_DIRARCHIVECHECK_COMPLETED, wxThreadEvent);
 
@@ -34,28 +35,36 @@ public:
 private:
 	struct EntryInfo
 	{
-		wxString entry_path;
-		wxString file_path;
-		bool     is_dir;
-		time_t   file_modified;
+		string entry_path;
+		string file_path;
+		bool   is_dir;
+		time_t file_modified;
 
 		EntryInfo(
-			const wxString& entry_path    = "",
-			const wxString& file_path     = "",
-			bool            is_dir        = false,
-			time_t          file_modified = 0) :
+			string_view entry_path    = "",
+			string_view file_path     = "",
+			bool        is_dir        = false,
+			time_t      file_modified = 0) :
 			entry_path{ entry_path }, file_path{ file_path }, is_dir{ is_dir }, file_modified{ file_modified }
 		{
 		}
 	};
 
-	wxEvtHandler*        handler_;
-	wxString             dir_path_;
-	vector<EntryInfo>    entry_info_;
-	vector<string>       removed_files_;
-	DirArchiveChangeList change_list_;
-	bool                 ignore_hidden_ = true;
-
+	wxEvtHandler*                                handler_;
+	wxString                                     dir_path_;
+	vector<EntryInfo>                            entry_info_;
+	std::unordered_map<string, const EntryInfo*> file_entry_info_; // File path -> EntryInfo
+	std::unordered_set<string>                   removed_files_;
+	vector<string>                               changed_paths_; // Only these are checked if not doing a full check
+	bool                                         full_check_ = true;
+	DirArchiveChangeList                         change_list_;
+	bool                                         ignore_hidden_ = true;
+
+	void fullCheck();
+	void changedPathsCheck();
+	void checkDeleted(const EntryInfo& info);
+	void checkFile(const string& file);
+	void checkDir(const string& dir);
 	void addChange(DirEntryChange change);
 };
 
@@ -53,6 +53,8 @@
 #include "General/Misc.h"
 #include "General/UI.h"
 #include "Graphics/Palette/PaletteManager.h"
+#include "Graphics/PNGOptimizer.h"
+#include "Graphics/SImage/BatchConvert.h"
 #include "MainEditor/ArchiveOperations.h"
 #include "MainEditor/Conversions.h"
 #include "MainEditor/EntryOperations.h"
@@ -1717,7 +1719,7 @@ bool ArchivePanel::crc32() const
 	wxString checksums = "\nCRC-32:\n";
 	for (auto& entry : selection)
 	{
-		uint32_t crc = entry->data().crc();
+		uint32_t crc = entry->contentHash();
 		checksums += wxString::Format("%s:\t%x\n", entry->name(), crc);
 	}
 	log::info(1, checksums);
@@ -2018,31 +2020,27 @@ bool ArchivePanel::gfxConvert() const
 	// Show splash window
 	ui::showSplash("Writing converted image data...", true);
 
-	// Begin recording undo level
-	undo_manager_->beginRecord("Gfx Format Conversion");
-
-	// Write any changes
+	// Write converted images on worker threads
+	vector<gfx::BatchConvertItem> items;
+	items.reserve(selection.size());
 	for (unsigned a = 0; a < selection.size(); a++)
 	{
-		// Update splash window
-		ui::setSplashProgressMessage(selection[a]->name());
-		ui::setSplashProgress((float)a / (float)selection.size());
-
 		// Skip if the image wasn't converted
 		if (!gcd.itemModified(a))
 			continue;
 
-		// Get image and conversion info
-		auto image  = gcd.itemImage(a);
-		auto format = gcd.itemFormat(a);
-
-		// Write converted image back to entry
-		MemChunk mc;
-		format->saveImage(*image, mc, gcd.itemPalette(a));
-		selection[a]->importMemChunk(mc);
-		EntryType::detectEntryType(*selection[a]);
-		selection[a]->setExtensionByType();
+		auto& item = items.emplace_back(selection[a]);
+		item.image.copyImage(gcd.itemImage(a));
+		item.format        = gcd.itemFormat(a);
+		item.write_palette = gcd.itemPalette(a);
 	}
+	gfx::convertImages(items, nullptr, false, true);
+
+	// Begin recording undo level
+	undo_manager_->beginRecord("Gfx Format Conversion");
+
+	// Write any changes back to entries (in order)
+	gfx::writeConvertedImages(items);
 
 	// Finish recording undo level
 	undo_manager_->endRecord(true);
@@ -2282,17 +2280,10 @@ bool ArchivePanel::gfxExportPNG()
 		if (filedialog::saveFiles(
 				info, "Export Entries as PNG (Filename will be ignored)", "PNG Files (*.png)|*.png", this))
 		{
-			// Go through the selection
-			for (auto& entry : selection)
-			{
-				// Setup entry filename
-				wxFileName fn(entry->name());
-				fn.SetPath(info.path);
-				fn.SetExt("png");
-
-				// Do export
-				entryoperations::exportAsPNG(entry, fn.GetFullPath());
-			}
+			// Export the selection (filenames are taken from the entry names)
+			ui::showSplash("Exporting entries as PNG...", true);
+			entryoperations::exportAsPNG(selection, info.path);
+			ui::hideSplash();
 		}
 	}
 
@@ -2713,48 +2704,79 @@ bool ArchivePanel::compileACS(bool hexen) const
 }
 
 // -----------------------------------------------------------------------------
-// Compiles any selected text entries as ACS scripts
+// Optimizes any selected PNG entries, with the built-in optimizer and then any
+// external PNG tools that are set up
 // -----------------------------------------------------------------------------
 bool ArchivePanel::optimizePNG() const
 {
-	// Check if the PNG tools path are set up, at least one of them should be
-	wxString pngpathc = path_pngcrush;
-	wxString pngpatho = path_pngout;
-	wxString pngpathd = path_deflopt;
-	if ((pngpathc.IsEmpty() || !wxFileExists(pngpathc)) && (pngpatho.IsEmpty() || !wxFileExists(pngpatho))
-		&& (pngpathd.IsEmpty() || !wxFileExists(pngpathd)))
-	{
-		wxMessageBox(
-			"Error: PNG tool paths not defined or invalid, please configure in SLADE preferences",
-			"Error",
-			wxOK | wxCENTRE | wxICON_ERROR);
+	// Get selected PNG entries
+	vector<gfx::PNGOptimizeItem> items;
+	for (auto* entry : entry_tree_->selectedEntries())
+		if (entry->type()->formatId() == "img_png")
+			items.emplace_back(entry);
+	if (items.empty())
 		return false;
-	}
-
-	// Get selected entries
-	auto selection = entry_tree_->selectedEntries();
-
-	ui::showSplash("Running external programs, please wait...", true);
 
 	// Begin recording undo level
 	undo_manager_->beginRecord("Optimize PNG");
 
-	// Go through selection
-	for (unsigned a = 0; a < selection.size(); a++)
+	// Optimize with the built-in optimizer first, on worker threads
+	ui::showSplash("Optimizing PNG images, please wait...", false);
+	auto stats = gfx::optimizePNGs(items);
+	for (auto& item : items)
+	{
+		if (item.status == gfx::PNGOptimizeItem::Status::Failed)
+			log::error("Unable to optimize PNG {}: {}", item.entry->name(), item.error);
+		else if (item.status == gfx::PNGOptimizeItem::Status::Optimized)
+			undo_manager_->recordUndoStep(std::make_unique<EntryDataUS>(item.entry));
+	}
+	gfx::writeOptimizedPNGs(items);
+	ui::hideSplash();
+
+	// Then run any external PNG tools that are set up
+	wxString pngpathc = path_pngcrush;
+	wxString pngpatho = path_pngout;
+	wxString pngpathd = path_deflopt;
+	if ((!pngpathc.IsEmpty() && wxFileExists(pngpathc)) || (!pngpatho.IsEmpty() && wxFileExists(pngpatho))
+		|| (!pngpathd.IsEmpty() && wxFileExists(pngpathd)))
 	{
-		ui::setSplashProgressMessage(selection[a]->nameNoExt());
-		ui::setSplashProgress(static_cast<float>(a) / static_cast<float>(selection.size()));
-		if (selection[a]->type()->formatId() == "img_png")
+		ui::showSplash("Running external programs, please wait...", true);
+		for (unsigned a = 0; a < items.size(); a++)
 		{
-			undo_manager_->recordUndoStep(std::make_unique<EntryDataUS>(selection[a]));
-			entryoperations::optimizePNG(selection[a]);
+			auto entry = items[a].entry;
+			if (items[a].status == gfx::PNGOptimizeItem::Status::Failed)
+				continue;
+
+			ui::setSplashProgressMessage(entry->nameNoExt());
+			ui::setSplashProgress(static_cast<float>(a) / static_cast<float>(items.size()));
+			if (items[a].status != gfx::PNGOptimizeItem::Status::Optimized)
+				undo_manager_->recordUndoStep(std::make_unique<EntryDataUS>(entry));
+			entryoperations::optimizePNG(entry, false);
 		}
+		ui::hideSplash();
+
+		// Update stats with the final sizes
+		stats.bytes_out = 0;
+		for (const auto& item : items)
+			if (item.status != gfx::PNGOptimizeItem::Status::Failed)
+				stats.bytes_out += item.entry->size();
 	}
-	ui::hideSplash();
 
 	// Finish recording undo level
 	undo_manager_->endRecord(true);
 
+	// Report bytes saved
+	auto saved   = stats.bytes_in > stats.bytes_out ? stats.bytes_in - stats.bytes_out : 0;
+	auto message = fmt::format(
+		"{} saved ({} -> {})",
+		misc::sizeAsString(saved),
+		misc::sizeAsString(stats.bytes_in),
+		misc::sizeAsString(stats.bytes_out));
+	if (stats.n_failed > 0)
+		message += fmt::format("\n{} images couldn't be optimized, check the console log for info", stats.n_failed);
+	log::info("Optimize PNG: {}", message);
+	wxMessageBox(message, "Optimize PNG", wxOK | wxCENTRE | wxICON_INFORMATION);
+
 	return true;
 }
 
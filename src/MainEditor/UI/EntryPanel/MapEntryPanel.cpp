@@ -160,16 +160,9 @@ bool MapEntryPanel::createImage()
 	if (!entry)
 		return false;
 
+	// Draw map image
 	ArchiveEntry temp;
-
-	// Stupid OpenGL grumble grumble grumble
-	if (gl::fboSupport())
-		map_canvas_->createImage(temp, map_image_width, map_image_height);
-	else
-		map_canvas_->createImage(
-			temp,
-			min<int>(map_image_width, map_canvas_->GetSize().x),
-			min<int>(map_image_height, map_canvas_->GetSize().y));
+	map_canvas_->createImage(temp, map_image_width, map_image_height);
 
 	wxString   name = wxString::Format("%s_%s", entry->parent()->filename(false), entry->name());
 	wxFileName fn(name);
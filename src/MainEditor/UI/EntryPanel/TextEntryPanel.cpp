@@ -148,21 +148,8 @@ bool TextEntryPanel::loadEntry(ArchiveEntry* entry)
 	if (auto pos = entry->exProps().getIf<int>("TextPosition"))
 		text_area_->GotoPos(*pos);
 
-	// --- Attempt to determine text language ---
-	TextLanguage* tl = nullptr;
-
-	// Level markers use FraggleScript
-	if (entry->type() == EntryType::mapMarkerType())
-		tl = TextLanguage::fromId("fragglescript");
-
-	// From entry language hint
-	if (auto lang = entry->exProps().getIf<string>("TextLanguage"))
-		tl = TextLanguage::fromId(*lang);
-
-	// Or, from entry type
-	if (!tl)
-		if (auto lang = entry->type()->extraProps().getIf<string>("text_language"))
-			tl = TextLanguage::fromId(*lang);
+	// Determine text language
+	auto tl = TextLanguage::forEntry(*entry);
 
 	// Load language
 	text_area_->setLanguage(tl);
@@ -33,7 +33,6 @@
 #include "MapBackupManager.h"
 #include "App.h"
 #include "Archive/Formats/ZipArchive.h"
-#include "General/Misc.h"
 #include "MapEditor.h"
 #include "UI/MapBackupPanel.h"
 #include "UI/SDialog.h"
@@ -117,17 +116,8 @@ bool MapBackupManager::writeBackup(
 		{
 			for (unsigned a = 0; a < last_backup->numEntries(); a++)
 			{
-				auto e1 = backup_entries[a];
-				auto e2 = last_backup->entryAt(a);
-				if (e1->size() != e2->size())
-				{
-					same = false;
-					break;
-				}
-
-				uint32_t crc1 = misc::crc(e1->rawData(), e1->size());
-				uint32_t crc2 = misc::crc(e2->rawData(), e2->size());
-				if (crc1 != crc2)
+				// (the backup zip entries' hashes are known from the zip directory)
+				if (!backup_entries[a]->hasSameContent(*last_backup->entryAt(a)))
 				{
 					same = false;
 					break;
@@ -50,6 +50,7 @@
 #include "UI/MapCanvas.h"
 #include "UI/MapEditorWindow.h"
 #include "UndoSteps.h"
+#include "Utility/PolygonTriangulator.h"
 #include "Utility/StringUtils.h"
 
 using namespace slade;
@@ -2550,6 +2551,53 @@ CONSOLE_COMMAND(m_n_polys, 0, false)
 	log::console(fmt::format("{} polygons total", npoly));
 }
 
+CONSOLE_COMMAND(m_test_triangulator, 0, false)
+{
+	// Build polygons for every sector with both the splitter and triangulator,
+	// and compare their coverage against the area enclosed by the sector
+	SLADEMap& map        = mapeditor::editContext().map();
+	long      time_split = 0, time_tri = 0;
+	unsigned  n_split = 0, n_tri = 0, bad_split = 0, bad_tri = 0;
+	sf::Clock clock;
+	for (unsigned a = 0; a < map.nSectors(); a++)
+	{
+		Polygon2D       poly_split, poly_tri;
+		PolygonSplitter splitter;
+		splitter.openSector(map.sector(a));
+		clock.restart();
+		splitter.doSplitting(&poly_split);
+		time_split += clock.getElapsedTime().asMicroseconds();
+
+		PolygonTriangulator triangulator;
+		triangulator.openSector(map.sector(a));
+		clock.restart();
+		triangulator.triangulate(&poly_tri);
+		time_tri += clock.getElapsedTime().asMicroseconds();
+
+		n_split += poly_split.nSubPolys();
+		n_tri += poly_tri.nSubPolys();
+
+		// Allow for float vertex precision
+		auto area       = triangulator.area();
+		auto tolerance  = std::max(1., area * 0.0001);
+		auto area_split = poly_split.area();
+		auto area_tri   = poly_tri.area();
+		if (std::abs(area_split - area) > tolerance)
+			bad_split++;
+		if (std::abs(area_tri - area) > tolerance)
+		{
+			bad_tri++;
+			log::console(fmt::format(
+				"Sector #{}: area {:.1f}, splitter {:.1f}, triangulator {:.1f}", a, area, area_split, area_tri));
+		}
+	}
+
+	log::console(fmt::format(
+		"Splitter: {}ms, {} polygons, {} sectors with mismatched area", time_split / 1000, n_split, bad_split));
+	log::console(fmt::format(
+		"Triangulator: {}ms, {} polygons, {} sectors with mismatched area", time_tri / 1000, n_tri, bad_tri));
+}
+
 CONSOLE_COMMAND(mobj_info, 1, false)
 {
 	int id = strutil::asInt(args[0]);
@@ -38,6 +38,7 @@
 #include "Game/Configuration.h"
 #include "General/Misc.h"
 #include "General/ResourceManager.h"
+#include "General/Trace.h"
 #include "Graphics/CTexture/CTexture.h"
 #include "Graphics/SImage/SImage.h"
 #include "MainEditor/MainEditor.h"
@@ -143,6 +144,7 @@ const MapTextureManager::Texture& MapTextureManager::texture(string_view name, b
 	}
 
 	// Texture not found or unloaded, look for it
+	TRACE_ZONE("MapTextureManager::texture (load)");
 
 	// Look for composite textures first
 	auto  archive = archive_.lock().get();
@@ -253,6 +255,7 @@ const MapTextureManager::Texture& MapTextureManager::flat(string_view name, bool
 	}
 
 	// Prioritize standalone textures
+	TRACE_ZONE("MapTextureManager::flat (load)");
 	auto archive = archive_.lock().get();
 	if (mixed && app::resources().getTextureEntry(name, "textures", archive))
 	{
@@ -377,6 +380,7 @@ const MapTextureManager::Texture& MapTextureManager::sprite(
 	}
 
 	// Sprite not found, look for it
+	TRACE_ZONE("MapTextureManager::sprite (load)");
 	bool   found  = false;
 	bool   mirror = false;
 	SImage image;
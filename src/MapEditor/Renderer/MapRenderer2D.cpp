@@ -35,6 +35,7 @@
 #include "App.h"
 #include "Game/Configuration.h"
 #include "General/ColourConfiguration.h"
+#include "General/Trace.h"
 #include "MapEditor/Edit/ObjectEdit.h"
 #include "MapEditor/MapEditContext.h"
 #include "MapEditor/MapEditor.h"
@@ -3011,6 +3012,8 @@ void MapRenderer2D::renderObjectEditGroup(ObjectEditGroup* group)
 // -----------------------------------------------------------------------------
 void MapRenderer2D::updateVerticesVBO()
 {
+	TRACE_ZONE("MapRenderer2D::updateVerticesVBO");
+
 	// Create VBO if needed
 	if (vbo_vertices_ == 0)
 		glGenBuffers(1, &vbo_vertices_);
@@ -3039,6 +3042,8 @@ void MapRenderer2D::updateVerticesVBO()
 // -----------------------------------------------------------------------------
 void MapRenderer2D::updateLinesVBO(bool show_direction, float base_alpha)
 {
+	TRACE_ZONE("MapRenderer2D::updateLinesVBO");
+
 	log::info(3, "Updating lines VBO");
 
 	// Create VBO if needed
@@ -3111,6 +3116,8 @@ void MapRenderer2D::updateLinesVBO(bool show_direction, float base_alpha)
 // -----------------------------------------------------------------------------
 void MapRenderer2D::updateFlatsVBO()
 {
+	TRACE_ZONE("MapRenderer2D::updateFlatsVBO");
+
 	if (!flats_use_vbo)
 		return;
 
@@ -3153,6 +3160,8 @@ void MapRenderer2D::updateFlatsVBO()
 // -----------------------------------------------------------------------------
 void MapRenderer2D::updateVisibility(Vec2d view_tl, Vec2d view_br)
 {
+	TRACE_ZONE("MapRenderer2D::updateVisibility");
+
 	// Sector visibility
 	if (map_->nSectors() != vis_s_.size())
 	{
@@ -36,6 +36,7 @@
 #include "Game/Configuration.h"
 #include "General/ColourConfiguration.h"
 #include "General/ResourceManager.h"
+#include "General/Trace.h"
 #include "MainEditor/MainEditor.h"
 #include "MainEditor/UI/MainWindow.h"
 #include "MapEditor/MapEditContext.h"
@@ -45,6 +46,7 @@
 #include "UI/Controls/PaletteChooser.h"
 #include "Utility/MathStuff.h"
 #include "Utility/StringUtils.h"
+#include "Utility/ThreadPool.h"
 
 using namespace slade;
 using ExtraFloor = MapSector::ExtraFloor;
@@ -73,6 +75,8 @@ CVAR(Bool, mlook_invert_y, false, CVar::Flag::Save)
 CVAR(Float, camera_3d_sensitivity_x, 1.0f, CVar::Flag::Save)
 CVAR(Float, camera_3d_sensitivity_y, 1.0f, CVar::Flag::Save)
 CVAR(Int, render_fov, 90, CVar::Flag::Save)
+CVAR(Bool, render_3d_portal_vis, true, CVar::Flag::Save)
+CVAR(Bool, render_3d_portal_debug, false, 0)
 
 
 // -----------------------------------------------------------------------------
@@ -514,11 +518,12 @@ void MapRenderer3D::cameraLook(double xrel, double yrel)
 // -----------------------------------------------------------------------------
 // Sets up the OpenGL view/projection for rendering
 // -----------------------------------------------------------------------------
-void MapRenderer3D::setupView(int width, int height) const
+void MapRenderer3D::setupView(int width, int height)
 {
 	// Calculate aspect ratio
 	float aspect = (1.6f / 1.333333f) * ((float)width / (float)height);
 	float fovy   = 2 * math::radToDeg(atan(tan(math::degToRad(render_fov) / 2) / aspect));
+	cam_fov_v_   = math::degToRad(fovy);
 
 	// Setup projection
 	glMatrixMode(GL_PROJECTION);
@@ -610,6 +615,8 @@ void MapRenderer3D::setFog(const ColRGBA& fogcol, uint8_t light)
 // -----------------------------------------------------------------------------
 void MapRenderer3D::renderMap()
 {
+	TRACE_ZONE("MapRenderer3D::renderMap");
+
 	// Setup GL stuff
 	glEnable(GL_DEPTH_TEST);
 	glCullFace(GL_BACK);
@@ -694,6 +701,10 @@ void MapRenderer3D::renderMap()
 	// Render transparent stuff
 	renderTransparentWalls();
 
+	// Render portal visibility debug overlay
+	if (render_3d_portal_debug)
+		renderPortalDebug();
+
 	// Check elapsed time
 	if (render_max_dist_adaptive)
 	{
@@ -909,6 +920,73 @@ void MapRenderer3D::renderSky()
 	glEnable(GL_TEXTURE_2D);
 }
 
+// -----------------------------------------------------------------------------
+// Updates cached rendering data for the lines and sectors in [changes].
+// Anything that needs the texture manager or map specials is done first on
+// this thread, then line quads and flat vertex data are generated on worker
+// threads into staging buffers. Only swapping in the quads and uploading the
+// flats to the VBO is done back on this thread
+// -----------------------------------------------------------------------------
+void MapRenderer3D::updateGeometry(const GeometryChanges& changes)
+{
+	TRACE_ZONE("MapRenderer3D::updateGeometry");
+
+	if (changes.empty())
+		return;
+
+	// Process line specials first, since they can add 3d floors to the sectors
+	// of other lines being updated
+	for (auto index : changes.lines)
+		if (auto line = map_->line(index); line && line->s1())
+			map_->mapSpecials()->processLineSpecial(line);
+
+	// Prepare lines and sector flat structures
+	bool mixed = game::configuration().featureSupported(game::Feature::MixTexFlats);
+	wall_textures_.clear();
+	for (auto index : changes.lines)
+		prepareLine(index, mixed);
+	for (auto index : changes.sectors)
+		updateSectorFlats(index);
+
+	// Build line quads and flat vertex data
+	auto                    n_lines = changes.lines.size();
+	vector<vector<Quad>>    quads(n_lines);
+	vector<vector<uint8_t>> flat_data(gl::vboSupport() ? changes.sectors.size() : 0);
+	threadpool::parallelFor(
+		n_lines + flat_data.size(),
+		[&](size_t i)
+		{
+			if (i < n_lines)
+			{
+				buildLineQuads(changes.lines[i], quads[i]);
+				return;
+			}
+
+			auto index = changes.sectors[i - n_lines];
+			if (index >= map_->nSectors())
+				return;
+			auto& data = flat_data[i - n_lines];
+			data.resize(map_->sector(index)->polygon()->vboDataSize() * sector_flats_[index].size());
+			writeSectorFlats(index, data.data(), 0);
+		},
+		8);
+
+	// Apply
+	auto time = app::runTimer();
+	for (unsigned a = 0; a < n_lines; a++)
+	{
+		auto index = changes.lines[a];
+		if (index >= lines_.size())
+			continue;
+
+		lines_[index].quads.swap(quads[a]);
+		lines_[index].line         = map_->line(index);
+		lines_[index].updated_time = time;
+	}
+	for (unsigned a = 0; a < flat_data.size(); a++)
+		updateSectorVBOs(changes.sectors[a], flat_data[a]);
+}
+
 // -----------------------------------------------------------------------------
 // Updates the vertex texture coordinates of all polygons for sector [index]
 // -----------------------------------------------------------------------------
@@ -982,8 +1060,7 @@ void MapRenderer3D::updateFlatTexCoords(unsigned index, unsigned flat_index) con
 // -----------------------------------------------------------------------------
 void MapRenderer3D::updateSector(unsigned index)
 {
-	updateSectorFlats(index);
-	updateSectorVBOs(index);
+	updateGeometry({ {}, { index } });
 }
 
 // -----------------------------------------------------------------------------
@@ -1110,32 +1187,50 @@ void MapRenderer3D::updateSectorFlats(unsigned index)
 }
 
 // -----------------------------------------------------------------------------
-// Updates VBOs for sector [index]
+// Writes vertex data for all flats of sector [index] to [buffer] at [offset],
+// in the same layout as the flats VBO. Returns the offset to the end of the
+// data.
+// Only touches the sector's polygon, so this can be run for different sectors
+// on worker threads once the sector's flat structures are up to date
+// -----------------------------------------------------------------------------
+unsigned MapRenderer3D::writeSectorFlats(unsigned index, uint8_t* buffer, unsigned offset) const
+{
+	auto poly = map_->sector(index)->polygon();
+
+	for (unsigned a = 0; a < sector_flats_[index].size(); a++)
+	{
+		updateFlatTexCoords(index, a);
+		poly->setZ(sector_flats_[index][a].plane);
+		offset = poly->writeToBuffer(buffer, offset);
+	}
+
+	poly->setZ(0);
+
+	return offset;
+}
+
+// -----------------------------------------------------------------------------
+// Uploads flat vertex [data] for sector [index] (from writeSectorFlats) to the
+// flats VBO
 // -----------------------------------------------------------------------------
-void MapRenderer3D::updateSectorVBOs(unsigned index) const
+void MapRenderer3D::updateSectorVBOs(unsigned index, const vector<uint8_t>& data) const
 {
 	if (!gl::vboSupport())
 		return;
 
 	// Check index
-	if (index >= map_->nSectors())
+	if (index >= map_->nSectors() || sector_flats_[index].empty())
 		return;
-	MapSector* sector = map_->sector(index);
-	Polygon2D* poly   = sector->polygon();
 
 	// Update VBOs
 	glBindBuffer(GL_ARRAY_BUFFER, vbo_flats_);
 	Polygon2D::setupVBOPointers();
 
+	auto flat_size = data.size() / sector_flats_[index].size();
 	for (unsigned a = 0; a < sector_flats_[index].size(); a++)
-	{
-		updateFlatTexCoords(index, a);
-		poly->setZ(sector_flats_[index][a].plane);
-		poly->writeToVBO(sector_flats_[index][a].vbo_offset);
-	}
+		glBufferSubData(GL_ARRAY_BUFFER, sector_flats_[index][a].vbo_offset, flat_size, data.data() + a * flat_size);
 
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	poly->setZ(0);
 }
 
 // -----------------------------------------------------------------------------
@@ -1485,23 +1580,28 @@ void MapRenderer3D::setupQuadTexCoords(
 // -----------------------------------------------------------------------------
 void MapRenderer3D::updateLine(unsigned index)
 {
-	using game::Feature;
+	updateGeometry({ { index }, {} });
+}
+
+// -----------------------------------------------------------------------------
+// Builds the quads for line [index] into [quads].
+// This doesn't modify anything, so it can be run for different lines on worker
+// threads after the line has been prepared with prepareLine
+// -----------------------------------------------------------------------------
+void MapRenderer3D::buildLineQuads(unsigned index, vector<Quad>& quads) const
+{
 	using game::UDMFFeature;
 
 	// Check index
-	if (index > lines_.size())
+	if (index >= lines_.size())
 		return;
 
-	// Clear current line data
-	lines_[index].quads.clear();
-
 	// Skip invalid line
 	auto line = map_->line(index);
 	if (!line->s1())
 		return;
 
-	// Process line special
-	map_->mapSpecials()->processLineSpecial(line);
+	// Get line special info
 	bool line_translucent = map_->mapSpecials()->lineIsTranslucent(line);
 
 	// Get relevant line info
@@ -1509,9 +1609,7 @@ void MapRenderer3D::updateLine(unsigned index)
 	bool   upeg       = game::configuration().lineBasicFlagSet("dontpegtop", line, map_format);
 	bool   lpeg       = game::configuration().lineBasicFlagSet("dontpegbottom", line, map_format);
 	double xoff, yoff, sx, sy, lsx, lsy;
-	bool   mixed       = game::configuration().featureSupported(Feature::MixTexFlats);
-	lines_[index].line = line;
-	double alpha       = 1.0;
+	double alpha = 1.0;
 	if (line->hasProp("alpha"))
 		alpha = line->floatProperty("alpha");
 	else if (line_translucent) // TranslucentLine special
@@ -1568,7 +1666,7 @@ void MapRenderer3D::updateLine(unsigned index)
 		}
 
 		// Texture scale
-		auto& tex    = mapeditor::textureManager().texture(line->s1()->texMiddle(), mixed);
+		auto& tex    = wallTexture(line->s1()->texMiddle());
 		quad.texture = tex.gl_id;
 		sx           = tex.scale.x;
 		sy           = tex.scale.y;
@@ -1597,8 +1695,7 @@ void MapRenderer3D::updateLine(unsigned index)
 		setupQuadTexCoords(&quad, length, xoff, yoff, ceiling1, floor1, lpeg, sx, sy);
 
 		// Add middle quad and finish
-		lines_[index].quads.push_back(quad);
-		lines_[index].updated_time = app::runTimer();
+		quads.push_back(quad);
 		return;
 	}
 
@@ -1660,7 +1757,7 @@ void MapRenderer3D::updateLine(unsigned index)
 		}
 
 		// Texture scale
-		auto& tex    = mapeditor::textureManager().texture(line->s1()->texLower(), mixed);
+		auto& tex    = wallTexture(line->s1()->texLower());
 		quad.texture = tex.gl_id;
 		sx           = tex.scale.x;
 		sy           = tex.scale.y;
@@ -1694,7 +1791,7 @@ void MapRenderer3D::updateLine(unsigned index)
 		quad.flags |= LOWER;
 
 		// Add quad
-		lines_[index].quads.push_back(quad);
+		quads.push_back(quad);
 	}
 
 	// Front middle
@@ -1706,7 +1803,7 @@ void MapRenderer3D::updateLine(unsigned index)
 		Quad quad;
 
 		// Get texture
-		auto& tex    = mapeditor::textureManager().texture(line->s1()->texMiddle(), mixed);
+		auto& tex    = wallTexture(line->s1()->texMiddle());
 		quad.texture = tex.gl_id;
 
 		// Determine offsets
@@ -1793,7 +1890,7 @@ void MapRenderer3D::updateLine(unsigned index)
 			quad.flags |= TRANSADD;
 
 		// Add quad
-		lines_[index].quads.push_back(quad);
+		quads.push_back(quad);
 	}
 
 	// Front upper
@@ -1817,7 +1914,7 @@ void MapRenderer3D::updateLine(unsigned index)
 		}
 
 		// Texture scale
-		auto& tex    = mapeditor::textureManager().texture(line->s1()->texUpper(), mixed);
+		auto& tex    = wallTexture(line->s1()->texUpper());
 		quad.texture = tex.gl_id;
 		sx           = tex.scale.x;
 		sy           = tex.scale.y;
@@ -1852,7 +1949,7 @@ void MapRenderer3D::updateLine(unsigned index)
 		quad.flags |= UPPER;
 
 		// Add quad
-		lines_[index].quads.push_back(quad);
+		quads.push_back(quad);
 	}
 
 	// Back lower
@@ -1876,7 +1973,7 @@ void MapRenderer3D::updateLine(unsigned index)
 		}
 
 		// Texture scale
-		auto& tex    = mapeditor::textureManager().texture(line->s2()->texLower(), mixed);
+		auto& tex    = wallTexture(line->s2()->texLower());
 		quad.texture = tex.gl_id;
 		sx           = tex.scale.x;
 		sy           = tex.scale.y;
@@ -1913,7 +2010,7 @@ void MapRenderer3D::updateLine(unsigned index)
 		quad.flags |= LOWER;
 
 		// Add quad
-		lines_[index].quads.push_back(quad);
+		quads.push_back(quad);
 	}
 
 	// Back middle
@@ -1925,7 +2022,7 @@ void MapRenderer3D::updateLine(unsigned index)
 		Quad quad;
 
 		// Get texture
-		auto& tex    = mapeditor::textureManager().texture(midtex2, mixed);
+		auto& tex    = wallTexture(midtex2);
 		quad.texture = tex.gl_id;
 
 		// Determine offsets
@@ -2012,7 +2109,7 @@ void MapRenderer3D::updateLine(unsigned index)
 			quad.flags |= TRANSADD;
 
 		// Add quad
-		lines_[index].quads.push_back(quad);
+		quads.push_back(quad);
 	}
 
 	// Back upper
@@ -2036,7 +2133,7 @@ void MapRenderer3D::updateLine(unsigned index)
 		}
 
 		// Texture scale
-		auto& tex    = mapeditor::textureManager().texture(line->s2()->texUpper(), mixed);
+		auto& tex    = wallTexture(line->s2()->texUpper());
 		quad.texture = tex.gl_id;
 		sx           = tex.scale.x;
 		sy           = tex.scale.y;
@@ -2070,7 +2167,7 @@ void MapRenderer3D::updateLine(unsigned index)
 		quad.flags |= UPPER;
 
 		// Add quad
-		lines_[index].quads.push_back(quad);
+		quads.push_back(quad);
 	}
 
 	// Add any middle lines created by 3D floors
@@ -2138,7 +2235,7 @@ void MapRenderer3D::updateLine(unsigned index)
 			quad.colour    = colour1.ampf(1.0f, 1.0f, 1.0f, extra.alpha);
 			quad.fogcolour = fogcolour1;
 			quad.light     = light1;
-			quad.texture   = mapeditor::textureManager().texture(texname, mixed).gl_id;
+			quad.texture   = wallTexture(texname).gl_id;
 
 			setupQuadTexCoords(
 				&quad,
@@ -2167,12 +2264,91 @@ void MapRenderer3D::updateLine(unsigned index)
 			// sector on either side of the line
 			// TODO TRANSADD if that one flag is set!
 
-			lines_[index].quads.push_back(quad);
+			quads.push_back(quad);
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns whether the line at [index] needs to be updated
+// -----------------------------------------------------------------------------
+bool MapRenderer3D::isLineStale(unsigned index) const
+{
+	auto  line   = map_->line(index);
+	auto& cached = lines_[index];
+
+	// Check line modified
+	if (cached.updated_time < line->modifiedTime() || cached.line != line)
+		return true;
+
+	// Check sides/sectors (and any 3d floor control lines) modified
+	for (auto side : { line->s1(), line->s2() })
+	{
+		if (!side)
+			continue;
+
+		if (cached.updated_time < side->modifiedTime() || cached.updated_time < side->sector()->modifiedTime()
+			|| cached.updated_time < side->sector()->geometryUpdatedTime())
+			return true;
+
+		for (const auto& extra_floor : side->sector()->extraFloors())
+		{
+			auto control_line = map_->line(extra_floor.control_line_index);
+			if (cached.updated_time < control_line->s1()->modifiedTime()
+				|| cached.updated_time < control_line->frontSector()->modifiedTime()
+				|| cached.updated_time < control_line->frontSector()->geometryUpdatedTime())
+				return true;
 		}
 	}
 
-	// Finished
-	lines_[index].updated_time = app::runTimer();
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// Does anything needed before building quads for line [index] that can't be
+// done on a worker thread: looks up all wall textures it may use.
+// The specials of all lines being updated must have been processed first, so
+// that the textures of any 3d floors they add are included
+// -----------------------------------------------------------------------------
+void MapRenderer3D::prepareLine(unsigned index, bool mixed)
+{
+	auto line = map_->line(index);
+	if (!line || !line->s1())
+		return;
+
+	// Get textures
+	auto add_texture = [this, mixed](const string& name)
+	{
+		if (wall_textures_.find(name) != wall_textures_.end())
+			return;
+
+		auto& tex            = mapeditor::textureManager().texture(name, mixed);
+		wall_textures_[name] = { tex.gl_id, tex.scale, tex.world_panning };
+	};
+	for (auto side : { line->s1(), line->s2() })
+	{
+		if (!side)
+			continue;
+
+		add_texture(side->texUpper());
+		add_texture(side->texMiddle());
+		add_texture(side->texLower());
+
+		// 3d floor sides
+		for (const auto& extra : side->sector()->extraFloors())
+			add_texture(map_->line(extra.control_line_index)->s1()->texMiddle());
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns the wall texture [name] looked up by prepareLine
+// -----------------------------------------------------------------------------
+const MapRenderer3D::WallTexture& MapRenderer3D::wallTexture(const string& name) const
+{
+	static WallTexture tex_none;
+
+	auto i = wall_textures_.find(name);
+	return i != wall_textures_.end() ? i->second : tex_none;
 }
 
 // -----------------------------------------------------------------------------
@@ -2422,6 +2598,8 @@ void MapRenderer3D::renderWallSelection(const ItemSelection& selection, float al
 // -----------------------------------------------------------------------------
 void MapRenderer3D::updateThing(unsigned index, const MapThing* thing)
 {
+	TRACE_ZONE("MapRenderer3D::updateThing");
+
 	// Check index
 	if (index >= things_.size() || !thing)
 		return;
@@ -2833,6 +3011,8 @@ void MapRenderer3D::renderThingSelection(const ItemSelection& selection, float a
 // -----------------------------------------------------------------------------
 void MapRenderer3D::updateFlatsVBO()
 {
+	TRACE_ZONE("MapRenderer3D::updateFlatsVBO");
+
 	if (!flats_use_vbo)
 		return;
 
@@ -2840,45 +3020,37 @@ void MapRenderer3D::updateFlatsVBO()
 	if (vbo_flats_ == 0)
 		glGenBuffers(1, &vbo_flats_);
 
-	// Get total size needed
+	// Create the sector flats structures and get the total size needed
 	unsigned totalsize = 0;
 	for (unsigned a = 0; a < map_->nSectors(); a++)
 	{
-		// Create the sector flats structure, but don't try to update VBOs yet
-		// (since this function is recreating them)
 		if (isSectorStale(a))
 			updateSectorFlats(a);
 
-		MapSector* sector = map_->sector(a);
-		Polygon2D* poly   = sector->polygon();
-		totalsize += poly->vboDataSize() * sector_flats_[a].size();
+		auto flat_size = map_->sector(a)->polygon()->vboDataSize();
+		for (auto& flat : sector_flats_[a])
+		{
+			flat.vbo_offset = totalsize;
+			totalsize += flat_size;
+		}
 	}
 
-	// Allocate buffer data
-	glBindBuffer(GL_ARRAY_BUFFER, vbo_flats_);
-	Polygon2D::setupVBOPointers();
-	glBufferData(GL_ARRAY_BUFFER, totalsize, nullptr, GL_STATIC_DRAW);
-
-	// Write polygon data to VBO
-	unsigned offset = 0;
-	for (unsigned a = 0; a < sector_flats_.size(); a++)
-	{
-		MapSector* sector = sector_flats_[a][0].sector;
-		Polygon2D* poly   = sector->polygon();
-
-		// TODO i realize we'll have to do this if any 3d floors are /added/, too
-		for (unsigned b = 0; b < sector_flats_[a].size(); b++)
+	// Write polygon data for all flats to a staging buffer (in parallel, since
+	// each sector only touches its own polygon)
+	vector<uint8_t> data(totalsize);
+	threadpool::parallelFor(
+		sector_flats_.size(),
+		[&](size_t a)
 		{
-			// Write flat to VBO
-			sector_flats_[a][b].vbo_offset = offset;
-			updateFlatTexCoords(a, b);
-			poly->setZ(sector_flats_[a][b].plane);
-			offset = poly->writeToVBO(offset);
-		}
+			if (!sector_flats_[a].empty())
+				writeSectorFlats(a, data.data(), sector_flats_[a][0].vbo_offset);
+		},
+		64);
 
-		// Reset polygon z
-		poly->setZ(0.0f);
-	}
+	// Upload buffer data
+	glBindBuffer(GL_ARRAY_BUFFER, vbo_flats_);
+	Polygon2D::setupVBOPointers();
+	glBufferData(GL_ARRAY_BUFFER, totalsize, data.data(), GL_STATIC_DRAW);
 
 	// Clean up
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -2896,12 +3068,27 @@ void MapRenderer3D::updateWallsVBO() const {}
 // -----------------------------------------------------------------------------
 void MapRenderer3D::quickVisDiscard()
 {
+	TRACE_ZONE("MapRenderer3D::quickVisDiscard");
+
 	// Create sector distance array if needed
 	if (dist_sectors_.size() != map_->nSectors())
 		dist_sectors_.resize(map_->nSectors());
 
+	// Determine potentially visible sectors by looking through portals
+	auto cam = cam_position_.get2d();
+	if (render_3d_portal_vis)
+	{
+		PortalVisibility::View view;
+		view.position   = cam;
+		view.direction  = cam_direction_;
+		view.half_angle = PortalVisibility::viewHalfAngle(math::degToRad(render_fov), cam_fov_v_, cam_pitch_) + 0.05;
+		view.max_dist   = render_max_dist > 0 ? static_cast<double>(render_max_dist) : 0.;
+		portal_vis_.compute(*map_, view);
+	}
+	else
+		portal_vis_.clear();
+
 	// Go through all sectors
-	auto   cam = cam_position_.get2d();
 	double min_dist, dist;
 	Seg2d  strafe(cam, cam + cam_strafe_.get2d());
 	for (unsigned a = 0; a < map_->nSectors(); a++)
@@ -2912,6 +3099,14 @@ void MapRenderer3D::quickVisDiscard()
 		// Init to visible
 		dist_sectors_[a] = 0.0f;
 
+		// Check if potentially visible (if the camera is outside the map, fall
+		// back to the checks below)
+		if (portal_vis_.isValid() && !portal_vis_.sectorVisible(a))
+		{
+			dist_sectors_[a] = -1.0f;
+			continue;
+		}
+
 		// Check if within bbox
 		if (bbox.contains(cam))
 			continue;
@@ -2949,14 +3144,56 @@ void MapRenderer3D::quickVisDiscard()
 		}
 	}
 
-	// Set all lines that are part of invisible sectors to invisible
+	// Set all lines that are only part of invisible sectors to invisible
+	for (auto& line : lines_)
+		line.visible = false;
 	for (unsigned a = 0; a < map_->nSides(); a++)
 	{
 		dist = dist_sectors_[map_->side(a)->sector()->index()];
 
-		lines_[map_->side(a)->parentLine()->index()].visible = !(
-			dist < 0 || (render_max_dist > 0 && dist > render_max_dist));
+		if (!(dist < 0 || (render_max_dist > 0 && dist > render_max_dist)))
+			lines_[map_->side(a)->parentLine()->index()].visible = true;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Renders outlines of the openings of all portals looked through by the
+// portal visibility check (for debugging)
+// -----------------------------------------------------------------------------
+void MapRenderer3D::renderPortalDebug() const
+{
+	glDisable(GL_TEXTURE_2D);
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_FOG);
+	glLineWidth(2.0f);
+	gl::setColour(255, 160, 0, 255, gl::Blend::Normal);
+
+	for (auto index : portal_vis_.portals())
+	{
+		auto line = map_->line(index);
+		if (!line || !line->frontSector() || !line->backSector())
+			continue;
+
+		auto   fs = line->frontSector();
+		auto   bs = line->backSector();
+		auto   p1 = line->start();
+		auto   p2 = line->end();
+		double b1 = std::max(fs->floor().plane.heightAt(p1), bs->floor().plane.heightAt(p1));
+		double b2 = std::max(fs->floor().plane.heightAt(p2), bs->floor().plane.heightAt(p2));
+		double t1 = std::min(fs->ceiling().plane.heightAt(p1), bs->ceiling().plane.heightAt(p1));
+		double t2 = std::min(fs->ceiling().plane.heightAt(p2), bs->ceiling().plane.heightAt(p2));
+
+		glBegin(GL_LINE_LOOP);
+		glVertex3d(p1.x, p1.y, b1);
+		glVertex3d(p2.x, p2.y, b2);
+		glVertex3d(p2.x, p2.y, t2);
+		glVertex3d(p1.x, p1.y, t1);
+		glEnd();
 	}
+
+	glEnable(GL_DEPTH_TEST);
+	if (fog_)
+		glEnable(GL_FOG);
 }
 
 // -----------------------------------------------------------------------------
@@ -2979,22 +3216,21 @@ float MapRenderer3D::calcDistFade(double distance, double max) const
 // -----------------------------------------------------------------------------
 void MapRenderer3D::checkVisibleQuads()
 {
+	TRACE_ZONE("MapRenderer3D::checkVisibleQuads");
+
 	// Create quads array if empty
 	// if (!quads_)
 	//	quads_ = new Quad*[map_->nLines() * 4];
 	if (quads_.empty())
 		quads_.resize(map_->nLines() * 4);
 
-	// Go through lines
-	MapLine* line;
-	float    distfade;
-	n_quads_         = 0;
-	unsigned updates = 0;
-	bool     update  = false;
-	Seg2d    strafe(cam_position_.get2d(), (cam_position_ + cam_strafe_).get2d());
+	// Get visible lines, and any of those that need updating
+	vector<unsigned> visible;
+	GeometryChanges  changes;
+	Seg2d            strafe(cam_position_.get2d(), (cam_position_ + cam_strafe_).get2d());
 	for (unsigned a = 0; a < lines_.size(); a++)
 	{
-		line = map_->line(a);
+		auto line = map_->line(a);
 
 		// Skip if not visible
 		if (!lines_[a].visible)
@@ -3007,62 +3243,27 @@ void MapRenderer3D::checkVisibleQuads()
 				continue;
 		}
 
+		visible.push_back(a);
+		if (isLineStale(a))
+			changes.lines.push_back(a);
+	}
+
+	// Update lines
+	updateGeometry(changes);
+
+	// Go through visible lines
+	float distfade;
+	n_quads_ = 0;
+	for (auto a : visible)
+	{
+		auto line = map_->line(a);
+
 		// Check for distance fade
 		if (render_max_dist > 0)
 			distfade = calcDistFade(math::distanceToLine(cam_position_.get2d(), line->seg()), render_max_dist);
 		else
 			distfade = 1.0f;
 
-		// Update line if needed
-		update = false;
-		if (lines_[a].updated_time < line->modifiedTime()) // Check line modified
-			update = true;
-		if (lines_[a].line != line)
-			update = true;
-		if (!update && line->s1())
-		{
-			// Check front side/sector modified
-			if (lines_[a].updated_time < line->s1()->modifiedTime()
-				|| lines_[a].updated_time < line->frontSector()->modifiedTime()
-				|| lines_[a].updated_time < line->frontSector()->geometryUpdatedTime())
-				update = true;
-
-			MapSector* sector = line->frontSector();
-			for (const auto& extra_floor : sector->extraFloors())
-			{
-				MapLine* control_line = map_->line(extra_floor.control_line_index);
-				if (lines_[a].updated_time < control_line->s1()->modifiedTime()
-					|| lines_[a].updated_time < control_line->frontSector()->modifiedTime()
-					|| lines_[a].updated_time < control_line->frontSector()->geometryUpdatedTime())
-					update = true;
-			}
-		}
-		if (!update && line->s2())
-		{
-			// Check back side/sector modified
-			if (lines_[a].updated_time < line->s2()->modifiedTime()
-				|| lines_[a].updated_time < line->backSector()->modifiedTime()
-				|| lines_[a].updated_time < line->backSector()->geometryUpdatedTime())
-				update = true;
-
-			MapSector* sector = line->backSector();
-			for (const auto& extra_floor : sector->extraFloors())
-			{
-				MapLine* control_line = map_->line(extra_floor.control_line_index);
-				if (lines_[a].updated_time < control_line->s1()->modifiedTime()
-					|| lines_[a].updated_time < control_line->frontSector()->modifiedTime()
-					|| lines_[a].updated_time < control_line->frontSector()->geometryUpdatedTime())
-					update = true;
-			}
-		}
-		if (update)
-		{
-			updateLine(a);
-			// updates++;
-			// if (updates > 500)
-			//	break;
-		}
-
 		// Determine quads to be drawn
 		for (auto& quad : lines_[a].quads)
 		{
@@ -3086,7 +3287,10 @@ void MapRenderer3D::checkVisibleQuads()
 // -----------------------------------------------------------------------------
 void MapRenderer3D::checkVisibleFlats()
 {
+	TRACE_ZONE("MapRenderer3D::checkVisibleFlats");
+
 	// Update flats array
+	GeometryChanges changes;
 	flats_.clear();
 	n_flats_ = 0;
 	for (unsigned a = 0; a < sector_flats_.size(); a++)
@@ -3097,10 +3301,12 @@ void MapRenderer3D::checkVisibleFlats()
 
 		// Update sector info if needed
 		if (isSectorStale(a))
-			updateSector(a);
-
-		n_flats_ += sector_flats_[a].size();
+			changes.sectors.push_back(a);
 	}
+	updateGeometry(changes);
+	for (unsigned a = 0; a < sector_flats_.size(); a++)
+		if (dist_sectors_[a] >= 0)
+			n_flats_ += sector_flats_[a].size();
 	flats_.resize(n_flats_);
 
 	// Go through sectors
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "MapEditor/Edit/Edit3D.h"
+#include "SLADEMap/PortalVisibility.h"
 #include "SLADEMap/SLADEMap.h"
 
 namespace slade
@@ -94,6 +95,13 @@ public:
 		long       updated_time      = 0;
 		unsigned   vbo_offset        = 0;
 	};
+	struct GeometryChanges
+	{
+		vector<unsigned> lines;
+		vector<unsigned> sectors;
+
+		bool empty() const { return lines.empty() && sectors.empty(); }
+	};
 
 	MapRenderer3D(SLADEMap* map = nullptr);
 	~MapRenderer3D();
@@ -133,7 +141,7 @@ public:
 	Vec2d  camDirection() const { return cam_direction_; }
 
 	// -- Rendering --
-	void setupView(int width, int height) const;
+	void setupView(int width, int height);
 	void setLight(const ColRGBA& colour, uint8_t light, float alpha = 1.0f) const;
 	void setFog(const ColRGBA& fogcol, uint8_t light);
 	void renderMap();
@@ -147,12 +155,16 @@ public:
 		float ty = 2.0f) const;
 	void renderSky();
 
+	// Geometry
+	void updateGeometry(const GeometryChanges& changes);
+
 	// Flats
-	void updateFlatTexCoords(unsigned index, unsigned flat_index) const;
-	void updateSector(unsigned index);
-	void updateSectorFlats(unsigned index);
-	void updateSectorVBOs(unsigned index) const;
-	bool isSectorStale(unsigned index) const;
+	void     updateFlatTexCoords(unsigned index, unsigned flat_index) const;
+	void     updateSector(unsigned index);
+	void     updateSectorFlats(unsigned index);
+	unsigned writeSectorFlats(unsigned index, uint8_t* buffer, unsigned offset) const;
+	void     updateSectorVBOs(unsigned index, const vector<uint8_t>& data) const;
+	bool     isSectorStale(unsigned index) const;
 	void renderFlat(const Flat* flat);
 	void renderFlats();
 	void renderFlatSelection(const ItemSelection& selection, float alpha = 1.0f) const;
@@ -171,6 +183,8 @@ public:
 		double sx        = 1,
 		double sy        = 1) const;
 	void updateLine(unsigned index);
+	void buildLineQuads(unsigned index, vector<Quad>& quads) const;
+	bool isLineStale(unsigned index) const;
 	void renderQuad(const Quad* quad, float alpha = 1.0f);
 	void renderWalls();
 	void renderTransparentWalls();
@@ -186,10 +200,12 @@ public:
 	void updateWallsVBO() const;
 
 	// Visibility checking
-	void  quickVisDiscard();
-	float calcDistFade(double distance, double max = -1) const;
-	void  checkVisibleQuads();
-	void  checkVisibleFlats();
+	const PortalVisibility& portalVisibility() const { return portal_vis_; }
+	void                    quickVisDiscard();
+	float                   calcDistFade(double distance, double max = -1) const;
+	void                    checkVisibleQuads();
+	void                    checkVisibleFlats();
+	void                    renderPortalDebug() const;
 
 	// Hilight
 	mapeditor::Item determineHilight();
@@ -208,7 +224,8 @@ private:
 	float     fog_depth_last_ = 0.f;
 
 	// Visibility
-	vector<float> dist_sectors_;
+	vector<float>    dist_sectors_;
+	PortalVisibility portal_vis_;
 
 	// Camera
 	Vec3d  cam_position_;
@@ -217,6 +234,7 @@ private:
 	double cam_angle_ = 0.;
 	Vec3d  cam_dir3d_;
 	Vec3d  cam_strafe_;
+	double cam_fov_v_ = 0.;
 	double gravity_   = 0.5;
 	int    item_dist_ = 0;
 
@@ -232,6 +250,20 @@ private:
 	unsigned vbo_flats_ = 0;
 	unsigned vbo_walls_ = 0;
 
+	// Wall textures used by lines being updated. These are looked up before
+	// building quads since the texture manager can't be used off the main
+	// thread
+	struct WallTexture
+	{
+		unsigned gl_id = 0;
+		Vec2d    scale{ 1., 1. };
+		bool     world_panning = false;
+	};
+	std::map<string, WallTexture> wall_textures_;
+
+	void               prepareLine(unsigned index, bool mixed);
+	const WallTexture& wallTexture(const string& name) const;
+
 	// Sky
 	struct GLVertexEx
 	{
@@ -79,6 +79,7 @@ CVAR(Int, flat_drawtype, 2, CVar::Flag::Save)
 // -----------------------------------------------------------------------------
 EXTERN_CVAR(Bool, vertex_round)
 EXTERN_CVAR(Int, vertex_size)
+EXTERN_CVAR(Bool, render_3d_portal_debug)
 
 
 // -----------------------------------------------------------------------------
@@ -1322,6 +1323,22 @@ void Renderer::draw()
 				ColRGBA(255, 255, 255, 200),
 				drawing::Font::Small);
 		}
+
+		// Draw portal visibility info (if debugging)
+		if (render_3d_portal_debug)
+		{
+			auto&  vis  = renderer_3d_.portalVisibility();
+			string info = "Portal visibility: view is outside the map";
+			if (vis.isValid())
+				info = fmt::format(
+					"Portal visibility: {}/{} sectors, {} portals",
+					vis.nVisibleSectors(),
+					context_.map().nSectors(),
+					vis.portals().size());
+
+			glEnable(GL_TEXTURE_2D);
+			drawing::drawText(info, 2, view_.size().y - 20, ColRGBA(255, 160, 0, 255), drawing::Font::Bold);
+		}
 	}
 
 	// FPS counter
@@ -82,9 +82,11 @@ bool gl::Texture::isLoaded(unsigned id)
 // -----------------------------------------------------------------------------
 const gl::Texture& gl::Texture::info(unsigned id)
 {
-	auto& tex = textures[id];
-	if (tex.id > 0)
-		return tex;
+	// Don't insert anything here, this can be called from worker threads
+	// (while no textures are being created)
+	auto i = textures.find(id);
+	if (i != textures.end() && i->second.id > 0)
+		return i->second;
 
 	return tex_missing;
 }
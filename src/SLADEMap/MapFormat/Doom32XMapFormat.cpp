@@ -66,11 +66,14 @@ bool Doom32XMapFormat::readVERTEXES(ArchiveEntry* entry, MapObjectCollection& ma
 	auto     vert_data = reinterpret_cast<const Vertex32BE*>(entry->rawData(true));
 	unsigned nv        = entry->size() / sizeof(Vertex32BE);
 	float    p         = ui::getSplashProgress();
+
+	map_data.reserve(MapObject::Type::Vertex, nv);
 	for (size_t a = 0; a < nv; a++)
 	{
-		ui::setSplashProgress(p + (static_cast<float>(a) / nv) * 0.2f);
+		if (a % 1024 == 0)
+			ui::setSplashProgress(p + (static_cast<float>(a) / nv) * 0.2f);
 		map_data.addVertex(
-			std::make_unique<MapVertex>(Vec2d{ static_cast<double>(wxUINT32_SWAP_ON_LE(vert_data[a].x)) / 65536.0,
+			map_data.create<MapVertex>(Vec2d{ static_cast<double>(wxUINT32_SWAP_ON_LE(vert_data[a].x)) / 65536.0,
 											   static_cast<double>(wxUINT32_SWAP_ON_LE(vert_data[a].y)) / 65536.0 }));
 	}
 
@@ -142,10 +142,13 @@ bool Doom64MapFormat::readVERTEXES(ArchiveEntry* entry, MapObjectCollection& map
 	const auto     vert_data = reinterpret_cast<const Vertex*>(entry->rawData(true));
 	const unsigned nv        = entry->size() / sizeof(Vertex);
 	const float    p         = ui::getSplashProgress();
+
+	map_data.reserve(MapObject::Type::Vertex, nv);
 	for (size_t a = 0; a < nv; a++)
 	{
-		ui::setSplashProgress(p + static_cast<float>(a) / static_cast<float>(nv) * 0.2f);
-		map_data.addVertex(std::make_unique<MapVertex>(
+		if (a % 1024 == 0)
+			ui::setSplashProgress(p + static_cast<float>(a) / static_cast<float>(nv) * 0.2f);
+		map_data.addVertex(map_data.create<MapVertex>(
 			Vec2d{ static_cast<double>(vert_data[a].x) / 65536, static_cast<double>(vert_data[a].y) / 65536 }));
 	}
 
@@ -176,12 +179,15 @@ bool Doom64MapFormat::readSIDEDEFS(ArchiveEntry* entry, MapObjectCollection& map
 	const auto     side_data = reinterpret_cast<const SideDef*>(entry->rawData(true));
 	const unsigned ns        = entry->size() / sizeof(SideDef);
 	const float    p         = ui::getSplashProgress();
+
+	map_data.reserve(MapObject::Type::Side, ns);
 	for (size_t a = 0; a < ns; a++)
 	{
-		ui::setSplashProgress(p + static_cast<float>(a) / static_cast<float>(ns) * 0.2f);
+		if (a % 1024 == 0)
+			ui::setSplashProgress(p + static_cast<float>(a) / static_cast<float>(ns) * 0.2f);
 
 		// Add side
-		map_data.addSide(std::make_unique<MapSide>(
+		map_data.addSide(map_data.create<MapSide>(
 			map_data.sectors().at(side_data[a].sector),
 			ResourceManager::doom64TextureName(side_data[a].tex_upper),
 			ResourceManager::doom64TextureName(side_data[a].tex_middle),
@@ -216,9 +222,12 @@ bool Doom64MapFormat::readLINEDEFS(ArchiveEntry* entry, MapObjectCollection& map
 	const auto     line_data = reinterpret_cast<const LineDef*>(entry->rawData(true));
 	const unsigned nl        = entry->size() / sizeof(LineDef);
 	const float    p         = ui::getSplashProgress();
+
+	map_data.reserve(MapObject::Type::Line, nl);
 	for (size_t a = 0; a < nl; a++)
 	{
-		ui::setSplashProgress(p + static_cast<float>(a) / static_cast<float>(nl) * 0.2f);
+		if (a % 1024 == 0)
+			ui::setSplashProgress(p + static_cast<float>(a) / static_cast<float>(nl) * 0.2f);
 		const auto& data = line_data[a];
 
 		// Check vertices exist
@@ -243,16 +252,19 @@ bool Doom64MapFormat::readLINEDEFS(ArchiveEntry* entry, MapObjectCollection& map
 		}
 
 		// Create line
-		auto line = map_data.addLine(
-			std::make_unique<MapLine>(v1, v2, map_data.sides().at(s1_index), map_data.sides().at(s2_index)));
+		int  special = data.type & 0x100 ? 0 : data.type & 0xFF;
+		auto line    = map_data.addLine(map_data.create<MapLine>(
+			v1,
+			v2,
+			map_data.sides().at(s1_index),
+			map_data.sides().at(s2_index),
+			special,
+			data.flags,
+			MapObject::ArgSet{ data.sector_tag }));
 
 		// Set properties
-		line->setArg(0, data.sector_tag);
 		if (data.type & 0x100)
 			line->setIntProperty("macro", data.type & 0xFF);
-		else
-			line->setSpecial(data.type & 0xFF);
-		line->setFlags(data.flags);
 		line->setIntProperty("extraflags", data.type >> 9);
 	}
 
@@ -283,13 +295,16 @@ bool Doom64MapFormat::readSECTORS(ArchiveEntry* entry, MapObjectCollection& map_
 	const auto     sect_data = reinterpret_cast<const Sector*>(entry->rawData(true));
 	const unsigned ns        = entry->size() / sizeof(Sector);
 	const float    p         = ui::getSplashProgress();
+
+	map_data.reserve(MapObject::Type::Sector, ns);
 	for (size_t a = 0; a < ns; a++)
 	{
-		ui::setSplashProgress(p + static_cast<float>(a) / static_cast<float>(ns) * 0.2f);
+		if (a % 1024 == 0)
+			ui::setSplashProgress(p + static_cast<float>(a) / static_cast<float>(ns) * 0.2f);
 		const auto& data = sect_data[a];
 
 		// Add sector
-		auto sector = map_data.addSector(std::make_unique<MapSector>(
+		auto sector = map_data.addSector(map_data.create<MapSector>(
 			data.f_height,
 			ResourceManager::doom64TextureName(data.f_tex),
 			data.c_height,
@@ -335,13 +350,16 @@ bool Doom64MapFormat::readTHINGS(ArchiveEntry* entry, MapObjectCollection& map_d
 	const unsigned    nt        = entry->size() / sizeof(Thing);
 	const float       p         = ui::getSplashProgress();
 	MapObject::ArgSet args;
+
+	map_data.reserve(MapObject::Type::Thing, nt);
 	for (size_t a = 0; a < nt; a++)
 	{
-		ui::setSplashProgress(p + static_cast<float>(a) / static_cast<float>(nt) * 0.2f);
+		if (a % 1024 == 0)
+			ui::setSplashProgress(p + static_cast<float>(a) / static_cast<float>(nt) * 0.2f);
 		const auto& data = thng_data[a];
 
 		// Create thing
-		map_data.addThing(std::make_unique<MapThing>(
+		map_data.addThing(map_data.create<MapThing>(
 			Vec3d{ static_cast<double>(data.x), static_cast<double>(data.y), static_cast<double>(data.z) },
 			data.type,
 			data.angle,
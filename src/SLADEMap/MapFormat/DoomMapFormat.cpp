@@ -156,10 +156,13 @@ bool DoomMapFormat::readVERTEXES(ArchiveEntry* entry, MapObjectCollection& map_d
 	auto     vert_data = reinterpret_cast<const Vertex*>(entry->rawData(true));
 	unsigned nv        = entry->size() / sizeof(Vertex);
 	float    p         = ui::getSplashProgress();
+
+	map_data.reserve(MapObject::Type::Vertex, nv);
 	for (size_t a = 0; a < nv; a++)
 	{
-		ui::setSplashProgress(p + ((float)a / nv) * 0.2f);
-		map_data.addVertex(std::make_unique<MapVertex>(Vec2d{ (double)vert_data[a].x, (double)vert_data[a].y }));
+		if (a % 1024 == 0)
+			ui::setSplashProgress(p + ((float)a / nv) * 0.2f);
+		map_data.addVertex(map_data.create<MapVertex>(Vec2d{ (double)vert_data[a].x, (double)vert_data[a].y }));
 	}
 
 	log::info(3, "Read {} vertices", map_data.vertices().size());
@@ -189,12 +192,15 @@ bool DoomMapFormat::readSIDEDEFS(ArchiveEntry* entry, MapObjectCollection& map_d
 	auto     side_data = reinterpret_cast<const SideDef*>(entry->rawData(true));
 	unsigned ns        = entry->size() / sizeof(SideDef);
 	float    p         = ui::getSplashProgress();
+
+	map_data.reserve(MapObject::Type::Side, ns);
 	for (size_t a = 0; a < ns; a++)
 	{
-		ui::setSplashProgress(p + ((float)a / ns) * 0.2f);
+		if (a % 1024 == 0)
+			ui::setSplashProgress(p + ((float)a / ns) * 0.2f);
 
 		// Add side
-		map_data.addSide(std::make_unique<MapSide>(
+		map_data.addSide(map_data.create<MapSide>(
 			map_data.sectors().at(side_data[a].sector),
 			strutil::viewFromChars(side_data[a].tex_upper, 8),
 			strutil::viewFromChars(side_data[a].tex_middle, 8),
@@ -229,9 +235,12 @@ bool DoomMapFormat::readLINEDEFS(ArchiveEntry* entry, MapObjectCollection& map_d
 	auto     line_data = reinterpret_cast<const LineDef*>(entry->rawData(true));
 	unsigned nl        = entry->size() / sizeof(LineDef);
 	float    p         = ui::getSplashProgress();
+
+	map_data.reserve(MapObject::Type::Line, nl);
 	for (size_t a = 0; a < nl; a++)
 	{
-		ui::setSplashProgress(p + ((float)a / nl) * 0.2f);
+		if (a % 1024 == 0)
+			ui::setSplashProgress(p + ((float)a / nl) * 0.2f);
 		const auto& data = line_data[a];
 
 		// Check vertices exist
@@ -262,15 +271,13 @@ bool DoomMapFormat::readLINEDEFS(ArchiveEntry* entry, MapObjectCollection& map_d
 		auto s1 = map_data.sides().at(s1_index);
 		auto s2 = no_s2 ? nullptr : map_data.sides().at(s2_index);
 		if (s1 && s1->parentLine())
-			s1 = map_data.addSide(std::make_unique<MapSide>(s1->sector(), s1));
+			s1 = map_data.addSide(map_data.create<MapSide>(s1->sector(), s1));
 		if (s2 && s2->parentLine())
-			s2 = map_data.addSide(std::make_unique<MapSide>(s2->sector(), s2));
+			s2 = map_data.addSide(map_data.create<MapSide>(s2->sector(), s2));
 
 		// Create line
-		auto line = map_data.addLine(std::make_unique<MapLine>(v1, v2, s1, s2, data.type, data.flags));
-
-		// Set properties
-		line->setArg(0, data.sector_tag);
+		auto line = map_data.addLine(
+			map_data.create<MapLine>(v1, v2, s1, s2, data.type, data.flags, MapObject::ArgSet{ data.sector_tag }));
 		line->setId(data.sector_tag);
 	}
 
@@ -301,13 +308,16 @@ bool DoomMapFormat::readSECTORS(ArchiveEntry* entry, MapObjectCollection& map_da
 	auto     sect_data = reinterpret_cast<const Sector*>(entry->rawData(true));
 	unsigned ns        = entry->size() / sizeof(Sector);
 	float    p         = ui::getSplashProgress();
+
+	map_data.reserve(MapObject::Type::Sector, ns);
 	for (size_t a = 0; a < ns; a++)
 	{
-		ui::setSplashProgress(p + ((float)a / ns) * 0.2f);
+		if (a % 1024 == 0)
+			ui::setSplashProgress(p + ((float)a / ns) * 0.2f);
 		const auto& data = sect_data[a];
 
 		// Add sector
-		map_data.addSector(std::make_unique<MapSector>(
+		map_data.addSector(map_data.create<MapSector>(
 			data.f_height,
 			strutil::viewFromChars(data.f_tex, 8),
 			data.c_height,
@@ -344,16 +354,20 @@ bool DoomMapFormat::readTHINGS(ArchiveEntry* entry, MapObjectCollection& map_dat
 	auto     thng_data = reinterpret_cast<const Thing*>(entry->rawData(true));
 	unsigned nt        = entry->size() / sizeof(Thing);
 	float    p         = ui::getSplashProgress();
+	bool     srb2      = game::configuration().currentGame() == "srb2"; // Sonic robo blast 2
+
+	map_data.reserve(MapObject::Type::Thing, nt);
 	for (size_t a = 0; a < nt; a++)
 	{
-		ui::setSplashProgress(p + ((float)a / nt) * 0.2f);
-		MapThing* thing = map_data.addThing(std::make_unique<MapThing>(
+		if (a % 1024 == 0)
+			ui::setSplashProgress(p + ((float)a / nt) * 0.2f);
+		MapThing* thing = map_data.addThing(map_data.create<MapThing>(
 			Vec3d{ (double)thng_data[a].x, (double)thng_data[a].y, 0. },
 			thng_data[a].type,
 			thng_data[a].angle,
 			thng_data[a].flags));
 
-		if (game::configuration().currentGame() == "srb2") // Sonic robo blast 2
+		if (srb2)
 		{
 			// Srb2 stores thing's z position at the upper 12-bit from the thing's flags
 			thing->setZ((unsigned)(thng_data[a].flags >> 4));
@@ -513,6 +527,7 @@ unique_ptr<ArchiveEntry> DoomMapFormat::writeTHINGS(const ThingList& things) con
 
 	// Write thing data
 	Thing data;
+	bool  srb2 = game::configuration().currentGame() == "srb2"; // Sonic robo blast 2
 	for (auto& thing : things)
 	{
 		// Position
@@ -524,7 +539,7 @@ unique_ptr<ArchiveEntry> DoomMapFormat::writeTHINGS(const ThingList& things) con
 		data.type  = thing->type();
 		data.flags = thing->flags();
 
-		if (game::configuration().currentGame() == "srb2") // Sonic robo blast 2
+		if (srb2)
 		{
 			// Srb2 stores thing's z position at the upper 12 bits from the thing's flags
 			data.flags = (data.flags & 0xf) | ((unsigned)thing->zPos() << 4);
@@ -70,9 +70,12 @@ bool HexenMapFormat::readLINEDEFS(ArchiveEntry* entry, MapObjectCollection& map_
 	auto     line_data = (LineDef*)entry->rawData(true);
 	unsigned nl        = entry->size() / sizeof(LineDef);
 	float    p         = ui::getSplashProgress();
+
+	map_data.reserve(MapObject::Type::Line, nl);
 	for (size_t a = 0; a < nl; a++)
 	{
-		ui::setSplashProgress(p + ((float)a / nl) * 0.2f);
+		if (a % 1024 == 0)
+			ui::setSplashProgress(p + ((float)a / nl) * 0.2f);
 		const auto& data = line_data[a];
 
 		// Check vertices exist
@@ -105,11 +108,8 @@ bool HexenMapFormat::readLINEDEFS(ArchiveEntry* entry, MapObjectCollection& map_
 			s2 = map_data.duplicateSide(s2);
 
 		// Create line
-		auto line = map_data.addLine(std::make_unique<MapLine>(v1, v2, s1, s2, data.type, data.flags));
-
-		// Set properties
-		for (unsigned i = 0; i < 5; ++i)
-			line->setArg(i, data.args[i]);
+		MapObject::ArgSet args = { data.args[0], data.args[1], data.args[2], data.args[3], data.args[4] };
+		auto              line = map_data.addLine(map_data.create<MapLine>(v1, v2, s1, s2, data.type, data.flags, args));
 
 		// Handle some special cases
 		if (data.type)
@@ -152,9 +152,12 @@ bool HexenMapFormat::readTHINGS(ArchiveEntry* entry, MapObjectCollection& map_da
 	unsigned          nt        = entry->size() / sizeof(Thing);
 	float             p         = ui::getSplashProgress();
 	MapObject::ArgSet args;
+
+	map_data.reserve(MapObject::Type::Thing, nt);
 	for (size_t a = 0; a < nt; a++)
 	{
-		ui::setSplashProgress(p + ((float)a / nt) * 0.2f);
+		if (a % 1024 == 0)
+			ui::setSplashProgress(p + ((float)a / nt) * 0.2f);
 		const auto& data = thng_data[a];
 
 		// Set args
@@ -162,7 +165,7 @@ bool HexenMapFormat::readTHINGS(ArchiveEntry* entry, MapObjectCollection& map_da
 			args[i] = data.args[i];
 
 		// Create thing
-		map_data.addThing(std::make_unique<MapThing>(
+		map_data.addThing(map_data.create<MapThing>(
 			Vec3d{ (double)data.x, (double)data.y, (double)data.z },
 			data.type,
 			data.angle,
@@ -31,7 +31,6 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "UniversalDoomMapFormat.h"
-#include "App.h"
 #include "Game/Configuration.h"
 #include "General/UI.h"
 #include "SLADEMap/MapObject/MapLine.h"
@@ -41,10 +40,163 @@
 #include "SLADEMap/SLADEMap.h"
 #include "Utility/Parser.h"
 #include "Utility/StringUtils.h"
+#include "Utility/ThreadPool.h"
 
 using namespace slade;
 
 
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// TEXTMAP data smaller than these (per chunk) isn't worth splitting up for
+// parsing/writing on multiple threads
+constexpr size_t MIN_PARSE_CHUNK_SIZE = 1024 * 1024;
+constexpr size_t MIN_WRITE_CHUNK_SIZE = 256 * 1024;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// A chunk of TEXTMAP text and the line number it starts at within the TEXTMAP
+struct TextmapChunk
+{
+	string_view text;
+	unsigned    first_line = 1;
+};
+
+// -----------------------------------------------------------------------------
+// Splits UDMF [text] into (up to) [max_chunks] chunks of roughly equal size.
+// Chunks are only split at top-level block/assignment boundaries (ie. after a
+// '}' or ';' outside of any block, string or comment), so each chunk can be
+// parsed independently.
+// Returns the text and starting line of each chunk, in order
+// -----------------------------------------------------------------------------
+vector<TextmapChunk> splitTextmap(string_view text, size_t max_chunks)
+{
+	vector<TextmapChunk> chunks;
+	size_t               size = text.size();
+	if (max_chunks < 2 || size < MIN_PARSE_CHUNK_SIZE * 2)
+	{
+		chunks.push_back({ text });
+		return chunks;
+	}
+
+	max_chunks        = std::min(max_chunks, size / MIN_PARSE_CHUNK_SIZE);
+	size_t chunk_size = size / max_chunks;
+	size_t start      = 0;
+	size_t split_at   = chunk_size;
+	int    depth      = 0;
+	size_t pos        = 0;
+	while (pos < size)
+	{
+		char c = text[pos];
+
+		// Quoted string
+		if (c == '"')
+		{
+			++pos;
+			while (pos < size && text[pos] != '"')
+				pos += text[pos] == '\\' && pos + 1 < size && text[pos + 1] == '"' ? 2 : 1;
+		}
+
+		// Line comment
+		else if (pos + 1 < size && ((c == '/' && text[pos + 1] == '/') || (c == '#' && text[pos + 1] == '#')))
+		{
+			while (pos < size && text[pos] != '\n')
+				++pos;
+		}
+
+		// Block comment
+		else if (c == '/' && pos + 1 < size && text[pos + 1] == '*')
+		{
+			auto end = text.find("*/", pos + 2);
+			pos      = end == string_view::npos ? size : end + 1;
+		}
+
+		else if (c == '{')
+			++depth;
+
+		else if (c == '}' || c == ';')
+		{
+			if (c == '}')
+				--depth;
+
+			// End of a top-level block or assignment, split here if far enough along
+			if (depth == 0 && pos + 1 >= split_at && pos + 1 < size)
+			{
+				chunks.push_back({ text.substr(start, pos + 1 - start) });
+				start    = pos + 1;
+				split_at = start + chunk_size;
+				if (chunks.size() == max_chunks - 1)
+					break;
+			}
+		}
+
+		++pos;
+	}
+
+	chunks.push_back({ text.substr(start) });
+
+	// Get the line number each chunk starts at, so parse errors give the same
+	// line numbers as they would parsing the whole TEXTMAP
+	for (unsigned a = 1; a < chunks.size(); ++a)
+	{
+		auto& prev           = chunks[a - 1];
+		chunks[a].first_line = prev.first_line + std::count(prev.text.begin(), prev.text.end(), '\n');
+	}
+
+	return chunks;
+}
+
+// -----------------------------------------------------------------------------
+// Writes UDMF definitions for all [objects], appending them to [blocks] as one
+// or more consecutive text blocks (in object order).
+// Large lists are split into chunks that are written concurrently.
+// [bytes_per_object] is a rough estimate of the output size of each object,
+// used to preallocate the block strings
+// -----------------------------------------------------------------------------
+template<typename T>
+void writeObjectBlocks(const MapObjectList<T>& objects, size_t bytes_per_object, vector<string>& blocks)
+{
+	auto n_objects = objects.size();
+	if (n_objects == 0)
+		return;
+
+	auto n_chunks = std::clamp<size_t>(
+		n_objects * bytes_per_object / MIN_WRITE_CHUNK_SIZE, 1, threadpool::nWorkers() * 2);
+	auto first = blocks.size();
+	blocks.resize(first + n_chunks);
+
+	threadpool::parallelFor(
+		n_chunks,
+		[&](size_t chunk)
+		{
+			auto  start = n_objects * chunk / n_chunks;
+			auto  end   = n_objects * (chunk + 1) / n_chunks;
+			auto& def   = blocks[first + chunk];
+
+			// Allow extra space for any additional properties
+			size_t estimate = 0;
+			for (auto a = start; a < end; ++a)
+				estimate += bytes_per_object + objects[a]->props().properties().size() * 24;
+			def.reserve(estimate);
+
+			for (auto a = start; a < end; ++a)
+				objects[a]->writeUDMF(def);
+		});
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // UniversalDoomMapFormat Class Functions
@@ -67,11 +219,26 @@ bool UniversalDoomMapFormat::readMap(Archive::MapDesc map, MapObjectCollection&
 		return false;
 
 	// --- Parse UDMF text ---
+	// Large TEXTMAPs are split at top-level block boundaries and the chunks
+	// parsed concurrently. Each chunk gets its own parse tree, and the trees are
+	// processed in chunk order below so the result is identical to a single
+	// serial parse
 	ui::setSplashProgressMessage("Parsing TEXTMAP");
 	ui::setSplashProgress(-100.0f);
-	Parser parser;
-	if (!parser.parseText(textmap->data()))
-		return false;
+	const auto& data   = textmap->data();
+	auto        chunks = splitTextmap(
+		{ reinterpret_cast<const char*>(data.data()), data.size() }, threadpool::nWorkers());
+	vector<Parser> parsers(chunks.size());
+	vector<char>   parsed(chunks.size(), 0);
+	threadpool::parallelFor(
+		chunks.size(),
+		[&](size_t index)
+		{
+			parsed[index] = parsers[index].parseText(chunks[index].text, "TEXTMAP", chunks[index].first_line);
+		});
+	for (auto ok : parsed)
+		if (!ok)
+			return false;
 
 	// --- Process parsed data ---
 
@@ -80,18 +247,24 @@ bool UniversalDoomMapFormat::readMap(Archive::MapDesc map, MapObjectCollection&
 	// even if they aren't defined in that order.
 	// Unknown definitions are also kept, just in case
 	ui::setSplashProgressMessage("Sorting definitions");
-	auto                   root = parser.parseTreeRoot();
 	vector<ParseTreeNode*> defs_vertices;
 	vector<ParseTreeNode*> defs_lines;
 	vector<ParseTreeNode*> defs_sides;
 	vector<ParseTreeNode*> defs_sectors;
 	vector<ParseTreeNode*> defs_things;
 	vector<ParseTreeNode*> defs_other;
-	for (unsigned a = 0; a < root->nChildren(); a++)
+	vector<ParseTreeNode*> nodes;
+	for (const auto& parser : parsers)
+	{
+		auto root = parser.parseTreeRoot();
+		for (unsigned a = 0; a < root->nChildren(); a++)
+			nodes.push_back(root->childPTN(a));
+	}
+	for (unsigned a = 0; a < nodes.size(); a++)
 	{
-		ui::setSplashProgress((float)a / root->nChildren());
+		ui::setSplashProgress((float)a / nodes.size());
 
-		auto node = root->childPTN(a);
+		auto node = nodes[a];
 
 		// Vertex definition
 		if (strutil::equalCI(node->name(), "vertex"))
@@ -130,7 +303,7 @@ bool UniversalDoomMapFormat::readMap(Archive::MapDesc map, MapObjectCollection&
 	{
 		ui::setSplashProgress(((float)a / defs_vertices.size()) * 0.2f);
 
-		auto vertex = createVertex(defs_vertices[a]);
+		auto vertex = createVertex(defs_vertices[a], map_data);
 		if (!vertex)
 		{
 			log::warning("Invalid UDMF vertex definition {}, not added", a);
@@ -146,7 +319,7 @@ bool UniversalDoomMapFormat::readMap(Archive::MapDesc map, MapObjectCollection&
 	{
 		ui::setSplashProgress(0.2f + ((float)a / defs_sectors.size()) * 0.2f);
 
-		auto sector = createSector(defs_sectors[a]);
+		auto sector = createSector(defs_sectors[a], map_data);
 		if (!sector)
 		{
 			log::warning("Invalid UDMF sector definition {}, not added", a);
@@ -194,7 +367,7 @@ bool UniversalDoomMapFormat::readMap(Archive::MapDesc map, MapObjectCollection&
 	{
 		ui::setSplashProgress(0.8f + ((float)a / defs_things.size()) * 0.2f);
 
-		auto thing = createThing(defs_things[a]);
+		auto thing = createThing(defs_things[a], map_data);
 		if (!thing)
 		{
 			log::warning("Invalid UDMF thing definition {}, not added", a);
@@ -229,98 +402,60 @@ vector<unique_ptr<ArchiveEntry>> UniversalDoomMapFormat::writeMap(
 	vector<unique_ptr<ArchiveEntry>> entries;
 	entries.push_back(std::make_unique<ArchiveEntry>("TEXTMAP"));
 
-	// Open temp text file
-	wxFile tempfile(app::path("sladetemp.txt", app::Dir::Temp), wxFile::write);
-
-	// Write map namespace
-	tempfile.Write("// Written by SLADE3\n");
-	tempfile.Write(fmt::format("namespace=\"{}\";\n", udmf_namespace_));
-
-	// Write map-scope props
-	tempfile.Write(map_extra_props.toString(true));
-	tempfile.Write("\n");
-
-	// sf::Clock clock;
-
 	// Locale for float number format
 	setlocale(LC_NUMERIC, "C");
 
-	// Write things
-	string object_def;
+	// Cleanup object properties first, this uses the game configuration so
+	// can't be done on worker threads
 	for (const auto& thing : map_data.things())
-	{
-		// Cleanup properties
 		if (!thing->props().empty())
 		{
 			thing->props().remove("flags");
 			game::configuration().cleanObjectUDMFProps(thing);
 		}
-
-		thing->writeUDMF(object_def);
-		tempfile.Write(object_def);
-	}
-	// log::info(1, "Writing things took %dms", clock.getElapsedTime().asMilliseconds());
-
-	// Write lines
-	// clock.restart();
 	for (const auto& line : map_data.lines())
-	{
-		// Cleanup properties
 		if (!line->props().empty())
 		{
 			line->props().remove("flags");
 			game::configuration().cleanObjectUDMFProps(line);
 		}
-
-		line->writeUDMF(object_def);
-		tempfile.Write(object_def);
-	}
-	// log::info(1, "Writing lines took %dms", clock.getElapsedTime().asMilliseconds());
-
-	// Write sides
-	// clock.restart();
 	for (const auto& side : map_data.sides())
-	{
-		// Cleanup properties
 		if (!side->props().empty())
 			game::configuration().cleanObjectUDMFProps(side);
-
-		side->writeUDMF(object_def);
-		tempfile.Write(object_def);
-	}
-	// log::info(1, "Writing sides took %dms", clock.getElapsedTime().asMilliseconds());
-
-	// Write vertices
-	// clock.restart();
 	for (const auto& vertex : map_data.vertices())
-	{
-		// Cleanup properties
 		if (!vertex->props().empty())
 			game::configuration().cleanObjectUDMFProps(vertex);
-
-		vertex->writeUDMF(object_def);
-		tempfile.Write(object_def);
-	}
-	// log::info(1, "Writing vertices took %dms", clock.getElapsedTime().asMilliseconds());
-
-	// Write sectors
-	// clock.restart();
 	for (const auto& sector : map_data.sectors())
-	{
-		// Cleanup properties
 		if (!sector->props().empty())
 			game::configuration().cleanObjectUDMFProps(sector);
 
-		sector->writeUDMF(object_def);
-		tempfile.Write(object_def);
+	// Write map namespace and map-scope props
+	vector<string> blocks(1);
+	blocks[0] = "// Written by SLADE3\n";
+	fmt::format_to(std::back_inserter(blocks[0]), "namespace=\"{}\";\n", udmf_namespace_);
+	map_extra_props.write(blocks[0], true);
+	blocks[0] += "\n";
+
+	// Write objects (things, lines, sides, vertices then sectors)
+	writeObjectBlocks(map_data.things(), 96, blocks);
+	writeObjectBlocks(map_data.lines(), 80, blocks);
+	writeObjectBlocks(map_data.sides(), 64, blocks);
+	writeObjectBlocks(map_data.vertices(), 40, blocks);
+	writeObjectBlocks(map_data.sectors(), 128, blocks);
+
+	// Copy all blocks directly into the entry data
+	size_t total_size = 0;
+	for (const auto& block : blocks)
+		total_size += block.size();
+	auto& mc = entries[0]->data();
+	mc.reSize(total_size, false);
+	size_t offset = 0;
+	for (const auto& block : blocks)
+	{
+		memcpy(mc.data() + offset, block.data(), block.size());
+		offset += block.size();
 	}
-	// log::info(1, "Writing sectors took %dms", clock.getElapsedTime().asMilliseconds());
-
-	// Close file
-	tempfile.Close();
-
-	// Load file to entry
-	entries[0]->importFile(app::path("sladetemp.txt", app::Dir::Temp));
+	entries[0]->updateSize();
 
 	return entries;
 }
@@ -328,7 +463,7 @@ vector<unique_ptr<ArchiveEntry>> UniversalDoomMapFormat::writeMap(
 // -----------------------------------------------------------------------------
 // Creates and returns a vertex from parsed UDMF definition [def]
 // -----------------------------------------------------------------------------
-unique_ptr<MapVertex> UniversalDoomMapFormat::createVertex(ParseTreeNode* def) const
+unique_ptr<MapVertex> UniversalDoomMapFormat::createVertex(ParseTreeNode* def, MapObjectCollection& map_data) const
 {
 	// Check for required properties
 	auto prop_x = def->childPTN("x");
@@ -337,13 +472,13 @@ unique_ptr<MapVertex> UniversalDoomMapFormat::createVertex(ParseTreeNode* def) c
 		return nullptr;
 
 	// Create vertex
-	return std::make_unique<MapVertex>(Vec2d{ prop_x->floatValue(), prop_y->floatValue() }, def);
+	return map_data.create<MapVertex>(Vec2d{ prop_x->floatValue(), prop_y->floatValue() }, def);
 }
 
 // -----------------------------------------------------------------------------
 // Creates and returns a sector from parsed UDMF definition [def]
 // -----------------------------------------------------------------------------
-unique_ptr<MapSector> UniversalDoomMapFormat::createSector(ParseTreeNode* def) const
+unique_ptr<MapSector> UniversalDoomMapFormat::createSector(ParseTreeNode* def, MapObjectCollection& map_data) const
 {
 	// Check for required properties
 	auto prop_ftex = def->childPTN("texturefloor");
@@ -352,13 +487,13 @@ unique_ptr<MapSector> UniversalDoomMapFormat::createSector(ParseTreeNode* def) c
 		return nullptr;
 
 	// Create sector
-	return std::make_unique<MapSector>(prop_ftex->stringValue(), prop_ctex->stringValue(), def);
+	return map_data.create<MapSector>(prop_ftex->stringValue(), prop_ctex->stringValue(), def);
 }
 
 // -----------------------------------------------------------------------------
 // Creates and returns a side from parsed UDMF definition [def]
 // -----------------------------------------------------------------------------
-unique_ptr<MapSide> UniversalDoomMapFormat::createSide(ParseTreeNode* def, const MapObjectCollection& map_data) const
+unique_ptr<MapSide> UniversalDoomMapFormat::createSide(ParseTreeNode* def, MapObjectCollection& map_data) const
 {
 	// Check for required properties
 	auto prop_sector = def->childPTN("sector");
@@ -371,7 +506,7 @@ unique_ptr<MapSide> UniversalDoomMapFormat::createSide(ParseTreeNode* def, const
 		return nullptr;
 
 	// Create side
-	return std::make_unique<MapSide>(sector, def);
+	return map_data.create<MapSide>(sector, def);
 }
 
 // -----------------------------------------------------------------------------
@@ -399,18 +534,18 @@ unique_ptr<MapLine> UniversalDoomMapFormat::createLine(ParseTreeNode* def, MapOb
 
 	// Copy side(s) if they already have parent lines (compressed sidedefs)
 	if (s1 && s1->parentLine())
-		s1 = map_data.addSide(std::make_unique<MapSide>(s1->sector(), s1));
+		s1 = map_data.addSide(map_data.create<MapSide>(s1->sector(), s1));
 	if (s2 && s2->parentLine())
-		s2 = map_data.addSide(std::make_unique<MapSide>(s2->sector(), s2));
+		s2 = map_data.addSide(map_data.create<MapSide>(s2->sector(), s2));
 
 	// Create line
-	return std::make_unique<MapLine>(v1, v2, s1, s2, def);
+	return map_data.create<MapLine>(v1, v2, s1, s2, def);
 }
 
 // -----------------------------------------------------------------------------
 // Creates and returns a thing from parsed UDMF definition [def]
 // -----------------------------------------------------------------------------
-unique_ptr<MapThing> UniversalDoomMapFormat::createThing(ParseTreeNode* def) const
+unique_ptr<MapThing> UniversalDoomMapFormat::createThing(ParseTreeNode* def, MapObjectCollection& map_data) const
 {
 	// Check for required properties
 	auto prop_x    = def->childPTN(MapThing::PROP_X);
@@ -420,6 +555,6 @@ unique_ptr<MapThing> UniversalDoomMapFormat::createThing(ParseTreeNode* def) con
 		return nullptr;
 
 	// Create thing
-	return std::make_unique<MapThing>(
+	return map_data.create<MapThing>(
 		Vec3d{ prop_x->floatValue(), prop_y->floatValue(), 0. }, prop_type->intValue(), def);
 }
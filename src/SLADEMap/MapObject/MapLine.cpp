@@ -33,6 +33,7 @@
 #include "MapLine.h"
 #include "MapSide.h"
 #include "MapVertex.h"
+#include "SLADEMap/MapObjectPools.h"
 #include "SLADEMap/SLADEMap.h"
 #include "Utility/MathStuff.h"
 #include "Utility/Parser.h"
@@ -48,6 +49,39 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 
 
+// -----------------------------------------------------------------------------
+// Allocates memory for a new MapLine from the heap (see ObjectPool)
+// -----------------------------------------------------------------------------
+void* MapLine::operator new(size_t size)
+{
+	return ObjectPool<MapLine>::allocate(size);
+}
+
+// -----------------------------------------------------------------------------
+// Allocates memory for a new MapLine from the line pool in [pools]
+// -----------------------------------------------------------------------------
+void* MapLine::operator new(size_t size, MapObjectPools& pools)
+{
+	return ObjectPool<MapLine>::allocate(size, &pools.lines);
+}
+
+// -----------------------------------------------------------------------------
+// Frees memory for a deleted MapLine, returning it to the pool it was
+// allocated from
+// -----------------------------------------------------------------------------
+void MapLine::operator delete(void* ptr)
+{
+	ObjectPool<MapLine>::free(ptr);
+}
+
+// -----------------------------------------------------------------------------
+// Frees memory for a MapLine allocated from [pools] if its constructor throws
+// -----------------------------------------------------------------------------
+void MapLine::operator delete(void* ptr, MapObjectPools& pools)
+{
+	ObjectPool<MapLine>::free(ptr);
+}
+
 // -----------------------------------------------------------------------------
 // MapLine class constructor
 // -----------------------------------------------------------------------------
@@ -990,29 +1024,31 @@ void MapLine::copy(MapObject* c)
 }
 
 // -----------------------------------------------------------------------------
-// Writes the line as a UDMF text definition to [def]
+// Writes the line as a UDMF text definition, appending it to [def]
 // -----------------------------------------------------------------------------
 void MapLine::writeUDMF(string& def)
 {
-	def = fmt::format("linedef//#{}\n{{\n", index_);
+	auto out = std::back_inserter(def);
+
+	fmt::format_to(out, "linedef//#{}\n{{\n", index_);
 
 	// Basic properties
-	def += fmt::format("v1={};\nv2={};\nsidefront={};\n", v1Index(), v2Index(), s1Index());
+	fmt::format_to(out, "v1={};\nv2={};\nsidefront={};\n", v1Index(), v2Index(), s1Index());
 	if (s2())
-		def += fmt::format("sideback={};\n", s2Index());
+		fmt::format_to(out, "sideback={};\n", s2Index());
 	if (special_ != 0)
-		def += fmt::format("special={};\n", special_);
+		fmt::format_to(out, "special={};\n", special_);
 	if (id_ != 0)
-		def += fmt::format("id={};\n", id_);
+		fmt::format_to(out, "id={};\n", id_);
 	if (flags_ != 0)
-		def += fmt::format("flags={};\n", flags_);
+		fmt::format_to(out, "flags={};\n", flags_);
 	for (unsigned i = 0; i < 5; ++i)
 		if (args_[i] != 0)
-			def += fmt::format("arg{}={};\n", i, args_[i]);
+			fmt::format_to(out, "arg{}={};\n", i, args_[i]);
 
 	// Other properties
 	if (!properties_.empty())
-		def += properties_.toString(true, 3);
+		properties_.write(def, true, 3);
 
 	def += "}\n\n";
 }
@@ -44,6 +44,13 @@ public:
 	MapLine(MapVertex* v1, MapVertex* v2, MapSide* s1, MapSide* s2, ParseTreeNode* udmf_def);
 	~MapLine() = default;
 
+	// Allocated from a map's object pools when created with new (pools),
+	// otherwise from the heap
+	static void* operator new(size_t size);
+	static void* operator new(size_t size, MapObjectPools& pools);
+	static void  operator delete(void* ptr);
+	static void  operator delete(void* ptr, MapObjectPools& pools);
+
 	bool isOk() const { return vertex1_ && vertex2_; }
 
 	MapVertex*    v1() const { return vertex1_; }
@@ -11,6 +11,7 @@ namespace slade
 {
 class ParseTreeNode;
 class SLADEMap;
+struct MapObjectPools;
 
 // Forward declare map object types
 class MapVertex;
@@ -33,6 +33,7 @@
 #include "MapSector.h"
 #include "App.h"
 #include "Game/Configuration.h"
+#include "SLADEMap/MapObjectPools.h"
 #include "SLADEMap/SLADEMap.h"
 #include "Utility/MathStuff.h"
 #include "Utility/Parser.h"
@@ -47,6 +48,39 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 
 
+// -----------------------------------------------------------------------------
+// Allocates memory for a new MapSector from the heap (see ObjectPool)
+// -----------------------------------------------------------------------------
+void* MapSector::operator new(size_t size)
+{
+	return ObjectPool<MapSector>::allocate(size);
+}
+
+// -----------------------------------------------------------------------------
+// Allocates memory for a new MapSector from the sector pool in [pools]
+// -----------------------------------------------------------------------------
+void* MapSector::operator new(size_t size, MapObjectPools& pools)
+{
+	return ObjectPool<MapSector>::allocate(size, &pools.sectors);
+}
+
+// -----------------------------------------------------------------------------
+// Frees memory for a deleted MapSector, returning it to the pool it was
+// allocated from
+// -----------------------------------------------------------------------------
+void MapSector::operator delete(void* ptr)
+{
+	ObjectPool<MapSector>::free(ptr);
+}
+
+// -----------------------------------------------------------------------------
+// Frees memory for a MapSector allocated from [pools] if its constructor throws
+// -----------------------------------------------------------------------------
+void MapSector::operator delete(void* ptr, MapObjectPools& pools)
+{
+	ObjectPool<MapSector>::free(ptr);
+}
+
 // -----------------------------------------------------------------------------
 // MapSector class constructor
 // -----------------------------------------------------------------------------
@@ -375,6 +409,18 @@ void MapSector::updateBBox()
 	setGeometryUpdated();
 }
 
+// -----------------------------------------------------------------------------
+// Resets the sector's bounding box so it is recalculated when next needed
+// -----------------------------------------------------------------------------
+void MapSector::resetBBox()
+{
+	bbox_.reset();
+
+	// Sector geometry has changed
+	if (parent_map_)
+		parent_map_->sectors().sectorGeometryChanged(this);
+}
+
 // -----------------------------------------------------------------------------
 // Returns the sector bounding box
 // -----------------------------------------------------------------------------
@@ -388,14 +434,20 @@ BBox MapSector::boundingBox()
 }
 
 // -----------------------------------------------------------------------------
-// Returns the sector polygon, updating it if necessary
+// Returns the sector polygon, updating it if necessary.
+// Safe to call from multiple threads, though the sector's lines must not be
+// modified while it is being built
 // -----------------------------------------------------------------------------
 Polygon2D* MapSector::polygon()
 {
-	if (poly_needsupdate_)
+	if (poly_needsupdate_.load(std::memory_order_acquire))
 	{
-		polygon_.openSector(this);
-		poly_needsupdate_ = false;
+		std::lock_guard lock(poly_mutex_);
+		if (poly_needsupdate_)
+		{
+			polygon_.openSector(this);
+			poly_needsupdate_.store(false, std::memory_order_release);
+		}
 	}
 
 	return &polygon_;
@@ -852,7 +904,7 @@ void MapSector::connectSide(MapSide* side)
 	setModified();
 	connected_sides_.push_back(side);
 	poly_needsupdate_ = true;
-	bbox_.reset();
+	resetBBox();
 	setGeometryUpdated();
 }
 
@@ -872,7 +924,7 @@ void MapSector::disconnectSide(const MapSide* side)
 	}
 
 	poly_needsupdate_ = true;
-	bbox_.reset();
+	resetBBox();
 	setGeometryUpdated();
 }
 
@@ -932,29 +984,31 @@ void MapSector::readBackup(Backup* backup)
 
 	// Update geometry info
 	poly_needsupdate_ = true;
-	bbox_.reset();
+	resetBBox();
 	setGeometryUpdated();
 }
 
 // -----------------------------------------------------------------------------
-// Writes the sector as a UDMF text definition to [def]
+// Writes the sector as a UDMF text definition, appending it to [def]
 // -----------------------------------------------------------------------------
 void MapSector::writeUDMF(string& def)
 {
-	def = fmt::format("sector//#{}\n{{\n", index_);
+	auto out = std::back_inserter(def);
+
+	fmt::format_to(out, "sector//#{}\n{{\n", index_);
 
 	// Basic properties
-	def += fmt::format("texturefloor=\"{}\";\ntextureceiling=\"{}\";\n", floor_.texture, ceiling_.texture);
+	fmt::format_to(out, "texturefloor=\"{}\";\ntextureceiling=\"{}\";\n", floor_.texture, ceiling_.texture);
 	if (floor_.height != 0)
-		def += fmt::format("heightfloor={};\n", floor_.height);
+		fmt::format_to(out, "heightfloor={};\n", floor_.height);
 	if (ceiling_.height != 0)
-		def += fmt::format("heightceiling={};\n", ceiling_.height);
+		fmt::format_to(out, "heightceiling={};\n", ceiling_.height);
 	if (light_ != 160)
-		def += fmt::format("lightlevel={};\n", light_);
+		fmt::format_to(out, "lightlevel={};\n", light_);
 	if (special_ != 0)
-		def += fmt::format("special={};\n", special_);
+		fmt::format_to(out, "special={};\n", special_);
 	if (id_ != 0)
-		def += fmt::format("id={};\n", id_);
+		fmt::format_to(out, "id={};\n", id_);
 
 	// For UDMF sector planes, ALL values must be added, or else GZDoom
 	// will consider them invalid.
@@ -998,15 +1052,15 @@ void MapSector::writeUDMF(string& def)
 
 	// Other properties (that are not related to floor/ceiling planes
 	if (!properties_.empty())
-		def += properties_.toString(true, 3);
+		properties_.write(def, true, 3);
 
 	// Write the floor and ceiling plane values in order
 	if (hasFloorPlane)
 	{
-		def += fmt::format("floorplane_a = {};", floor_a);
-		def += fmt::format("floorplane_b = {};", floor_b);
-		def += fmt::format("floorplane_c = {};", floor_c);
-		def += fmt::format("floorplane_d = {};", floor_d);
+		fmt::format_to(out, "floorplane_a = {};", floor_a);
+		fmt::format_to(out, "floorplane_b = {};", floor_b);
+		fmt::format_to(out, "floorplane_c = {};", floor_c);
+		fmt::format_to(out, "floorplane_d = {};", floor_d);
 		// Persist between multiple saves
 		properties_["floorplane_a"] = floor_a;
 		properties_["floorplane_b"] = floor_b;
@@ -1015,10 +1069,10 @@ void MapSector::writeUDMF(string& def)
 	}
 	if (hasCeilingPlane)
 	{
-		def += fmt::format("ceilingplane_a = {};", ceiling_a);
-		def += fmt::format("ceilingplane_b = {};", ceiling_b);
-		def += fmt::format("ceilingplane_c = {};", ceiling_c);
-		def += fmt::format("ceilingplane_d = {};", ceiling_d);
+		fmt::format_to(out, "ceilingplane_a = {};", ceiling_a);
+		fmt::format_to(out, "ceilingplane_b = {};", ceiling_b);
+		fmt::format_to(out, "ceilingplane_c = {};", ceiling_c);
+		fmt::format_to(out, "ceilingplane_d = {};", ceiling_d);
 		// Persist between multiple saves
 		properties_["ceilingplane_a"] = ceiling_a;
 		properties_["ceilingplane_b"] = ceiling_b;
@@ -3,6 +3,8 @@
 #include "MapObject.h"
 #include "Utility/Colour.h"
 #include "Utility/Polygon2D.h"
+#include <atomic>
+#include <mutex>
 
 namespace slade
 {
@@ -90,6 +92,13 @@ public:
 	MapSector(string_view f_tex, string_view c_tex, const ParseTreeNode* udmf_def);
 	~MapSector() override = default;
 
+	// Allocated from a map's object pools when created with new (pools),
+	// otherwise from the heap
+	static void* operator new(size_t size);
+	static void* operator new(size_t size, MapObjectPools& pools);
+	static void  operator delete(void* ptr);
+	static void  operator delete(void* ptr, MapObjectPools& pools);
+
 	void copy(MapObject* obj) override;
 
 	const Surface& floor() const { return floor_; }
@@ -121,7 +130,7 @@ public:
 	template<SurfaceType p> void  setPlane(const Plane& plane);
 
 	Vec2d             getPoint(Point point) override;
-	void              resetBBox() { bbox_.reset(); }
+	void              resetBBox();
 	BBox              boundingBox();
 	vector<MapSide*>& connectedSides() { return connected_sides_; }
 	void              resetPolygon() { poly_needsupdate_ = true; }
@@ -174,7 +183,8 @@ private:
 	vector<MapSide*>   connected_sides_;
 	BBox               bbox_;
 	Polygon2D          polygon_;
-	bool               poly_needsupdate_ = true;
+	std::atomic<bool>  poly_needsupdate_{ true };
+	std::mutex         poly_mutex_; // Polygons can be built on worker threads
 	long               geometry_updated_ = 0;
 	Vec2d              text_point_;
 	vector<ExtraFloor> extra_floors_;
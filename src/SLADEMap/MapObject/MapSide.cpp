@@ -32,6 +32,7 @@
 #include "Main.h"
 #include "MapSide.h"
 #include "Game/Configuration.h"
+#include "SLADEMap/MapObjectPools.h"
 #include "SLADEMap/SLADEMap.h"
 #include "Utility/Parser.h"
 #include "Utility/StringUtils.h"
@@ -46,6 +47,39 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 
 
+// -----------------------------------------------------------------------------
+// Allocates memory for a new MapSide from the heap (see ObjectPool)
+// -----------------------------------------------------------------------------
+void* MapSide::operator new(size_t size)
+{
+	return ObjectPool<MapSide>::allocate(size);
+}
+
+// -----------------------------------------------------------------------------
+// Allocates memory for a new MapSide from the side pool in [pools]
+// -----------------------------------------------------------------------------
+void* MapSide::operator new(size_t size, MapObjectPools& pools)
+{
+	return ObjectPool<MapSide>::allocate(size, &pools.sides);
+}
+
+// -----------------------------------------------------------------------------
+// Frees memory for a deleted MapSide, returning it to the pool it was
+// allocated from
+// -----------------------------------------------------------------------------
+void MapSide::operator delete(void* ptr)
+{
+	ObjectPool<MapSide>::free(ptr);
+}
+
+// -----------------------------------------------------------------------------
+// Frees memory for a MapSide allocated from [pools] if its constructor throws
+// -----------------------------------------------------------------------------
+void MapSide::operator delete(void* ptr, MapObjectPools& pools)
+{
+	ObjectPool<MapSide>::free(ptr);
+}
+
 // -----------------------------------------------------------------------------
 // MapSide class constructor
 // -----------------------------------------------------------------------------
@@ -390,28 +424,30 @@ void MapSide::readBackup(Backup* backup)
 }
 
 // -----------------------------------------------------------------------------
-// Writes the side as a UDMF text definition to [def]
+// Writes the side as a UDMF text definition, appending it to [def]
 // -----------------------------------------------------------------------------
 void MapSide::writeUDMF(string& def)
 {
-	def = fmt::format("sidedef//#{}\n{{\n", index_);
+	auto out = std::back_inserter(def);
+
+	fmt::format_to(out, "sidedef//#{}\n{{\n", index_);
 
 	// Basic properties
-	def += fmt::format("sector={};\n", sector_->index());
+	fmt::format_to(out, "sector={};\n", sector_->index());
 	if (tex_upper_ != "-")
-		def += fmt::format("texturetop=\"{}\";\n", tex_upper_);
+		fmt::format_to(out, "texturetop=\"{}\";\n", tex_upper_);
 	if (tex_middle_ != "-")
-		def += fmt::format("texturemiddle=\"{}\";\n", tex_middle_);
+		fmt::format_to(out, "texturemiddle=\"{}\";\n", tex_middle_);
 	if (tex_lower_ != "-")
-		def += fmt::format("texturebottom=\"{}\";\n", tex_lower_);
+		fmt::format_to(out, "texturebottom=\"{}\";\n", tex_lower_);
 	if (tex_offset_.x != 0)
-		def += fmt::format("offsetx={};\n", tex_offset_.x);
+		fmt::format_to(out, "offsetx={};\n", tex_offset_.x);
 	if (tex_offset_.y != 0)
-		def += fmt::format("offsety={};\n", tex_offset_.y);
+		fmt::format_to(out, "offsety={};\n", tex_offset_.y);
 
 	// Other properties
 	if (!properties_.empty())
-		def += properties_.toString(true, 3);
+		properties_.write(def, true, 3);
 
 	def += "}\n\n";
 }
@@ -31,6 +31,13 @@ public:
 	MapSide(MapSector* sector, MapSide* copy_side);
 	~MapSide() = default;
 
+	// Allocated from a map's object pools when created with new (pools),
+	// otherwise from the heap
+	static void* operator new(size_t size);
+	static void* operator new(size_t size, MapObjectPools& pools);
+	static void  operator delete(void* ptr);
+	static void  operator delete(void* ptr, MapObjectPools& pools);
+
 	void copy(MapObject* c) override;
 
 	bool isOk() const { return !!sector_; }
@@ -31,6 +31,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "MapThing.h"
+#include "SLADEMap/MapObjectPools.h"
 #include "Utility/Parser.h"
 
 using namespace slade;
@@ -43,6 +44,39 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 
 
+// -----------------------------------------------------------------------------
+// Allocates memory for a new MapThing from the heap (see ObjectPool)
+// -----------------------------------------------------------------------------
+void* MapThing::operator new(size_t size)
+{
+	return ObjectPool<MapThing>::allocate(size);
+}
+
+// -----------------------------------------------------------------------------
+// Allocates memory for a new MapThing from the thing pool in [pools]
+// -----------------------------------------------------------------------------
+void* MapThing::operator new(size_t size, MapObjectPools& pools)
+{
+	return ObjectPool<MapThing>::allocate(size, &pools.things);
+}
+
+// -----------------------------------------------------------------------------
+// Frees memory for a deleted MapThing, returning it to the pool it was
+// allocated from
+// -----------------------------------------------------------------------------
+void MapThing::operator delete(void* ptr)
+{
+	ObjectPool<MapThing>::free(ptr);
+}
+
+// -----------------------------------------------------------------------------
+// Frees memory for a MapThing allocated from [pools] if its constructor throws
+// -----------------------------------------------------------------------------
+void MapThing::operator delete(void* ptr, MapObjectPools& pools)
+{
+	ObjectPool<MapThing>::free(ptr);
+}
+
 // -----------------------------------------------------------------------------
 // MapThing class constructor
 // -----------------------------------------------------------------------------
@@ -422,31 +456,33 @@ void MapThing::readBackup(Backup* backup)
 }
 
 // -----------------------------------------------------------------------------
-// Writes the thing as a UDMF text definition to [def]
+// Writes the thing as a UDMF text definition, appending it to [def]
 // -----------------------------------------------------------------------------
 void MapThing::writeUDMF(string& def)
 {
-	def = fmt::format("thing//#{}\n{{\n", index_);
+	auto out = std::back_inserter(def);
+
+	fmt::format_to(out, "thing//#{}\n{{\n", index_);
 
 	// Basic properties
-	def += fmt::format("x={:1.3f};\ny={:1.3f};\ntype={};\n", position_.x, position_.y, type_);
+	fmt::format_to(out, "x={:1.3f};\ny={:1.3f};\ntype={};\n", position_.x, position_.y, type_);
 	if (z_ != 0)
-		def += fmt::format("height={:1.3f};\n", z_);
+		fmt::format_to(out, "height={:1.3f};\n", z_);
 	if (angle_ != 0)
-		def += fmt::format("angle={};\n", angle_);
+		fmt::format_to(out, "angle={};\n", angle_);
 	if (flags_ != 0)
-		def += fmt::format("flags={};\n", flags_);
+		fmt::format_to(out, "flags={};\n", flags_);
 	if (id_ != 0)
-		def += fmt::format("id={};\n", id_);
+		fmt::format_to(out, "id={};\n", id_);
 	for (unsigned i = 0; i < 5; ++i)
 		if (args_[i] != 0)
-			def += fmt::format("arg{}={};\n", i, args_[i]);
+			fmt::format_to(out, "arg{}={};\n", i, args_[i]);
 	if (special_ != 0)
-		def += fmt::format("special={};\n", special_);
+		fmt::format_to(out, "special={};\n", special_);
 
 	// Other properties
 	if (!properties_.empty())
-		def += properties_.toString(true, 3);
+		properties_.write(def, true, 3);
 
 	def += "}\n\n";
 }
@@ -35,6 +35,13 @@ public:
 	MapThing(const Vec3d& pos, short type, ParseTreeNode* def);
 	~MapThing() = default;
 
+	// Allocated from a map's object pools when created with new (pools),
+	// otherwise from the heap
+	static void* operator new(size_t size);
+	static void* operator new(size_t size, MapObjectPools& pools);
+	static void  operator delete(void* ptr);
+	static void  operator delete(void* ptr, MapObjectPools& pools);
+
 	double        xPos() const { return position_.x; }
 	double        yPos() const { return position_.y; }
 	double        zPos() const { return z_; }
@@ -31,6 +31,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "MapVertex.h"
+#include "SLADEMap/MapObjectPools.h"
 #include "SLADEMap/SLADEMap.h"
 #include "Utility/Parser.h"
 
@@ -44,6 +45,39 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 
 
+// -----------------------------------------------------------------------------
+// Allocates memory for a new MapVertex from the heap (see ObjectPool)
+// -----------------------------------------------------------------------------
+void* MapVertex::operator new(size_t size)
+{
+	return ObjectPool<MapVertex>::allocate(size);
+}
+
+// -----------------------------------------------------------------------------
+// Allocates memory for a new MapVertex from the vertex pool in [pools]
+// -----------------------------------------------------------------------------
+void* MapVertex::operator new(size_t size, MapObjectPools& pools)
+{
+	return ObjectPool<MapVertex>::allocate(size, &pools.vertices);
+}
+
+// -----------------------------------------------------------------------------
+// Frees memory for a deleted MapVertex, returning it to the pool it was
+// allocated from
+// -----------------------------------------------------------------------------
+void MapVertex::operator delete(void* ptr)
+{
+	ObjectPool<MapVertex>::free(ptr);
+}
+
+// -----------------------------------------------------------------------------
+// Frees memory for a MapVertex allocated from [pools] if its constructor throws
+// -----------------------------------------------------------------------------
+void MapVertex::operator delete(void* ptr, MapObjectPools& pools)
+{
+	ObjectPool<MapVertex>::free(ptr);
+}
+
 // -----------------------------------------------------------------------------
 // MapVertex class constructor
 // -----------------------------------------------------------------------------
@@ -226,18 +260,20 @@ void MapVertex::readBackup(Backup* backup)
 }
 
 // -----------------------------------------------------------------------------
-// Writes the vertex as a UDMF text definition to [def]
+// Writes the vertex as a UDMF text definition, appending it to [def]
 // -----------------------------------------------------------------------------
 void MapVertex::writeUDMF(string& def)
 {
-	def = fmt::format("vertex//#{}\n{{\n", index_);
+	auto out = std::back_inserter(def);
+
+	fmt::format_to(out, "vertex//#{}\n{{\n", index_);
 
 	// Basic properties
-	def += fmt::format("x={:1.3f};\ny={:1.3f};\n", position_.x, position_.y);
+	fmt::format_to(out, "x={:1.3f};\ny={:1.3f};\n", position_.x, position_.y);
 
 	// Other properties
 	if (!properties_.empty())
-		def += properties_.toString(true, 3);
+		properties_.write(def, true, 3);
 
 	def += "}\n\n";
 }
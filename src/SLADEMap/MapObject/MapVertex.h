@@ -19,6 +19,13 @@ public:
 	MapVertex(const Vec2d& pos, ParseTreeNode* udmf_def);
 	~MapVertex() = default;
 
+	// Allocated from a map's object pools when created with new (pools),
+	// otherwise from the heap
+	static void* operator new(size_t size);
+	static void* operator new(size_t size, MapObjectPools& pools);
+	static void  operator delete(void* ptr);
+	static void  operator delete(void* ptr, MapObjectPools& pools);
+
 	double xPos() const { return position_.x; }
 	double yPos() const { return position_.y; }
 	Vec2d  position() const { return position_; }
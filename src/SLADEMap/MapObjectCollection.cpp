@@ -478,6 +478,42 @@ bool MapObjectCollection::removeThing(unsigned index)
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Preallocates space for [count] more objects of [type], for use when the
+// number of objects about to be added is known in advance (eg. map loading).
+// The objects themselves are then allocated from a single contiguous block of
+// this collection's pool for [type]
+// -----------------------------------------------------------------------------
+void MapObjectCollection::reserve(MapObject::Type type, unsigned count)
+{
+	objects_.reserve(objects_.size() + count);
+
+	switch (type)
+	{
+	case MapObject::Type::Vertex:
+		vertices_.reserve(vertices_.size() + count);
+		pools_.vertices.reserve(count);
+		break;
+	case MapObject::Type::Line:
+		lines_.reserve(lines_.size() + count);
+		pools_.lines.reserve(count);
+		break;
+	case MapObject::Type::Side:
+		sides_.reserve(sides_.size() + count);
+		pools_.sides.reserve(count);
+		break;
+	case MapObject::Type::Sector:
+		sectors_.reserve(sectors_.size() + count);
+		pools_.sectors.reserve(count);
+		break;
+	case MapObject::Type::Thing:
+		things_.reserve(things_.size() + count);
+		pools_.things.reserve(count);
+		break;
+	default: break;
+	}
+}
+
 // -----------------------------------------------------------------------------
 // Adds [vertex] to the map
 // -----------------------------------------------------------------------------
@@ -541,7 +577,7 @@ MapSide* MapObjectCollection::duplicateSide(MapSide* side)
 	if (!side)
 		return nullptr;
 
-	auto ns = std::make_unique<MapSide>(side->sector());
+	auto ns = create<MapSide>(side->sector());
 	ns->copy(side);
 	addSide(std::move(ns));
 	return sides_.back();
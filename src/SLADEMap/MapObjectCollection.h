@@ -6,6 +6,7 @@
 #include "MapObjectList/SideList.h"
 #include "MapObjectList/ThingList.h"
 #include "MapObjectList/VertexList.h"
+#include "MapObjectPools.h"
 
 namespace slade
 {
@@ -38,7 +39,14 @@ public:
 	void refreshIndices();
 	void clear();
 
+	// Object create (allocated from this collection's pools, see MapObjectPools)
+	template<typename T, typename... Args> unique_ptr<T> create(Args&&... args)
+	{
+		return unique_ptr<T>(new (pools_) T(std::forward<Args>(args)...));
+	}
+
 	// Object add
+	void       reserve(MapObject::Type type, unsigned count);
 	MapVertex* addVertex(unique_ptr<MapVertex> vertex);
 	MapSide*   addSide(unique_ptr<MapSide> side);
 	MapLine*   addLine(unique_ptr<MapLine> line);
@@ -87,6 +95,7 @@ private:
 	};
 
 	SLADEMap*               parent_map_ = nullptr;
+	MapObjectPools          pools_; // Must be destroyed after objects_
 	vector<MapObjectHolder> objects_;
 	VertexList              vertices_;
 	SideList                sides_;
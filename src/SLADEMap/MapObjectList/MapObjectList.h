@@ -29,6 +29,7 @@ public:
 	}
 	T*   back() { return objects_.back(); }
 	bool empty() const { return count_ == 0; }
+	void reserve(unsigned size) { objects_.reserve(size); }
 
 	// Access
 	const vector<T*>& all() const { return objects_; }
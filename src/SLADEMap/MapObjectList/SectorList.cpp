@@ -33,8 +33,10 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "SectorList.h"
+#include "General/Trace.h"
 #include "General/UI.h"
 #include "Utility/StringUtils.h"
+#include "Utility/ThreadPool.h"
 
 using namespace slade;
 
@@ -52,6 +54,10 @@ using namespace slade;
 void SectorList::clear()
 {
 	usage_tex_.clear();
+	grid_cells_.clear();
+	grid_ranges_.clear();
+	grid_changed_.clear();
+	grid_valid_ = false;
 	MapObjectList::clear();
 }
 
@@ -65,6 +71,9 @@ void SectorList::add(MapSector* sector)
 	usage_tex_[strutil::upper(sector->ceiling().texture)] += 1;
 
 	MapObjectList::add(sector);
+
+	// Add to point lookup grid
+	sectorGeometryChanged(sector);
 }
 
 // -----------------------------------------------------------------------------
@@ -79,24 +88,39 @@ void SectorList::remove(unsigned index)
 	usage_tex_[strutil::upper(objects_[index]->floor().texture)] -= 1;
 	usage_tex_[strutil::upper(objects_[index]->ceiling().texture)] -= 1;
 
+	// Remove from point lookup grid
+	if (grid_valid_)
+	{
+		gridRemove(objects_[index]);
+		grid_changed_.erase(
+			std::remove(grid_changed_.begin(), grid_changed_.end(), objects_[index]), grid_changed_.end());
+	}
+
 	MapObjectList::remove(index);
 }
 
 // -----------------------------------------------------------------------------
-// Returns the sector at the given [point], or null if not within a sector
+// Returns the sector at the given [point], or null if not within a sector.
+// If multiple sectors contain the point, the one with the lowest index is
+// returned
 // -----------------------------------------------------------------------------
 MapSector* SectorList::atPos(Vec2d point) const
 {
-	// Go through sectors
-	for (const auto& sector : objects_)
-	{
-		// Check if point is within sector
-		if (sector->containsPoint(point))
-			return sector;
-	}
+	updateGrid();
 
-	// Not within a sector
-	return nullptr;
+	// Get grid cell containing the point
+	auto x = static_cast<int>(std::floor((point.x - grid_origin_.x) / grid_cell_size_));
+	auto y = static_cast<int>(std::floor((point.y - grid_origin_.y) / grid_cell_size_));
+	if (x < 0 || y < 0 || x >= grid_width_ || y >= grid_height_)
+		return nullptr;
+
+	// Check sectors overlapping the cell
+	MapSector* found = nullptr;
+	for (auto* sector : grid_cells_[y * grid_width_ + x])
+		if ((!found || sector->index() < found->index()) && sector->containsPoint(point))
+			found = sector;
+
+	return found;
 }
 
 // -----------------------------------------------------------------------------
@@ -130,16 +154,24 @@ BBox SectorList::allSectorBounds() const
 }
 
 // -----------------------------------------------------------------------------
-// Forces building of polygons for all sectors in the list
+// Forces building of polygons for all sectors in the list.
+// Sector polygons are independent of each other so they are built in parallel
+// on worker threads, in batches so that splash progress can be updated
 // -----------------------------------------------------------------------------
 void SectorList::initPolygons()
 {
+	TRACE_ZONE("SectorList::initPolygons");
+
+	constexpr unsigned batch_size = 4096;
+
 	ui::setSplashProgressMessage("Building sector polygons");
 	ui::setSplashProgress(0.0f);
-	for (unsigned i = 0; i < count_; ++i)
+	for (unsigned start = 0; start < count_; start += batch_size)
 	{
-		ui::setSplashProgress((float)i / (float)count_);
-		objects_[i]->polygon();
+		ui::setSplashProgress((float)start / (float)count_);
+
+		auto count = std::min(batch_size, count_ - start);
+		threadpool::parallelFor(count, [this, start](size_t i) { objects_[start + i]->polygon(); }, 16);
 	}
 	ui::setSplashProgress(1.0f);
 }
@@ -218,3 +250,148 @@ int SectorList::texUsageCount(string_view tex) const
 {
 	return usage_tex_[strutil::upper(tex)];
 }
+
+// -----------------------------------------------------------------------------
+// Called when the geometry (bbox) of [sector] has changed, so that it is
+// moved to the correct point lookup grid cells before the next lookup
+// -----------------------------------------------------------------------------
+void SectorList::sectorGeometryChanged(MapSector* sector) const
+{
+	if (!grid_valid_)
+		return;
+
+	// Just rebuild the grid on the next lookup if lots of sectors have changed
+	if (grid_changed_.size() >= count_)
+	{
+		grid_valid_ = false;
+		grid_changed_.clear();
+		return;
+	}
+
+	grid_changed_.push_back(sector);
+}
+
+// -----------------------------------------------------------------------------
+// (Re)builds the point lookup grid for all sectors in the list
+// -----------------------------------------------------------------------------
+void SectorList::buildGrid() const
+{
+	TRACE_ZONE("SectorList::buildGrid");
+
+	grid_cells_.clear();
+	grid_ranges_.clear();
+	grid_changed_.clear();
+	grid_width_  = 0;
+	grid_height_ = 0;
+	grid_valid_  = true;
+
+	// Get bounds of all sectors
+	bool  first = true;
+	Vec2d min, max;
+	for (auto* sector : objects_)
+	{
+		if (sector->connectedSides().empty())
+			continue;
+
+		auto bbox = sector->boundingBox();
+		if (first)
+		{
+			min   = bbox.min;
+			max   = bbox.max;
+			first = false;
+			continue;
+		}
+		min.x = std::min(min.x, bbox.min.x);
+		min.y = std::min(min.y, bbox.min.y);
+		max.x = std::max(max.x, bbox.max.x);
+		max.y = std::max(max.y, bbox.max.y);
+	}
+	if (first)
+		return;
+
+	// Size cells to give roughly one per sector, with at most 1024x1024 cells
+	auto width      = max.x - min.x;
+	auto height     = max.y - min.y;
+	grid_cell_size_ = std::max(std::sqrt(width * height / count_), 64.);
+	grid_cell_size_ = std::max({ grid_cell_size_, width / 1024., height / 1024. });
+	grid_origin_    = min;
+	grid_width_     = static_cast<int>(width / grid_cell_size_) + 1;
+	grid_height_    = static_cast<int>(height / grid_cell_size_) + 1;
+	grid_cells_.resize(grid_width_ * grid_height_);
+
+	// Add sectors
+	for (auto* sector : objects_)
+		gridAdd(sector);
+}
+
+// -----------------------------------------------------------------------------
+// Updates the point lookup grid for sectors that have changed since the last
+// lookup, building it first if needed. The grid is rebuilt if a sector now
+// extends outside of it
+// -----------------------------------------------------------------------------
+void SectorList::updateGrid() const
+{
+	if (!grid_valid_)
+	{
+		buildGrid();
+		return;
+	}
+
+	for (auto* sector : grid_changed_)
+	{
+		gridRemove(sector);
+		if (!gridAdd(sector))
+		{
+			buildGrid();
+			return;
+		}
+	}
+
+	grid_changed_.clear();
+}
+
+// -----------------------------------------------------------------------------
+// Adds [sector] to all point lookup grid cells its bbox overlaps.
+// Returns false if the sector is outside the grid
+// -----------------------------------------------------------------------------
+bool SectorList::gridAdd(MapSector* sector) const
+{
+	// Ignore sectors with no lines, or that are no longer in the list
+	if (sector->connectedSides().empty() || sector->index() >= count_ || objects_[sector->index()] != sector)
+		return true;
+
+	auto      bbox = sector->boundingBox();
+	CellRange range{ static_cast<int>(std::floor((bbox.min.x - grid_origin_.x) / grid_cell_size_)),
+					 static_cast<int>(std::floor((bbox.min.y - grid_origin_.y) / grid_cell_size_)),
+					 static_cast<int>(std::floor((bbox.max.x - grid_origin_.x) / grid_cell_size_)),
+					 static_cast<int>(std::floor((bbox.max.y - grid_origin_.y) / grid_cell_size_)) };
+	if (range.x1 < 0 || range.y1 < 0 || range.x2 >= grid_width_ || range.y2 >= grid_height_)
+		return false;
+
+	for (int y = range.y1; y <= range.y2; ++y)
+		for (int x = range.x1; x <= range.x2; ++x)
+			grid_cells_[y * grid_width_ + x].push_back(sector);
+
+	grid_ranges_[sector] = range;
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Removes [sector] from the point lookup grid
+// -----------------------------------------------------------------------------
+void SectorList::gridRemove(const MapSector* sector) const
+{
+	auto i = grid_ranges_.find(sector);
+	if (i == grid_ranges_.end())
+		return;
+
+	auto& range = i->second;
+	for (int y = range.y1; y <= range.y2; ++y)
+		for (int x = range.x1; x <= range.x2; ++x)
+		{
+			auto& cell = grid_cells_[y * grid_width_ + x];
+			cell.erase(std::remove(cell.begin(), cell.end(), sector), cell.end());
+		}
+
+	grid_ranges_.erase(i);
+}
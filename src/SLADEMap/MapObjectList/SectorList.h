@@ -26,7 +26,31 @@ public:
 	void updateTexUsage(string_view tex, int adjust) const;
 	int  texUsageCount(string_view tex) const;
 
+	void sectorGeometryChanged(MapSector* sector) const;
+
 private:
-	mutable std::map<string, int> usage_tex_;
+	struct CellRange
+	{
+		int x1, y1, x2, y2;
+	};
+
+	mutable std::unordered_map<string, int> usage_tex_;
+
+	// Grid of sectors overlapping each cell (by bbox) for atPos lookups.
+	// Built on first lookup, then sectors with changed geometry are moved
+	// to their new cells before the next lookup
+	mutable vector<vector<MapSector*>>                      grid_cells_;
+	mutable std::unordered_map<const MapSector*, CellRange> grid_ranges_;
+	mutable vector<MapSector*>                              grid_changed_;
+	mutable Vec2d                                           grid_origin_;
+	mutable double                                          grid_cell_size_ = 1.;
+	mutable int                                             grid_width_     = 0;
+	mutable int                                             grid_height_    = 0;
+	mutable bool                                            grid_valid_     = false;
+
+	void buildGrid() const;
+	void updateGrid() const;
+	bool gridAdd(MapSector* sector) const;
+	void gridRemove(const MapSector* sector) const;
 };
 } // namespace slade
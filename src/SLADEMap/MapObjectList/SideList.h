@@ -18,6 +18,6 @@ public:
 	int  texUsageCount(string_view tex) const;
 
 private:
-	mutable std::map<string, int> usage_tex_;
+	mutable std::unordered_map<string, int> usage_tex_;
 };
 } // namespace slade
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "Utility/ObjectPool.h"
+
+namespace slade
+{
+class MapVertex;
+class MapSide;
+class MapLine;
+class MapSector;
+class MapThing;
+
+// The pools a map's objects are allocated from, one per object type. Each
+// MapObjectCollection has its own, so objects of different maps don't share
+// (or fragment) the same memory, and all of a map's memory is released when
+// its objects are cleared
+struct MapObjectPools
+{
+	ObjectPool<MapVertex> vertices;
+	ObjectPool<MapSide>   sides;
+	ObjectPool<MapLine>   lines;
+	ObjectPool<MapSector> sectors;
+	ObjectPool<MapThing>  things;
+};
+} // namespace slade
@@ -33,6 +33,7 @@
 #include "Main.h"
 #include "MapSpecials.h"
 #include "Game/Configuration.h"
+#include "General/Trace.h"
 #include "SLADEMap.h"
 #include "Utility/MathStuff.h"
 #include "Utility/Tokenizer.h"
@@ -77,6 +78,8 @@ void MapSpecials::reset()
 // -----------------------------------------------------------------------------
 void MapSpecials::processMapSpecials(SLADEMap* map)
 {
+	TRACE_ZONE("MapSpecials::processMapSpecials");
+
 
 	// Clear out all 3D floors, or every call to this function will create duplicates!
 	// TODO this isn't a very good solution, but we don't have incremental updates yet
@@ -223,6 +226,8 @@ bool MapSpecials::translucentLineAdditive(const MapLine* line) const
 // -----------------------------------------------------------------------------
 void MapSpecials::updateTaggedSectors(const SLADEMap* map) const
 {
+	TRACE_ZONE("MapSpecials::updateTaggedSectors");
+
 	// scripts
 	unsigned a;
 	for (a = 0; a < sector_colours_.size(); a++)
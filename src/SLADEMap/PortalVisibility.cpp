@@ -0,0 +1,249 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2022 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    PortalVisibility.cpp
+// Description: PortalVisibility class - determines the sectors potentially
+//              visible from a viewpoint by flood filling through portals
+//              (two-sided lines) between sectors
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "PortalVisibility.h"
+#include "General/Trace.h"
+#include "SLADEMap/SLADEMap.h"
+#include "Utility/MathStuff.h"
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns true if the opening between sectors [s1] and [s2] is closed (eg. a
+// closed door). Sloped planes are always considered open
+// -----------------------------------------------------------------------------
+bool portalClosed(const MapSector* s1, const MapSector* s2)
+{
+	for (auto* sector : { s1, s2 })
+		if (sector->floor().plane.a != 0. || sector->floor().plane.b != 0. || sector->ceiling().plane.a != 0.
+			|| sector->ceiling().plane.b != 0.)
+			return false;
+
+	return std::max(s1->floor().height, s2->floor().height) >= std::min(s1->ceiling().height, s2->ceiling().height);
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// PortalVisibility Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Determines the sectors in [map] potentially visible from [view].
+// Returns false if the viewpoint isn't within a sector, in which case nothing
+// is considered visible
+// -----------------------------------------------------------------------------
+bool PortalVisibility::compute(const SLADEMap& map, const View& view)
+{
+	TRACE_ZONE("PortalVisibility::compute");
+
+	clear();
+	visible_.assign(map.nSectors(), 0);
+	windows_.assign(map.nSectors(), {});
+
+	// Start from the sector containing the viewpoint
+	auto start = map.sectors().atPos(view.position);
+	if (!start)
+		return false;
+
+	view_angle_ = std::atan2(view.direction.y, view.direction.x);
+	if (view.half_angle >= 0. && view.half_angle < math::PI)
+		visit(start, { -view.half_angle, view.half_angle });
+	else
+		visit(start, { -math::PI, math::PI });
+
+	while (!to_visit_.empty())
+	{
+		auto current = to_visit_.back();
+		to_visit_.pop_back();
+
+		// Check all portals out of the sector
+		for (auto* side : current.sector->connectedSides())
+		{
+			auto line  = side->parentLine();
+			auto front = line->s1() == side;
+			auto other = front ? line->backSector() : line->frontSector();
+			if (!other || other == current.sector || portalClosed(current.sector, other))
+				continue;
+
+			// Check distance
+			auto dist = math::distanceToLine(view.position, line->seg());
+			if (view.max_dist > 0. && dist > view.max_dist)
+				continue;
+
+			// If the viewpoint is (almost) on the portal, just carry on through
+			// it with the same window
+			if (dist < 1.)
+			{
+				portals_.push_back(line->index());
+				visit(other, current.window);
+				continue;
+			}
+
+			// Ignore if the portal is facing away from the viewpoint
+			auto side_of = math::lineSide(view.position, line->seg());
+			if (front ? side_of <= 0. : side_of >= 0.)
+				continue;
+
+			// Get the range of angles the portal covers, split in two if it
+			// crosses the angle directly behind the view direction
+			auto   a1        = relativeAngle(view, line->start());
+			auto   a2        = relativeAngle(view, line->end());
+			Window ranges[2] = { { std::min(a1, a2), std::max(a1, a2) }, {} };
+			if (ranges[0].max - ranges[0].min > math::PI)
+			{
+				ranges[1] = { -math::PI, ranges[0].min };
+				ranges[0] = { ranges[0].max, math::PI };
+			}
+
+			// Continue into the other sector through the part of the portal
+			// within the current window
+			bool through = false;
+			for (const auto& range : ranges)
+			{
+				Window clipped{ std::max(range.min, current.window.min), std::min(range.max, current.window.max) };
+				if (range.empty() || clipped.empty())
+					continue;
+
+				visit(other, clipped);
+				through = true;
+			}
+			if (through)
+				portals_.push_back(line->index());
+		}
+	}
+
+	valid_ = true;
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Clears the current visibility info
+// -----------------------------------------------------------------------------
+void PortalVisibility::clear()
+{
+	visible_.clear();
+	windows_.clear();
+	to_visit_.clear();
+	portals_.clear();
+	n_visible_ = 0;
+	valid_     = false;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the sector at [index] was found to be potentially visible
+// -----------------------------------------------------------------------------
+bool PortalVisibility::sectorVisible(unsigned index) const
+{
+	return index < visible_.size() && visible_[index];
+}
+
+// -----------------------------------------------------------------------------
+// Returns the angle from the view direction to [point] (-PI to PI)
+// -----------------------------------------------------------------------------
+double PortalVisibility::relativeAngle(const View& view, Vec2d point) const
+{
+	auto angle = std::atan2(point.y - view.position.y, point.x - view.position.x) - view_angle_;
+	if (angle > math::PI)
+		angle -= 2. * math::PI;
+	else if (angle <= -math::PI)
+		angle += 2. * math::PI;
+
+	return angle;
+}
+
+// -----------------------------------------------------------------------------
+// Marks [sector] as visible and queues it to check its portals, unless it has
+// already been visited with a [window] covering this one. Windows for a sector
+// are merged, which may make it see slightly more than it really can
+// -----------------------------------------------------------------------------
+void PortalVisibility::visit(MapSector* sector, const Window& window)
+{
+	auto index = sector->index();
+	if (index >= windows_.size())
+		return;
+
+	auto& current = windows_[index];
+	if (!current.empty() && current.contains(window))
+		return;
+
+	if (!visible_[index])
+	{
+		visible_[index] = 1;
+		++n_visible_;
+	}
+
+	if (current.empty())
+		current = window;
+	else
+		current = { std::min(current.min, window.min), std::max(current.max, window.max) };
+
+	to_visit_.push_back({ sector, current });
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// PortalVisibility Class Static Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns the half-angle of the horizontal view wedge (in radians) for a
+// camera with [fov_h] horizontal and [fov_v] vertical fields of view, pitched
+// up or down by [pitch] (all in radians). When pitched, the corners of the
+// view frustum spread wider horizontally, up to all directions (PI)
+// -----------------------------------------------------------------------------
+double PortalVisibility::viewHalfAngle(double fov_h, double fov_v, double pitch)
+{
+	auto tan_h = std::tan(fov_h * 0.5);
+	auto tan_v = std::tan(fov_v * 0.5);
+	auto along = std::cos(pitch) - std::abs(std::sin(pitch)) * tan_v;
+	if (along <= 0.)
+		return math::PI;
+
+	return std::min(math::PI, std::atan2(tan_h, along));
+}
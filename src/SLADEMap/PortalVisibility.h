@@ -0,0 +1,63 @@
+#pragma once
+
+namespace slade
+{
+class MapSector;
+class SLADEMap;
+
+// Determines the sectors potentially visible from a viewpoint, by flood
+// filling from the viewpoint's sector through 'portals' (two-sided lines that
+// aren't closed off) while narrowing the horizontal view wedge to each
+// portal's extent. Doesn't depend on OpenGL, so can be used headless
+class PortalVisibility
+{
+public:
+	struct View
+	{
+		Vec2d  position;
+		Vec2d  direction  = { 0., 1. };
+		double half_angle = -1.; // Half-angle of the view wedge in radians (< 0 for all directions)
+		double max_dist   = 0.;  // Ignore portals further away than this (0 = no limit)
+	};
+
+	PortalVisibility()  = default;
+	~PortalVisibility() = default;
+
+	bool                    isValid() const { return valid_; }
+	unsigned                nVisibleSectors() const { return n_visible_; }
+	const vector<unsigned>& portals() const { return portals_; }
+
+	bool compute(const SLADEMap& map, const View& view);
+	void clear();
+	bool sectorVisible(unsigned index) const;
+
+	static double viewHalfAngle(double fov_h, double fov_v, double pitch);
+
+private:
+	// Range of angles relative to the view direction
+	struct Window
+	{
+		double min = 1.;
+		double max = -1.;
+
+		bool empty() const { return min > max; }
+		bool contains(const Window& other) const { return other.min >= min && other.max <= max; }
+	};
+	struct Visit
+	{
+		MapSector* sector;
+		Window     window;
+	};
+
+	vector<uint8_t>  visible_;
+	vector<Window>   windows_;
+	vector<Visit>    to_visit_;
+	vector<unsigned> portals_; // Indices of lines that were looked through
+	unsigned         n_visible_  = 0;
+	bool             valid_      = false;
+	double           view_angle_ = 0.;
+
+	double relativeAngle(const View& view, Vec2d point) const;
+	void   visit(MapSector* sector, const Window& window);
+};
+} // namespace slade
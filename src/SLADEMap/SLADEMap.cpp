@@ -34,6 +34,7 @@
 #include "App.h"
 #include "Archive/Formats/WadArchive.h"
 #include "Game/Configuration.h"
+#include "General/Trace.h"
 #include "MapEditor/SectorBuilder.h"
 #include "MapFormat/MapFormatHandler.h"
 #include "Utility/MathStuff.h"
@@ -49,6 +50,34 @@ using namespace slade;
 CVAR(Bool, map_split_auto_offset, true, CVar::Flag::Save)
 
 
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns true if [point] is within the box [min]-[max]
+// -----------------------------------------------------------------------------
+bool pointInBox(const Vec2d& point, const Vec2d& min, const Vec2d& max)
+{
+	return point.x >= min.x && point.x <= max.x && point.y >= min.y && point.y <= max.y;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the bounding box of [line] overlaps the box [min]-[max]
+// -----------------------------------------------------------------------------
+bool lineInBox(const MapLine* line, const Vec2d& min, const Vec2d& max)
+{
+	auto p1 = line->start();
+	auto p2 = line->end();
+	return std::max(p1.x, p2.x) >= min.x && std::min(p1.x, p2.x) <= max.x && std::max(p1.y, p2.y) >= min.y
+		   && std::min(p1.y, p2.y) <= max.y;
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // SLADEMap Class Functions
@@ -110,6 +139,8 @@ void SLADEMap::setThingsUpdated()
 // -----------------------------------------------------------------------------
 bool SLADEMap::readMap(const Archive::MapDesc& map)
 {
+	TRACE_ZONE("SLADEMap::readMap");
+
 	auto omap = map;
 
 	// Check for map archive
@@ -503,6 +534,8 @@ void SLADEMap::recomputeSpecials()
 // -----------------------------------------------------------------------------
 bool SLADEMap::writeMap(vector<ArchiveEntry*>& map_entries) const
 {
+	TRACE_ZONE("SLADEMap::writeMap");
+
 	// Get format handler
 	auto handler = MapFormatHandler::get(current_format_);
 	handler->setUDMFNamespace(udmf_namespace_);
@@ -541,7 +574,7 @@ MapVertex* SLADEMap::createVertex(Vec2d pos, double split_dist)
 		return overlap;
 
 	// Create the vertex
-	auto* nv = data_.addVertex(std::make_unique<MapVertex>(pos));
+	auto* nv = data_.addVertex(data_.create<MapVertex>(pos));
 
 	// Check if this vertex splits any lines (if needed)
 	if (split_dist >= 0)
@@ -616,7 +649,7 @@ MapLine* SLADEMap::createLine(MapVertex* vertex1, MapVertex* vertex2, bool force
 			return existing;
 
 	// Create new line between vertices
-	auto* nl = data_.addLine(std::make_unique<MapLine>(vertex1, vertex2, nullptr, nullptr));
+	auto* nl = data_.addLine(data_.create<MapLine>(vertex1, vertex2, nullptr, nullptr));
 
 	// Connect line to vertices
 	vertex1->connectLine(nl);
@@ -634,7 +667,7 @@ MapLine* SLADEMap::createLine(MapVertex* vertex1, MapVertex* vertex2, bool force
 MapThing* SLADEMap::createThing(Vec2d pos, int type)
 {
 	// Create the thing
-	return data_.addThing(std::make_unique<MapThing>(pos, type));
+	return data_.addThing(data_.create<MapThing>(pos, type));
 }
 
 // -----------------------------------------------------------------------------
@@ -642,7 +675,7 @@ MapThing* SLADEMap::createThing(Vec2d pos, int type)
 // -----------------------------------------------------------------------------
 MapSector* SLADEMap::createSector()
 {
-	return data_.addSector(std::make_unique<MapSector>());
+	return data_.addSector(data_.create<MapSector>());
 }
 
 // -----------------------------------------------------------------------------
@@ -654,7 +687,7 @@ MapSide* SLADEMap::createSide(MapSector* sector)
 	if (!sector)
 		return nullptr;
 
-	return data_.addSide(std::make_unique<MapSide>(sector));
+	return data_.addSide(data_.create<MapSide>(sector));
 }
 
 // -----------------------------------------------------------------------------
@@ -712,34 +745,50 @@ void SLADEMap::mergeVertices(unsigned vertex1, unsigned vertex2)
 }
 
 // -----------------------------------------------------------------------------
-// Merges all vertices at [x,1] and returns the resulting single vertex
+// Merges all vertices at [pos] and returns the resulting single vertex
 // -----------------------------------------------------------------------------
 MapVertex* SLADEMap::mergeVerticesPoint(const Vec2d& pos)
 {
-	// Go through all vertices
-	int merge = -1;
-	for (unsigned a = 0; a < vertices().size(); a++)
+	// Get all vertices on the point
+	vector<MapVertex*> at_pos;
+	for (auto* vertex : vertices())
+		if (vertex->position_.x == pos.x && vertex->position_.y == pos.y)
+			at_pos.push_back(vertex);
+
+	return mergeVerticesPoint(pos, at_pos);
+}
+
+// -----------------------------------------------------------------------------
+// Merges all vertices in [candidates] at [pos] and returns the resulting single
+// vertex. Any vertices removed by merging are also removed from [candidates]
+// -----------------------------------------------------------------------------
+MapVertex* SLADEMap::mergeVerticesPoint(const Vec2d& pos, vector<MapVertex*>& candidates)
+{
+	MapVertex* merge = nullptr;
+	for (unsigned a = 0; a < candidates.size(); a++)
 	{
 		// Skip if vertex isn't on the point
-		if (vertex(a)->position_.x != pos.x || vertex(a)->position_.y != pos.y)
+		auto* vertex = candidates[a];
+		if (vertex->position_.x != pos.x || vertex->position_.y != pos.y)
 			continue;
 
 		// Set as the merge target vertex if we don't have one already
-		if (merge < 0)
+		if (!merge)
 		{
-			merge = a;
+			merge = vertex;
 			continue;
 		}
 
 		// Otherwise, merge this vertex with the merge target
-		mergeVertices(merge, a);
+		mergeVertices(merge->index_, vertex->index_);
+		candidates.erase(candidates.begin() + a);
 		a--;
 	}
 
 	geometry_updated_ = app::runTimer();
 
 	// Return the final merged vertex
-	return vertex(merge);
+	return merge;
 }
 
 // -----------------------------------------------------------------------------
@@ -781,7 +830,7 @@ MapLine* SLADEMap::splitLine(MapLine* line, MapVertex* vertex)
 	}
 
 	// Create and add new line
-	auto* nl = data_.addLine(std::make_unique<MapLine>(vertex, v2, s1, s2));
+	auto* nl = data_.addLine(data_.create<MapLine>(vertex, v2, s1, s2));
 	nl->copy(line);
 	nl->setModified();
 
@@ -803,12 +852,29 @@ MapLine* SLADEMap::splitLine(MapLine* line, MapVertex* vertex)
 // Splits any lines within [split_dist] from [vertex]
 // -----------------------------------------------------------------------------
 void SLADEMap::splitLinesAt(MapVertex* vertex, double split_dist)
+{
+	// Get lines near enough to the vertex to be split by it
+	Vec2d            min{ vertex->position_.x - split_dist, vertex->position_.y - split_dist };
+	Vec2d            max{ vertex->position_.x + split_dist, vertex->position_.y + split_dist };
+	vector<MapLine*> near_lines;
+	for (auto* line : lines())
+		if (lineInBox(line, min, max))
+			near_lines.push_back(line);
+
+	splitLinesAt(vertex, split_dist, near_lines);
+}
+
+// -----------------------------------------------------------------------------
+// Splits any lines in [candidates] within [split_dist] from [vertex]. Any new
+// lines created by splitting are added to [candidates]
+// -----------------------------------------------------------------------------
+void SLADEMap::splitLinesAt(MapVertex* vertex, double split_dist, vector<MapLine*>& candidates)
 {
 	// Check if this vertex splits any lines (if needed)
-	const auto nlines = data_.lines().size();
+	const auto nlines = candidates.size();
 	for (unsigned i = 0; i < nlines; ++i)
 	{
-		auto* line = this->line(i);
+		auto* line = candidates[i];
 
 		// Skip line if it shares the vertex
 		if (line->v1() == vertex || line->v2() == vertex)
@@ -822,8 +888,8 @@ void SLADEMap::splitLinesAt(MapVertex* vertex, double split_dist)
 				vertex->index_,
 				vertex->position_.x,
 				vertex->position_.y,
-				i);
-			splitLine(line, vertex);
+				line->index_);
+			candidates.push_back(splitLine(line, vertex));
 		}
 	}
 }
@@ -999,10 +1065,27 @@ bool SLADEMap::mergeArch(const vector<MapVertex*>& vertices)
 	auto*          last_vertex = this->vertices().last();
 	auto*          last_line   = lines().last();
 
+	// Get vertices that could be merged with the given vertices (ie. those
+	// within their bounding box), so we don't have to check every vertex in
+	// the map for each one
+	Vec2d min = vertices.empty() ? Vec2d{} : vertices[0]->position_;
+	Vec2d max = min;
+	for (const auto* vertex : vertices)
+	{
+		min.x = std::min(min.x, vertex->position_.x);
+		min.y = std::min(min.y, vertex->position_.y);
+		max.x = std::max(max.x, vertex->position_.x);
+		max.y = std::max(max.y, vertex->position_.y);
+	}
+	vector<MapVertex*> region_vertices;
+	for (auto* vertex : this->vertices())
+		if (pointInBox(vertex->position_, min, max))
+			region_vertices.push_back(vertex);
+
 	// Merge vertices
 	vector<MapVertex*> merged_vertices;
 	for (const auto* vertex : vertices)
-		if (auto* v = mergeVerticesPoint(vertex->position_))
+		if (auto* v = mergeVerticesPoint(vertex->position_, region_vertices))
 			VECTOR_ADD_UNIQUE(merged_vertices, v);
 
 	// Get all connected lines
@@ -1011,20 +1094,52 @@ bool SLADEMap::mergeArch(const vector<MapVertex*>& vertices)
 		for (auto* connected_line : vertex->connected_lines_)
 			VECTOR_ADD_UNIQUE(connected_lines, connected_line);
 
-	// Split lines (by vertices)
+	// Get the region that can be affected by splitting: the bounding box of the
+	// merged vertices and connected lines. Only vertices and lines within it
+	// need to be checked below, so the cost depends on the size of the edit
+	// rather than the size of the map
 	constexpr double split_dist = 0.1;
+	for (const auto* vertex : merged_vertices)
+	{
+		min.x = std::min(min.x, vertex->position_.x);
+		min.y = std::min(min.y, vertex->position_.y);
+		max.x = std::max(max.x, vertex->position_.x);
+		max.y = std::max(max.y, vertex->position_.y);
+	}
+	for (const auto* line : connected_lines)
+	{
+		auto p1 = line->start();
+		auto p2 = line->end();
+		min.x   = std::min({ min.x, p1.x, p2.x });
+		min.y   = std::min({ min.y, p1.y, p2.y });
+		max.x   = std::max({ max.x, p1.x, p2.x });
+		max.y   = std::max({ max.y, p1.y, p2.y });
+	}
+	min.x -= split_dist;
+	min.y -= split_dist;
+	max.x += split_dist;
+	max.y += split_dist;
+
+	region_vertices.clear();
+	for (auto* vertex : this->vertices())
+		if (pointInBox(vertex->position_, min, max))
+			region_vertices.push_back(vertex);
+
+	vector<MapLine*> region_lines;
+	for (auto* line : lines())
+		if (lineInBox(line, min, max))
+			region_lines.push_back(line);
+
+	// Split lines (by vertices)
 	// Split existing lines that vertices moved onto
 	for (auto* merged : merged_vertices)
-		splitLinesAt(merged, split_dist);
+		splitLinesAt(merged, split_dist, region_lines);
 
 	// Split lines that moved onto existing vertices
 	for (unsigned a = 0; a < connected_lines.size(); a++)
 	{
-		const unsigned nvertices = nVertices();
-		for (unsigned b = 0; b < nvertices; b++)
+		for (auto* vertex : region_vertices)
 		{
-			auto* vertex = this->vertex(b);
-
 			// Skip line if it shares the vertex
 			if (connected_lines[a]->v1() == vertex || connected_lines[a]->v2() == vertex)
 				continue;
@@ -1032,6 +1147,7 @@ bool SLADEMap::mergeArch(const vector<MapVertex*>& vertices)
 			if (connected_lines[a]->distanceTo(vertex->position()) < split_dist)
 			{
 				connected_lines.push_back(splitLine(connected_lines[a], vertex));
+				region_lines.push_back(connected_lines.back());
 				VECTOR_ADD_UNIQUE(merged_vertices, vertex);
 			}
 		}
@@ -1044,10 +1160,9 @@ bool SLADEMap::mergeArch(const vector<MapVertex*>& vertices)
 		auto* line1 = connected_lines[a];
 		seg1        = line1->seg();
 
-		const unsigned count = nLines();
-		for (unsigned b = 0; b < count; b++)
+		for (unsigned b = 0; b < region_lines.size(); b++)
 		{
-			auto* line2 = line(b);
+			auto* line2 = region_lines[b];
 
 			// Can't intersect if they share a vertex
 			if (line1->vertex1_ == line2->vertex1_ || line1->vertex1_ == line2->vertex2_
@@ -1063,10 +1178,12 @@ bool SLADEMap::mergeArch(const vector<MapVertex*>& vertices)
 				merged_vertices.push_back(nv);
 
 				// Split lines
-				splitLine(line1, nv);
-				connected_lines.push_back(lines().last());
-				splitLine(line2, nv);
-				connected_lines.push_back(lines().last());
+				auto* split1 = splitLine(line1, nv);
+				auto* split2 = splitLine(line2, nv);
+				connected_lines.push_back(split1);
+				connected_lines.push_back(split2);
+				region_lines.push_back(split1);
+				region_lines.push_back(split2);
 
 				LOG_DEBUG("Lines", line1, "and", line2, "intersect");
 
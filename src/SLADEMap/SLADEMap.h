@@ -107,8 +107,10 @@ public:
 	// Editing
 	void       mergeVertices(unsigned vertex1, unsigned vertex2);
 	MapVertex* mergeVerticesPoint(const Vec2d& pos);
+	MapVertex* mergeVerticesPoint(const Vec2d& pos, vector<MapVertex*>& candidates);
 	MapLine*   splitLine(MapLine* line, MapVertex* vertex);
 	void       splitLinesAt(MapVertex* vertex, double split_dist = 0);
+	void       splitLinesAt(MapVertex* vertex, double split_dist, vector<MapLine*>& candidates);
 	bool       setLineSector(unsigned line_index, unsigned sector_index, bool front = true);
 	int        mergeLine(unsigned index);
 	bool       correctLineSectors(MapLine* line);
@@ -37,6 +37,7 @@
 #include "Graphics/CTexture/PatchTable.h"
 #include "Graphics/CTexture/TextureXList.h"
 #include "Graphics/Palette/Palette.h"
+#include "Graphics/SImage/BatchConvert.h"
 #include "Graphics/SImage/SIFormat.h"
 #include "Graphics/SImage/SImage.h"
 #include "Scripting/Lua.h"
@@ -771,6 +772,42 @@ sol::table getImageInfo(MemChunk& data, int index)
 		info.has_palette);
 }
 
+// -----------------------------------------------------------------------------
+// Converts the images in [entries] to [format] using [options] (on worker
+// threads), writing the results back to the entries.
+// Returns a table with info about the conversion
+// -----------------------------------------------------------------------------
+sol::table convertImages(
+	const vector<ArchiveEntry*>&    entries,
+	SIFormat*                       format,
+	const SIFormat::ConvertOptions& options,
+	Palette*                        palette)
+{
+	vector<gfx::BatchConvertItem> items;
+	items.reserve(entries.size());
+	for (auto* entry : entries)
+	{
+		auto& item         = items.emplace_back(entry);
+		item.options       = options;
+		item.write_palette = palette ? palette : options.pal_target;
+	}
+
+	auto stats = gfx::convertImages(items, format, true, true);
+	gfx::writeConvertedImages(items);
+
+	return lua::state().create_table_with(
+		"converted",
+		stats.n_done,
+		"failed",
+		stats.n_failed,
+		"bytesIn",
+		stats.bytes_in,
+		"bytesOut",
+		stats.bytes_out,
+		"seconds",
+		stats.seconds);
+}
+
 // -----------------------------------------------------------------------------
 // Registers the Graphics function namespace with lua
 // -----------------------------------------------------------------------------
@@ -796,6 +833,11 @@ void registerGraphicsNamespace(sol::state& lua)
 	};
 	gfx["DetectImageFormat"] = [](MemChunk& mc) { return SIFormat::determineFormat(mc); };
 	gfx["GetImageInfo"]      = sol::overload(&getImageInfo, [](MemChunk& data) { return getImageInfo(data, 0); });
+	gfx["ConvertImages"]     = sol::overload(
+		&convertImages,
+		[](const vector<ArchiveEntry*>& entries, SIFormat* format, const SIFormat::ConvertOptions& options) {
+			return convertImages(entries, format, options, nullptr);
+		});
 }
 
 } // namespace slade::lua
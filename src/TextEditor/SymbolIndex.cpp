@@ -0,0 +1,589 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2022 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    SymbolIndex.cpp
+// Description: SymbolIndex class - keeps an index of the symbols defined in
+//              and used by the text entries of open archives, which is
+//              updated in the background as entries change
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "SymbolIndex.h"
+#include "App.h"
+#include "Archive/Archive.h"
+#include "General/Console.h"
+#include "TextLanguage.h"
+#include "Utility/StringUtils.h"
+#include "Utility/ThreadPool.h"
+#include "Utility/Tokenizer.h"
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// Number of entries parsed by each queued worker task
+constexpr unsigned JOB_BATCH_SIZE = 32;
+
+// Number of entries read by each call to SymbolIndex::indexNext
+constexpr unsigned IDLE_BATCH_SIZE = 16;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns true if [token] looks like an identifier (starts with a letter or
+// underscore and contains only letters, digits or underscores)
+// -----------------------------------------------------------------------------
+bool isIdentifier(const string& token)
+{
+	if (token.empty() || !(isalpha(static_cast<unsigned char>(token[0])) || token[0] == '_'))
+		return false;
+
+	for (auto c : token)
+		if (!(isalnum(static_cast<unsigned char>(c)) || c == '_'))
+			return false;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Sorts [locations] by entry path and line
+// -----------------------------------------------------------------------------
+void sortLocations(vector<SymbolIndex::Location>& locations)
+{
+	std::map<const ArchiveEntry*, string> paths;
+	for (const auto& location : locations)
+		if (paths.find(location.entry) == paths.end())
+			paths[location.entry] = location.entry->path(true);
+
+	std::sort(
+		locations.begin(),
+		locations.end(),
+		[&paths](const SymbolIndex::Location& left, const SymbolIndex::Location& right)
+		{
+			if (left.entry != right.entry)
+				return paths[left.entry] < paths[right.entry];
+			return left.line < right.line;
+		});
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// SymbolIndex Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Starts tracking [archive]. Its entries are queued to be read and indexed in
+// the background (see indexNext), so opening an archive doesn't need to load
+// all of their data
+// -----------------------------------------------------------------------------
+void SymbolIndex::addArchive(Archive* archive)
+{
+	if (!archive || connections_.find(archive) != connections_.end())
+		return;
+
+	// Keep the index up to date as entries change
+	auto& connections = connections_[archive];
+	auto& signals     = archive->signals();
+	auto  update      = [this](Archive&, ArchiveEntry& entry) { updateEntry(entry); };
+	connections += signals.entry_added.connect(update);
+	connections += signals.entry_state_changed.connect(update);
+	connections += signals.entry_removed.connect(
+		[this](Archive&, ArchiveDir&, ArchiveEntry& entry) { removeEntry(&entry); });
+	connections += signals.dir_removed.connect(
+		[this](Archive& parent, ArchiveDir&, ArchiveDir& dir)
+		{
+			vector<ArchiveEntry*> entries;
+			parent.putEntryTreeAsList(entries, &dir);
+			for (auto* entry : entries)
+				removeEntry(entry);
+		});
+
+	// Queue all current entries
+	vector<ArchiveEntry*> entries;
+	archive->putEntryTreeAsList(entries);
+	auto& queue   = unindexed_.emplace_back();
+	queue.archive = archive;
+	for (auto* entry : entries)
+		queue.entries.push_back(entry->getShared());
+}
+
+// -----------------------------------------------------------------------------
+// Stops tracking [archive] and removes all of its entries from the index
+// -----------------------------------------------------------------------------
+void SymbolIndex::removeArchive(const Archive* archive)
+{
+	if (connections_.erase(archive) == 0)
+		return;
+
+	unindexed_.erase(
+		std::remove_if(
+			unindexed_.begin(), unindexed_.end(), [archive](const ArchiveQueue& q) { return q.archive == archive; }),
+		unindexed_.end());
+
+	vector<ArchiveEntry*> entries;
+	archive->putEntryTreeAsList(entries);
+
+	std::lock_guard lock(index_->mutex);
+	for (auto* entry : entries)
+	{
+		index_->entries.erase(entry);
+		index_->pending.erase(entry);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Queues [entry] to be (re)indexed, or removes it from the index if it is no
+// longer a text entry with a language that defines any symbols
+// -----------------------------------------------------------------------------
+void SymbolIndex::updateEntry(ArchiveEntry& entry)
+{
+	// Nothing to do if the index is already up to date (eg. the entry was just
+	// saved)
+	if (upToDate(entry))
+		return;
+
+	Job job;
+	if (!prepareJob(entry, job))
+	{
+		removeEntry(&entry);
+		return;
+	}
+
+	vector<Job> jobs;
+	jobs.push_back(std::move(job));
+	queueJobs(std::move(jobs));
+}
+
+// -----------------------------------------------------------------------------
+// Removes [entry] from the index, any queued indexing of it is discarded
+// -----------------------------------------------------------------------------
+void SymbolIndex::removeEntry(const ArchiveEntry* entry)
+{
+	std::lock_guard lock(index_->mutex);
+	index_->entries.erase(entry);
+	index_->pending.erase(entry);
+}
+
+// -----------------------------------------------------------------------------
+// Reads the next few entries of added archives that haven't been indexed yet,
+// and queues them to be parsed on worker threads. Entry data can only be read
+// on the main thread, so this is called when the application is idle.
+// Returns true if there are more entries to read
+// -----------------------------------------------------------------------------
+bool SymbolIndex::indexNext()
+{
+	vector<Job> jobs;
+	unsigned    n_read = 0;
+	while (!unindexed_.empty() && n_read < IDLE_BATCH_SIZE)
+	{
+		auto& queue = unindexed_.front();
+		if (queue.next == 0)
+			log::info(2, "Indexing symbols in {}", queue.archive->filename(false));
+
+		while (queue.next < queue.entries.size() && n_read < IDLE_BATCH_SIZE)
+		{
+			auto entry = queue.entries[queue.next++].lock();
+			if (!entry || upToDate(*entry))
+				continue;
+
+			Job job;
+			if (prepareJob(*entry, job))
+			{
+				jobs.push_back(std::move(job));
+				n_read++;
+			}
+		}
+
+		if (queue.next >= queue.entries.size())
+			unindexed_.pop_front();
+	}
+
+	queueJobs(std::move(jobs));
+
+	return !unindexed_.empty();
+}
+
+// -----------------------------------------------------------------------------
+// Returns the number of indexed entries
+// -----------------------------------------------------------------------------
+unsigned SymbolIndex::nEntries() const
+{
+	std::lock_guard lock(index_->mutex);
+	return index_->entries.size();
+}
+
+// -----------------------------------------------------------------------------
+// Returns the number of entries waiting to be (re)indexed
+// -----------------------------------------------------------------------------
+unsigned SymbolIndex::nPending() const
+{
+	std::lock_guard lock(index_->mutex);
+	return index_->pending.size();
+}
+
+// -----------------------------------------------------------------------------
+// Sets [symbols] to the symbols defined in [entry], in the order they appear.
+// Returns false if [entry] isn't indexed or its index is out of date, in which
+// case the rest of its archive is moved to the front of the indexing queue
+// -----------------------------------------------------------------------------
+bool SymbolIndex::entrySymbols(const ArchiveEntry& entry, vector<Symbol>& symbols) const
+{
+	{
+		std::lock_guard lock(index_->mutex);
+
+		auto i = index_->entries.find(&entry);
+		if (i != index_->entries.end() && i->second.version == entry.version())
+		{
+			symbols = i->second.symbols;
+			return true;
+		}
+	}
+
+	// Index the entry's archive next
+	auto queue = std::find_if(
+		unindexed_.begin(),
+		unindexed_.end(),
+		[&entry](const ArchiveQueue& q) { return q.archive == entry.parent(); });
+	if (queue != unindexed_.end() && queue != unindexed_.begin())
+	{
+		auto q = std::move(*queue);
+		unindexed_.erase(queue);
+		unindexed_.push_front(std::move(q));
+	}
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the locations of all definitions of the symbol [name] (case
+// insensitive), sorted by entry path and line
+// -----------------------------------------------------------------------------
+vector<SymbolIndex::Location> SymbolIndex::definitions(string_view name) const
+{
+	vector<Location> locations;
+
+	{
+		std::lock_guard lock(index_->mutex);
+		for (const auto& i : index_->entries)
+		{
+			auto entry = i.second.entry.lock();
+			if (!entry)
+				continue;
+
+			for (const auto& symbol : i.second.symbols)
+				if (strutil::equalCI(symbol.name, name))
+					locations.push_back({ entry.get(), symbol.line, symbol.position });
+		}
+	}
+
+	sortLocations(locations);
+	return locations;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the locations of all lines using the identifier [name] (case
+// insensitive), sorted by entry path and line
+// -----------------------------------------------------------------------------
+vector<SymbolIndex::Location> SymbolIndex::usages(string_view name) const
+{
+	vector<Location> locations;
+	auto             key = strutil::upper(name);
+
+	{
+		std::lock_guard lock(index_->mutex);
+		for (const auto& i : index_->entries)
+		{
+			auto usage = i.second.usages.find(key);
+			if (usage == i.second.usages.end())
+				continue;
+
+			auto entry = i.second.entry.lock();
+			if (!entry)
+				continue;
+
+			for (const auto& symbol : usage->second)
+				locations.push_back({ entry.get(), symbol.line, symbol.position });
+		}
+	}
+
+	sortLocations(locations);
+	return locations;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [entry] is indexed at its current version and language, and
+// isn't queued to be indexed again
+// -----------------------------------------------------------------------------
+bool SymbolIndex::upToDate(const ArchiveEntry& entry) const
+{
+	std::lock_guard lock(index_->mutex);
+
+	auto i = index_->entries.find(&entry);
+	return i != index_->entries.end() && i->second.version == entry.version()
+		   && i->second.language == TextLanguage::forEntry(entry)
+		   && index_->pending.find(&entry) == index_->pending.end();
+}
+
+// -----------------------------------------------------------------------------
+// Sets up [job] to index [entry], copying its text and its language's block
+// keywords so it can be parsed on a worker thread. Returns false if [entry]
+// has no language, or its language doesn't define any blocks.
+// If the entry's data has to be loaded to do this, it is unloaded again after
+// -----------------------------------------------------------------------------
+bool SymbolIndex::prepareJob(ArchiveEntry& entry, Job& job) const
+{
+	auto language = TextLanguage::forEntry(entry);
+	if (!language || language->jumpBlocks().empty())
+		return false;
+
+	auto was_loaded = entry.isLoaded();
+	auto data       = entry.rawData();
+
+	job.entry       = entry.getShared();
+	job.key         = &entry;
+	job.version     = entry.version();
+	job.language    = language;
+	job.block_names = language->jumpBlocks();
+	job.ignore      = language->jumpBlocksIgnored();
+	if (data && entry.size() > 0)
+		job.text.assign(reinterpret_cast<const char*>(data), entry.size());
+
+	if (!was_loaded)
+		entry.unloadData();
+
+	std::lock_guard lock(index_->mutex);
+	job.id                  = ++index_->next_job;
+	index_->pending[&entry] = job.id;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Queues [jobs] to be run on worker threads, in batches
+// -----------------------------------------------------------------------------
+void SymbolIndex::queueJobs(vector<Job> jobs) const
+{
+	for (unsigned start = 0; start < jobs.size(); start += JOB_BATCH_SIZE)
+	{
+		auto end = std::min<unsigned>(start + JOB_BATCH_SIZE, jobs.size());
+
+		vector<Job> batch(
+			std::make_move_iterator(jobs.begin() + start), std::make_move_iterator(jobs.begin() + end));
+		threadpool::global().enqueue(
+			[index = index_, batch = std::move(batch)]()
+			{
+				for (const auto& job : batch)
+					runJob(*index, job);
+			});
+	}
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// SymbolIndex Class Static Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Parses [text] for block definitions, the same way the text editor's
+// 'Jump To' list does: each keyword in [block_names] (optionally with a
+// ':<n>' suffix to skip n tokens) is followed by the block name, with any
+// keywords in [ignore] skipped. If [usages] is given, the locations of all
+// identifiers (keyed by upper-case name, once per line) are added to it
+// -----------------------------------------------------------------------------
+vector<SymbolIndex::Symbol> SymbolIndex::parseSymbols(
+	string_view                                 text,
+	const vector<string>&                       block_names,
+	const vector<string>&                       ignore,
+	std::unordered_map<string, vector<Symbol>>* usages)
+{
+	vector<Symbol> symbols;
+
+	Tokenizer tz;
+	tz.setSpecialCharacters(";,:|={}/()");
+	tz.openString(text);
+
+	// Returns the current token and moves to the next
+	auto next_token = [&]()
+	{
+		if (tz.atEnd())
+			return Symbol{};
+
+		const auto& current = tz.current();
+		Symbol      token{ current.text, current.line_no - 1, current.pos_start };
+
+		// Record usage
+		if (usages && !current.quoted_string && isIdentifier(token.name))
+		{
+			auto& lines = (*usages)[strutil::upper(token.name)];
+			if (lines.empty() || lines.back().line != token.line)
+				lines.push_back(token);
+		}
+
+		tz.getToken();
+		return token;
+	};
+
+	auto token = next_token();
+	while (!tz.atEnd())
+	{
+		if (token.name == "{")
+		{
+			// Skip block
+			while (!tz.atEnd() && token.name != "}")
+				token = next_token();
+		}
+
+		for (const auto& block_def : block_names)
+		{
+			// Get jump block keyword
+			string_view block = block_def;
+			int         skip  = 0;
+			if (strutil::contains(block, ':'))
+			{
+				skip  = strutil::asInt(strutil::afterLastV(block, ':'));
+				block = strutil::beforeFirstV(block, ':');
+			}
+
+			if (!strutil::equalCI(token.name, block))
+				continue;
+
+			auto name = next_token();
+			for (int s = 0; s < skip; s++)
+				name = next_token();
+
+			for (const auto& i : ignore)
+				if (strutil::equalCI(name.name, i))
+					name = next_token();
+
+			// Numbered block, add block name
+			if (strutil::isInteger(name.name, false))
+				name.name = fmt::format("{} {}", block, name.name);
+			// Unnamed block, use block name
+			if (name.name == "{" || name.name == ";")
+				name.name = block;
+
+			symbols.push_back(name);
+		}
+
+		token = next_token();
+	}
+
+	return symbols;
+}
+
+// -----------------------------------------------------------------------------
+// Parses the text in [job] and adds the result to [index], unless the entry
+// was removed or queued again in the meantime. Runs on a worker thread
+// -----------------------------------------------------------------------------
+void SymbolIndex::runJob(Index& index, const Job& job)
+{
+	auto is_current = [&index, &job]()
+	{
+		auto i = index.pending.find(job.key);
+		return i != index.pending.end() && i->second == job.id;
+	};
+
+	// Skip if already out of date
+	{
+		std::lock_guard lock(index.mutex);
+		if (!is_current())
+			return;
+	}
+
+	EntryInfo info;
+	info.entry    = job.entry;
+	info.version  = job.version;
+	info.language = job.language;
+	info.symbols  = parseSymbols(job.text, job.block_names, job.ignore, &info.usages);
+
+	std::lock_guard lock(index.mutex);
+	if (!is_current())
+		return;
+	index.pending.erase(job.key);
+	index.entries[job.key] = std::move(info);
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Lists the definitions of the given symbol in all open archives
+// -----------------------------------------------------------------------------
+CONSOLE_COMMAND(symbol_find, 1, true)
+{
+	auto locations = app::symbolIndex().definitions(args[0]);
+	log::console(fmt::format("{} definitions of \"{}\":", locations.size(), args[0]));
+	for (const auto& location : locations)
+		log::console(fmt::format("{}:{}", location.entry->path(true), location.line + 1));
+}
+
+// -----------------------------------------------------------------------------
+// Lists all lines using the given symbol in all open archives
+// -----------------------------------------------------------------------------
+CONSOLE_COMMAND(symbol_usages, 1, true)
+{
+	auto locations = app::symbolIndex().usages(args[0]);
+	log::console(fmt::format("{} usages of \"{}\":", locations.size(), args[0]));
+	for (const auto& location : locations)
+		log::console(fmt::format("{}:{}", location.entry->path(true), location.line + 1));
+}
+
+// -----------------------------------------------------------------------------
+// Shows the current state of the symbol index
+// -----------------------------------------------------------------------------
+CONSOLE_COMMAND(symbol_index_status, 0, false)
+{
+	log::console(fmt::format(
+		"{} entries indexed, {} waiting",
+		app::symbolIndex().nEntries(),
+		app::symbolIndex().nPending()));
+}
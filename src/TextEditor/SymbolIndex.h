@@ -0,0 +1,104 @@
+#pragma once
+
+#include "General/Sigslot.h"
+#include <deque>
+#include <mutex>
+
+namespace slade
+{
+class Archive;
+class ArchiveEntry;
+class TextLanguage;
+
+// Keeps an index of the symbols (actors, classes, scripts, etc.) defined in
+// and used by the text entries of open archives. The entries of an opened
+// archive are read a batch at a time when the application is idle (see
+// indexNext) and parsed on worker threads, and entries are parsed again
+// whenever they change, so lookups don't need to parse anything
+class SymbolIndex
+{
+public:
+	struct Symbol
+	{
+		string   name;
+		unsigned line;     // 0-based
+		unsigned position; // Byte offset in the entry text
+	};
+
+	struct Location
+	{
+		ArchiveEntry* entry;
+		unsigned      line;
+		unsigned      position;
+	};
+
+	SymbolIndex() : index_{ std::make_shared<Index>() } {}
+	~SymbolIndex() = default;
+
+	void addArchive(Archive* archive);
+	void removeArchive(const Archive* archive);
+	void updateEntry(ArchiveEntry& entry);
+	void removeEntry(const ArchiveEntry* entry);
+	bool indexNext();
+
+	unsigned         nEntries() const;
+	unsigned         nPending() const;
+	bool             entrySymbols(const ArchiveEntry& entry, vector<Symbol>& symbols) const;
+	vector<Location> definitions(string_view name) const;
+	vector<Location> usages(string_view name) const;
+
+	static vector<Symbol> parseSymbols(
+		string_view                                 text,
+		const vector<string>&                       block_names,
+		const vector<string>&                       ignore,
+		std::unordered_map<string, vector<Symbol>>* usages = nullptr);
+
+private:
+	struct EntryInfo
+	{
+		weak_ptr<ArchiveEntry>                     entry;
+		uint64_t                                   version  = 0;
+		const TextLanguage*                        language = nullptr;
+		vector<Symbol>                             symbols;
+		std::unordered_map<string, vector<Symbol>> usages; // Keyed by upper-case name
+	};
+
+	struct Job
+	{
+		weak_ptr<ArchiveEntry> entry;
+		const ArchiveEntry*    key;
+		uint64_t               version;
+		const TextLanguage*    language;
+		unsigned               id;
+		string                 text;
+		vector<string>         block_names;
+		vector<string>         ignore;
+	};
+
+	// Entries of an added archive still to be read for indexing
+	struct ArchiveQueue
+	{
+		const Archive*                 archive;
+		vector<weak_ptr<ArchiveEntry>> entries;
+		unsigned                       next = 0;
+	};
+
+	// Shared with queued worker tasks, so it stays valid until they finish
+	struct Index
+	{
+		mutable std::mutex                                 mutex;
+		std::unordered_map<const ArchiveEntry*, EntryInfo> entries;
+		std::unordered_map<const ArchiveEntry*, unsigned>  pending; // Entry -> id of its latest queued job
+		unsigned                                           next_job = 0;
+	};
+
+	shared_ptr<Index>                              index_;
+	std::map<const Archive*, ScopedConnectionList> connections_;
+	mutable std::deque<ArchiveQueue>               unindexed_;
+
+	bool        upToDate(const ArchiveEntry& entry) const;
+	bool        prepareJob(ArchiveEntry& entry, Job& job) const;
+	void        queueJobs(vector<Job> jobs) const;
+	static void runJob(Index& index, const Job& job);
+};
+} // namespace slade
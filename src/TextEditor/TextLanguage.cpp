@@ -36,6 +36,7 @@
 #include "TextLanguage.h"
 #include "App.h"
 #include "Archive/ArchiveManager.h"
+#include "Archive/EntryType/EntryType.h"
 #include "Game/ZScript.h"
 #include "Utility/Parser.h"
 #include "Utility/StringUtils.h"
@@ -276,6 +277,7 @@ void TextLanguage::copyTo(TextLanguage* copy) const
 
 	// Copy functions
 	copy->functions_ = functions_;
+	copy->autocomp_index_valid_ = false;
 
 	// Copy preprocessor/word block begin/end
 	copy->pp_block_begin_   = pp_block_begin_;
@@ -292,7 +294,10 @@ void TextLanguage::addWord(WordType type, string_view keyword, bool custom)
 	// Add only if it doesn't already exist
 	auto& list = custom ? word_lists_custom_[type].list : word_lists_[type].list;
 	if (std::find(list.begin(), list.end(), keyword) == list.end())
+	{
 		list.emplace_back(keyword);
+		autocomp_index_valid_ = false;
+	}
 }
 
 // -----------------------------------------------------------------------------
@@ -337,6 +342,8 @@ void TextLanguage::addFunction(
 
 	// Add the context
 	func->addContext(context, args, return_type, desc, deprecated);
+
+	autocomp_index_valid_ = false;
 }
 
 // -----------------------------------------------------------------------------
@@ -364,7 +371,8 @@ void TextLanguage::loadZScript(const zscript::Definitions& defs, bool custom)
 			if (!func)
 			{
 				functions_.emplace_back(f.name());
-				func = &functions_.back();
+				func                  = &functions_.back();
+				autocomp_index_valid_ = false;
 			}
 
 			// Add the context
@@ -417,41 +425,26 @@ string TextLanguage::functionsList() const
 }
 
 // -----------------------------------------------------------------------------
-// Returns a string containing all words and functions that can be used
-// directly in scintilla for an autocompletion list
+// Returns a string containing all words and functions starting with [start]
+// (case-insensitive) that can be used directly in scintilla for an
+// autocompletion list. The list is sorted case-insensitively, as scintilla
+// expects when ignoring case
 // -----------------------------------------------------------------------------
 string TextLanguage::autocompletionList(string_view start, bool include_custom)
 {
-	// Firstly, add all functions and word lists to a vector
-	vector<string> list;
-
-	// Add word lists
-	for (unsigned type = 0; type < 4; type++)
-	{
-		for (auto& word : word_lists_[type].list)
-			if (strutil::startsWithCI(word, start))
-				list.push_back(fmt::format("{}?{}", word, type + 1));
+	if (!autocomp_index_valid_)
+		buildAutocompIndex();
 
-		if (!include_custom)
-			continue;
-
-		for (auto& word : word_lists_custom_[type].list)
-			if (strutil::startsWithCI(word, start))
-				list.push_back(fmt::format("{}?{}", word, type + 1));
-	}
+	// Find the first word starting with [start]
+	auto prefix   = strutil::upper(start);
+	auto key_less = [](const AutocompEntry& entry, const string& key) { return entry.key < key; };
+	auto first    = std::lower_bound(autocomp_index_.begin(), autocomp_index_.end(), prefix, key_less);
 
-	// Add functions
-	for (auto& func : functions_)
-		if (strutil::startsWithCI(func.name(), start))
-			list.push_back(fmt::format("{}{}", func.name(), "?5"));
-
-	// Sort the list
-	std::sort(list.begin(), list.end());
-
-	// Now build a string of the list items separated by spaces
+	// Build a string of the matching list items separated by spaces
 	string ret;
-	for (const auto& a : list)
-		ret.append(a).append(" ");
+	for (auto i = first; i != autocomp_index_.end() && strutil::startsWith(i->key, prefix); ++i)
+		if (include_custom || !i->custom)
+			ret.append(i->item).append(" ");
 
 	return ret;
 }
@@ -540,6 +533,36 @@ TLFunction* TextLanguage::function(string_view name)
 	return nullptr;
 }
 
+// -----------------------------------------------------------------------------
+// Builds the autocompletion index from all words and functions
+// -----------------------------------------------------------------------------
+void TextLanguage::buildAutocompIndex()
+{
+	autocomp_index_.clear();
+
+	// Add word lists
+	for (unsigned type = 0; type < 4; type++)
+	{
+		for (auto& word : word_lists_[type].list)
+			autocomp_index_.push_back({ strutil::upper(word), fmt::format("{}?{}", word, type + 1), false });
+		for (auto& word : word_lists_custom_[type].list)
+			autocomp_index_.push_back({ strutil::upper(word), fmt::format("{}?{}", word, type + 1), true });
+	}
+
+	// Add functions
+	for (auto& func : functions_)
+		autocomp_index_.push_back({ strutil::upper(func.name()), func.name() + "?5", false });
+
+	// Sort
+	std::sort(
+		autocomp_index_.begin(),
+		autocomp_index_.end(),
+		[](const AutocompEntry& left, const AutocompEntry& right)
+		{ return left.key < right.key || (left.key == right.key && left.item < right.item); });
+
+	autocomp_index_valid_ = true;
+}
+
 // -----------------------------------------------------------------------------
 // Clears all custom definitions in the language
 // -----------------------------------------------------------------------------
@@ -556,6 +579,8 @@ void TextLanguage::clearCustomDefs()
 
 	for (auto& a : word_lists_custom_)
 		a.list.clear();
+
+	autocomp_index_valid_ = false;
 }
 
 
@@ -967,6 +992,30 @@ TextLanguage* TextLanguage::fromName(string_view name)
 	return nullptr;
 }
 
+// -----------------------------------------------------------------------------
+// Returns the language definition to use for [entry], from its language hint
+// or type (or NULL if none)
+// -----------------------------------------------------------------------------
+TextLanguage* TextLanguage::forEntry(ArchiveEntry& entry)
+{
+	TextLanguage* tl = nullptr;
+
+	// Level markers use FraggleScript
+	if (entry.type() == EntryType::mapMarkerType())
+		tl = fromId("fragglescript");
+
+	// From entry language hint
+	if (auto lang = entry.exProps().getIf<string>("TextLanguage"))
+		tl = fromId(*lang);
+
+	// Or, from entry type
+	if (!tl)
+		if (auto lang = entry.type()->extraProps().getIf<string>("text_language"))
+			tl = fromId(*lang);
+
+	return tl;
+}
+
 // -----------------------------------------------------------------------------
 // Returns a list of all language names
 // -----------------------------------------------------------------------------
@@ -2,6 +2,8 @@
 
 namespace slade
 {
+class ArchiveEntry;
+
 namespace zscript
 {
 	class Function;
@@ -163,8 +165,16 @@ public:
 
 	TLFunction* function(string_view name);
 
-	void clearWordList(WordType type) { word_lists_[type].list.clear(); }
-	void clearFunctions() { functions_.clear(); }
+	void clearWordList(WordType type)
+	{
+		word_lists_[type].list.clear();
+		autocomp_index_valid_ = false;
+	}
+	void clearFunctions()
+	{
+		functions_.clear();
+		autocomp_index_valid_ = false;
+	}
 	void clearCustomDefs();
 
 	// Static functions
@@ -173,6 +183,7 @@ public:
 	static TextLanguage*  fromId(string_view id);
 	static TextLanguage*  fromIndex(unsigned index);
 	static TextLanguage*  fromName(string_view name);
+	static TextLanguage*  forEntry(ArchiveEntry& entry);
 	static vector<string> languageNames();
 
 private:
@@ -217,5 +228,19 @@ private:
 		string deprecated_f;
 	};
 	std::map<string, ZFuncExProp> zfuncs_ex_props_;
+
+	// Autocompletion index, all words and functions sorted case-insensitively
+	// so that words starting with a prefix can be found with a binary search.
+	// Rebuilt when needed after any words or functions are changed
+	struct AutocompEntry
+	{
+		string key;  // Uppercase word
+		string item; // Word with its type, as used in the autocompletion list
+		bool   custom;
+	};
+	vector<AutocompEntry> autocomp_index_;
+	bool                  autocomp_index_valid_ = false;
+
+	void buildAutocompIndex();
 };
 } // namespace slade
@@ -37,11 +37,11 @@
 #include "FindReplacePanel.h"
 #include "General/KeyBind.h"
 #include "Graphics/Icons.h"
+#include "MainEditor/MainEditor.h"
 #include "SCallTip.h"
 #include "SLADEWxApp.h"
 #include "UI/WxUtils.h"
 #include "Utility/StringUtils.h"
-#include "Utility/Tokenizer.h"
 
 using namespace slade;
 
@@ -123,55 +123,8 @@ wxThread::ExitCode JumpToCalculator::Entry()
 {
 	wxString jump_points;
 
-	Tokenizer tz;
-	tz.setSpecialCharacters(";,:|={}/()");
-	tz.openString(text_);
-
-	wxString token = tz.getToken();
-	while (!tz.atEnd())
-	{
-		if (token == "{")
-		{
-			// Skip block
-			while (!tz.atEnd() && token != "}")
-				token = tz.getToken();
-		}
-
-		for (auto block : block_names_)
-		{
-			// Get jump block keyword
-			long skip = 0;
-			if (strutil::contains(block, ':'))
-			{
-				auto sp = wxSplit(block, ':');
-				sp.back().ToLong(&skip);
-				block = sp[0];
-			}
-
-			if (S_CMPNOCASE(token, block))
-			{
-				wxString name = tz.getToken();
-				for (int s = 0; s < skip; s++)
-					name = tz.getToken();
-
-				for (const auto& i : ignore_)
-					if (S_CMPNOCASE(name, i))
-						name = tz.getToken();
-
-				// Numbered block, add block name
-				if (name.IsNumber())
-					name = wxString::Format("%s %s", block, name);
-				// Unnamed block, use block name
-				if (name == "{" || name == ";")
-					name = block;
-
-				// Add jump point
-				jump_points += wxString::Format("%d,%s,", tz.lineNo() - 1, name);
-			}
-		}
-
-		token = tz.getToken();
-	}
+	for (const auto& symbol : SymbolIndex::parseSymbols(text_, block_names_, ignore_))
+		jump_points += wxString::Format("%d,%s,", symbol.line, wxString::FromUTF8(symbol.name));
 
 	// Remove ending comma
 	if (!jump_points.empty())
@@ -459,6 +412,8 @@ bool TextEditorCtrl::loadEntry(ArchiveEntry* entry)
 {
 	// Clear current text
 	ClearAll();
+	entry_.reset();
+	text_from_entry_ = false;
 
 	// Check that the entry exists
 	if (!entry)
@@ -467,6 +422,8 @@ bool TextEditorCtrl::loadEntry(ArchiveEntry* entry)
 		return false;
 	}
 
+	entry_ = entry->getShared();
+
 	// Check that the entry has any data, if not do nothing
 	if (entry->size() == 0 || !entry->rawData())
 		return true;
@@ -479,7 +436,8 @@ bool TextEditorCtrl::loadEntry(ArchiveEntry* entry)
 
 	// Load text into editor
 	SetText(text);
-	last_modified_ = app::runTimer();
+	last_modified_   = app::runTimer();
+	text_from_entry_ = true;
 
 	// Update line numbers margin width
 	wxString numlines = wxString::Format("0%d", txed_fold_debug ? 1234567 : GetNumberOfLines());
@@ -1077,6 +1035,27 @@ void TextEditorCtrl::updateJumpToList()
 		return;
 	}
 
+	// Get symbols from the index if the text is unchanged since it was loaded
+	auto                        entry = entry_.lock();
+	vector<SymbolIndex::Symbol> symbols;
+	if (text_from_entry_ && entry && language_ == TextLanguage::forEntry(*entry)
+		&& app::symbolIndex().entrySymbols(*entry, symbols))
+	{
+		choice_jump_to_->Clear();
+		jump_to_lines_.clear();
+
+		wxArrayString items;
+		for (const auto& symbol : symbols)
+		{
+			items.push_back(wxString::FromUTF8(symbol.name));
+			jump_to_lines_.push_back(symbol.line);
+		}
+
+		choice_jump_to_->Append(items);
+		choice_jump_to_->Enable(true);
+		return;
+	}
+
 	// Begin jump to calculation thread
 	choice_jump_to_->Enable(false);
 	jump_to_calculator_ = new JumpToCalculator(
@@ -1113,6 +1092,75 @@ void TextEditorCtrl::jumpToLine()
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Goes to the definition of the symbol at the caret, in any text entry of the
+// open archives (see SymbolIndex)
+// -----------------------------------------------------------------------------
+void TextEditorCtrl::goToDefinition()
+{
+	auto word = GetTextRange(WordStartPosition(GetCurrentPos(), true), WordEndPosition(GetCurrentPos(), true));
+	if (word.empty())
+		return;
+
+	goToSymbol(app::symbolIndex().definitions(word.ToStdString()), "Definitions of " + word);
+}
+
+// -----------------------------------------------------------------------------
+// Lists all lines using the symbol at the caret, in any text entry of the open
+// archives, and goes to the selected one
+// -----------------------------------------------------------------------------
+void TextEditorCtrl::findUsages()
+{
+	auto word = GetTextRange(WordStartPosition(GetCurrentPos(), true), WordEndPosition(GetCurrentPos(), true));
+	if (word.empty())
+		return;
+
+	goToSymbol(app::symbolIndex().usages(word.ToStdString()), "Usages of " + word);
+}
+
+// -----------------------------------------------------------------------------
+// Goes to one of the symbol [locations], prompting the user to select one if
+// there are multiple. Locations in other entries are opened in the main editor
+// -----------------------------------------------------------------------------
+void TextEditorCtrl::goToSymbol(const vector<SymbolIndex::Location>& locations, const wxString& title)
+{
+	if (locations.empty())
+	{
+		wxBell();
+		return;
+	}
+
+	// Select location
+	unsigned index = 0;
+	if (locations.size() > 1)
+	{
+		wxArrayString choices;
+		for (const auto& location : locations)
+			choices.Add(wxString::Format("%s:%d", location.entry->path(true), location.line + 1));
+
+		int selection = wxGetSingleChoiceIndex("Select a location to go to", title, choices, 0, this);
+		if (selection < 0)
+			return;
+		index = selection;
+	}
+	const auto& location = locations[index];
+
+	// Location in another entry, open it at the location
+	if (location.entry != entry_.lock().get())
+	{
+		location.entry->exProp("TextPosition") = static_cast<int>(location.position);
+		maineditor::openEntry(location.entry);
+		return;
+	}
+
+	// Move to line
+	int pos = GetLineEndPosition(location.line);
+	SetCurrentPos(pos);
+	SetSelection(pos, pos);
+	EnsureCaretVisible();
+	SetFocus();
+}
+
 // -----------------------------------------------------------------------------
 // Folds or unfolds all code folding levels, depending on [fold]
 // -----------------------------------------------------------------------------
@@ -1397,6 +1445,19 @@ void TextEditorCtrl::onKeyDown(wxKeyEvent& e)
 			handled = true;
 		}
 
+		// Symbols
+		else if (name == "ted_goto_definition")
+		{
+			goToDefinition();
+			handled = true;
+		}
+
+		else if (name == "ted_find_usages")
+		{
+			findUsages();
+			handled = true;
+		}
+
 		// Comments
 		else if (name == "ted_line_comment")
 		{
@@ -1860,6 +1921,9 @@ void TextEditorCtrl::onJumpToChoiceSelected(wxCommandEvent& e)
 // -----------------------------------------------------------------------------
 void TextEditorCtrl::onModified(wxStyledTextEvent& e)
 {
+	// Text no longer matches the entry it was loaded from
+	text_from_entry_ = false;
+
 	// (Re)start update timer for jump to list if text has changed
 	if (prev_text_length_ != GetTextLength())
 	{
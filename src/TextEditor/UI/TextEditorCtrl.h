@@ -2,6 +2,7 @@
 
 #include "Archive/ArchiveEntry.h"
 #include "TextEditor/Lexer.h"
+#include "TextEditor/SymbolIndex.h"
 #include "TextEditor/TextLanguage.h"
 #include "TextEditor/TextStyle.h"
 #include <utility>
@@ -86,6 +87,10 @@ public:
 	void updateJumpToList();
 	void jumpToLine();
 
+	// Symbols
+	void goToDefinition();
+	void findUsages();
+
 	// Folding
 	void foldAll(bool fold = true);
 	void setupFolding();
@@ -107,6 +112,11 @@ private:
 	vector<int>       jump_to_lines_;
 	long              last_modified_ = 0;
 
+	// Entry the text was loaded from, and whether the text is unchanged since
+	// (if so, the entry's symbols can be taken from the symbol index)
+	weak_ptr<ArchiveEntry> entry_;
+	bool                   text_from_entry_ = false;
+
 	// State tracking for updates
 	int  prev_cursor_pos_      = -1;
 	int  prev_text_length_     = -1;
@@ -129,6 +139,8 @@ private:
 	const wxString default_begin_comment_ = "/*";
 	const wxString default_end_comment_   = "*/";
 
+	void goToSymbol(const vector<SymbolIndex::Location>& locations, const wxString& title);
+
 	// Events
 	void onKeyDown(wxKeyEvent& e);
 	void onKeyUp(wxKeyEvent& e);
@@ -36,6 +36,7 @@
 #include "Archive/ArchiveManager.h"
 #include "Archive/Formats/WadArchive.h"
 #include "General/ColourConfiguration.h"
+#include "Graphics/MapImage.h"
 #include "Graphics/SImage/SIFormat.h"
 #include "Graphics/SImage/SImage.h"
 #include "OpenGL/GLTexture.h"
@@ -821,9 +822,10 @@ void MapPreviewCanvas::draw()
 
 
 // -----------------------------------------------------------------------------
-// Draws the map in an image
-// TODO: Factorize code with normal draw() and showMap() functions.
-// TODO: Find a way to generate an arbitrary-sized image through tiled rendering
+// Draws the map in an image (in software, see gfx::drawMapImage) and writes it
+// to [ae] as PNG data.
+// If [width] or [height] are negative, they are taken as the map size divided
+// by the (absolute) value given
 // -----------------------------------------------------------------------------
 void MapPreviewCanvas::createImage(ArchiveEntry& ae, int width, int height)
 {
@@ -853,152 +855,24 @@ void MapPreviewCanvas::createImage(ArchiveEntry& ae, int width, int height)
 	if (height < 0)
 		height = mapheight / abs(height);
 
-	// Setup colours
-	auto col_save_background   = colourconfig::colour("map_image_background");
-	auto col_save_line_1s      = colourconfig::colour("map_image_line_1s");
-	auto col_save_line_2s      = colourconfig::colour("map_image_line_2s");
-	auto col_save_line_special = colourconfig::colour("map_image_line_special");
-	auto col_save_line_macro   = colourconfig::colour("map_image_line_macro");
-
-	// Setup OpenGL rigmarole
-	GLuint tex_id, fbo_id;
-	if (gl::fboSupport())
-	{
-		glGenTextures(1, &tex_id);
-		gl::Texture::bind(tex_id);
-		// We don't use mipmaps, but OpenGL will refuse to attach
-		// the texture to the framebuffer if they are not present
-		glTexParameteri(GL_TEXTURE_2D, GL_GENERATE_MIPMAP, GL_TRUE);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
-		gl::Texture::bind(0);
-		glGenFramebuffersEXT(1, &fbo_id);
-		glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, fbo_id);
-		glFramebufferTexture2DEXT(GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, GL_TEXTURE_2D, tex_id, 0);
-		GLenum status = glCheckFramebufferStatusEXT(GL_FRAMEBUFFER_EXT);
-	}
-
-	glViewport(0, 0, width, height);
-
-	// Setup the screen projection
-	glMatrixMode(GL_PROJECTION);
-	glLoadIdentity();
-	glOrtho(0, width, 0, height, -1, 1);
-
-	glMatrixMode(GL_MODELVIEW);
-	glLoadIdentity();
-
-	// Clear
-	glClearColor(
-		((double)col_save_background.r) / 255.f,
-		((double)col_save_background.g) / 255.f,
-		((double)col_save_background.b) / 255.f,
-		((double)col_save_background.a) / 255.f);
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-	// Translate to inside of pixel (otherwise inaccuracies can occur on certain gl implementations)
-	if (gl::accuracyTweak())
-		glTranslatef(0.375f, 0.375f, 0);
-
-	// Zoom/offset to show full map
-	// Offset to center of map
-	offset_ = { m_min.x + (mapwidth * 0.5), m_min.y + (mapheight * 0.5) };
-
-	// Zoom to fit whole map
-	double x_scale = ((double)width) / mapwidth;
-	double y_scale = ((double)height) / mapheight;
-	zoom_          = std::min<double>(x_scale, y_scale);
-	zoom_ *= 0.95;
-
-	// Translate to middle of canvas
-	glTranslated(width >> 1, height >> 1, 0);
-
-	// Zoom
-	glScaled(zoom_, zoom_, 1);
-
-	// Translate to offset
-	glTranslated(-offset_.x, -offset_.y, 0);
-
-	// Setup drawing
-	glDisable(GL_TEXTURE_2D);
-	glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
-	glLineWidth(map_image_thickness);
-	glEnable(GL_LINE_SMOOTH);
-
-	// Draw 2s lines
+	// Get lines to draw
+	vector<gfx::MapImageLine> lines;
+	lines.reserve(lines_.size());
 	for (auto& line : lines_)
 	{
-		if (!line.twosided)
-			continue;
-
 		// Check ends
 		if (line.v1 >= verts_.size() || line.v2 >= verts_.size())
 			continue;
 
-		// Get vertices
-		auto v1 = verts_[line.v1];
-		auto v2 = verts_[line.v2];
-
-		// Set colour
-		if (line.special)
-			gl::setColour(col_save_line_special);
-		else if (line.macro)
-			gl::setColour(col_save_line_macro);
-		else if (line.twosided)
-			gl::setColour(col_save_line_2s);
-		else
-			gl::setColour(col_save_line_1s);
-
-		// Draw line
-		glBegin(GL_LINES);
-		glVertex2d(v1.x, v1.y);
-		glVertex2d(v2.x, v2.y);
-		glEnd();
+		const auto& v1 = verts_[line.v1];
+		const auto& v2 = verts_[line.v2];
+		lines.emplace_back(Vec2d{ v1.x, v1.y }, Vec2d{ v2.x, v2.y }, line.twosided, line.special, line.macro);
 	}
 
-	// Draw 1s lines
-	for (auto& line : lines_)
-	{
-		if (line.twosided)
-			continue;
-
-		// Check ends
-		if (line.v1 >= verts_.size() || line.v2 >= verts_.size())
-			continue;
-
-		// Get vertices
-		auto v1 = verts_[line.v1];
-		auto v2 = verts_[line.v2];
-
-		// Set colour
-		if (line.special)
-			gl::setColour(col_save_line_special);
-		else if (line.macro)
-			gl::setColour(col_save_line_macro);
-		else
-			gl::setColour(col_save_line_1s);
-
-		// Draw line
-		glBegin(GL_LINES);
-		glVertex2d(v1.x, v1.y);
-		glVertex2d(v2.x, v2.y);
-		glEnd();
-	}
-
-	glLineWidth(1.0f);
-	glDisable(GL_LINE_SMOOTH);
-
-	vector<uint8_t> buffer(width * height * 4);
-	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, buffer.data());
-
-	if (gl::fboSupport())
-	{
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
-		glDeleteTextures(1, &tex_id);
-		glDeleteFramebuffersEXT(1, &fbo_id);
-	}
+	// Draw image
 	SImage img;
-	img.setImageData(buffer, width, height, SImage::Type::RGBA);
-	img.mirror(true);
+	gfx::drawMapImage(img, lines, width, height, gfx::mapImageColours(), map_image_thickness);
+
 	MemChunk mc;
 	SIFormat::getFormat("png")->saveImage(img, mc);
 	ae.importMemChunk(mc);
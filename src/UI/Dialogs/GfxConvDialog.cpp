@@ -38,6 +38,7 @@
 #include "Graphics/CTexture/CTexture.h"
 #include "Graphics/Icons.h"
 #include "Graphics/Palette/PaletteManager.h"
+#include "Graphics/SImage/BatchConvert.h"
 #include "Graphics/SImage/SIFormat.h"
 #include "UI/Canvas/GfxCanvas.h"
 #include "UI/Controls/ColourBox.h"
@@ -648,16 +649,63 @@ void GfxConvDialog::onBtnConvertAll(wxCommandEvent& e)
 	// Show splash window
 	ui::showSplash("Converting Gfx...", true);
 
+	// Setup remaining items to be converted with the current options
+	vector<gfx::BatchConvertItem> batch;
+	batch.reserve(items_.size() - current_item_);
+	for (auto a = current_item_; a < items_.size(); a++)
+	{
+		auto& item       = items_[a];
+		auto& batch_item = batch.emplace_back(item.entry);
+
+		// Textures have to be generated here (needs the resource manager)
+		if (item.texture && !item.image.isValid())
+		{
+			if (item.force_rgba)
+				item.image.convertRGBA(item.palette);
+			item.texture->toImage(item.image, item.archive, item.palette, item.force_rgba);
+		}
+		if (item.image.isValid())
+			batch_item.image.copyImage(&item.image);
+
+		convertOptions(batch_item.options);
+		batch_item.options.pal_current = pal_chooser_current_->selectedPalette(item.entry);
+		batch_item.options.pal_target  = pal_chooser_target_->selectedPalette(item.entry);
+	}
+
 	// Convert all images
-	for (size_t a = current_item_; a < items_.size(); a++)
+	auto stats = gfx::convertImages(batch, current_format_.format, true, false);
+	ui::setSplashMessage(stats.asString());
+
+	// Apply converted images in order, stopping at the first image that can't
+	// be converted to the current format so it can be dealt with
+	auto next_item = items_.size();
+	for (unsigned a = 0; a < batch.size(); a++)
 	{
-		applyConversion();
-		if (!nextItem())
+		auto  index = current_item_ + a;
+		auto& item  = items_[index];
+		ui::setSplashProgressMessage(fmt::format("{} of {}", index, items_.size()));
+		ui::setSplashProgress(static_cast<float>(index) / static_cast<float>(items_.size()));
+
+		if (batch[a].status == gfx::BatchConvertItem::Status::NotWritable)
+		{
+			next_item = index;
 			break;
+		}
+		if (batch[a].status != gfx::BatchConvertItem::Status::Done)
+			continue; // Skip if not a valid image entry
+
+		item.image.copyImage(&batch[a].image);
+		item.modified   = true;
+		item.new_format = current_format_.format;
+		item.palette    = pal_chooser_target_->selectedPalette(item.entry);
 	}
 
 	// Hide splash window
 	ui::hideSplash();
+
+	// Go to the next unconverted item (or close if there are none left)
+	current_item_ = next_item - 1;
+	nextItem();
 }
 
 // -----------------------------------------------------------------------------
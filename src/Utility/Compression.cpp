@@ -67,9 +67,16 @@ bool compression::genericInflate(MemChunk& in, MemChunk& out, int windowbits, co
 
 // -----------------------------------------------------------------------------
 // Basically a copy of zpipe.
-// Deflates the content of [in] to [out]
+// Deflates the content of [in] to [out], using the zlib compression [strategy]
+// (Z_FILTERED, Z_RLE etc.) if given
 // -----------------------------------------------------------------------------
-bool compression::genericDeflate(MemChunk& in, MemChunk& out, int level, int windowbits, const char* function)
+bool compression::genericDeflate(
+	MemChunk&   in,
+	MemChunk&   out,
+	int         level,
+	int         windowbits,
+	const char* function,
+	int         strategy)
 {
 	in.seek(0, SEEK_SET);
 	out.clear();
@@ -84,10 +91,10 @@ bool compression::genericDeflate(MemChunk& in, MemChunk& out, int level, int win
 	strm.zalloc = nullptr;
 	strm.zfree  = nullptr;
 	strm.opaque = nullptr;
-	if (windowbits == 0)
+	if (windowbits == 0 && strategy == Z_DEFAULT_STRATEGY)
 		ret = deflateInit(&strm, level);
 	else
-		ret = deflateInit2(&strm, level, Z_DEFLATED, windowbits, 9, Z_DEFAULT_STRATEGY);
+		ret = deflateInit2(&strm, level, Z_DEFLATED, windowbits ? windowbits : MAX_WBITS, 9, strategy);
 	if (ret != Z_OK)
 	{
 		log::error("{} init error {}: {}", function, ret, strm.msg);
@@ -201,9 +208,9 @@ bool compression::zlibInflate(MemChunk& in, MemChunk& out, size_t maxsize)
 // -----------------------------------------------------------------------------
 // Deflates the content of [in] as a zlib stream to [out]
 // -----------------------------------------------------------------------------
-bool compression::zlibDeflate(MemChunk& in, MemChunk& out, int level)
+bool compression::zlibDeflate(MemChunk& in, MemChunk& out, int level, int strategy)
 {
-	return compression::genericDeflate(in, out, level, 0, "ZlibDeflate");
+	return compression::genericDeflate(in, out, level, 0, "ZlibDeflate", strategy);
 }
 
 // -----------------------------------------------------------------------------
@@ -0,0 +1,268 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2022 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    DirWatcher.cpp
+// Description: DirWatcher class, watches a directory tree for changes using
+//              file system notifications (inotify on Linux) so that only the
+//              changed paths need to be checked, rather than the whole tree
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "DirWatcher.h"
+#include "StringUtils.h"
+#ifdef __linux__
+#include <cerrno>
+#include <filesystem>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// DirWatcher Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// DirWatcher class constructor
+// -----------------------------------------------------------------------------
+DirWatcher::DirWatcher(string_view path, bool ignore_hidden) : path_{ path }, ignore_hidden_{ ignore_hidden }
+{
+	// Remove trailing separators, so paths are built the same way as wxDir
+	while (path_.size() > 1 && (path_.back() == '/' || path_.back() == '\\'))
+		path_.pop_back();
+
+#ifdef __linux__
+	start();
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// DirWatcher class destructor
+// -----------------------------------------------------------------------------
+DirWatcher::~DirWatcher()
+{
+#ifdef __linux__
+	stop();
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the watcher is receiving change notifications
+// -----------------------------------------------------------------------------
+bool DirWatcher::isActive() const
+{
+#ifdef __linux__
+	return fd_ >= 0;
+#else
+	return false;
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// Adds all paths (files and directories) that have changed since the last call
+// to [paths], and clears the list of changed paths.
+// Returns false if changes may have been missed (the watcher isn't active or
+// too many changes happened at once), in which case the whole directory tree
+// needs to be rescanned
+// -----------------------------------------------------------------------------
+bool DirWatcher::changedPaths(vector<string>& paths)
+{
+#ifdef __linux__
+	if (fd_ < 0)
+		return false;
+
+	readEvents();
+
+	if (rescan_needed_)
+	{
+		// Start watching again from scratch
+		log::info(2, "Unable to track all changes in {}, rescan needed", path_);
+		stop();
+		start();
+		return false;
+	}
+
+	paths.insert(paths.end(), changed_.begin(), changed_.end());
+	changed_.clear();
+
+	return true;
+#else
+	return false;
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// Adds [path] to the changed paths, so it is included the next time
+// changedPaths is called (eg. if a change was found but not dealt with)
+// -----------------------------------------------------------------------------
+void DirWatcher::markChanged(string_view path)
+{
+#ifdef __linux__
+	if (fd_ >= 0)
+		changed_.emplace(path);
+#endif
+}
+
+#ifdef __linux__
+// -----------------------------------------------------------------------------
+// Starts watching the directory tree
+// -----------------------------------------------------------------------------
+void DirWatcher::start()
+{
+	fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (fd_ < 0)
+	{
+		log::warning("Unable to watch {} for changes: inotify_init1 failed (error {})", path_, errno);
+		return;
+	}
+
+	rescan_needed_ = false;
+	watchDir(path_, false);
+}
+
+// -----------------------------------------------------------------------------
+// Stops watching the directory tree and clears any pending changes
+// -----------------------------------------------------------------------------
+void DirWatcher::stop()
+{
+	if (fd_ >= 0)
+		close(fd_);
+
+	fd_ = -1;
+	watch_dirs_.clear();
+	changed_.clear();
+}
+
+// -----------------------------------------------------------------------------
+// Adds a watch for [dir] and all its subdirectories. If [mark_changed] is true,
+// everything within [dir] is also added to the changed paths (used for new
+// directories, which may have had things added before they were watched)
+// -----------------------------------------------------------------------------
+void DirWatcher::watchDir(const string& dir, bool mark_changed)
+{
+	static constexpr uint32_t mask = IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB | IN_MOVED_FROM
+									 | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR | IN_EXCL_UNLINK;
+
+	auto wd = inotify_add_watch(fd_, dir.c_str(), mask);
+	if (wd < 0)
+	{
+		// Running out of watches means changes will be missed
+		if (errno == ENOSPC)
+		{
+			log::warning("Unable to watch {} for changes: inotify watch limit reached", dir);
+			rescan_needed_ = true;
+		}
+		return;
+	}
+	watch_dirs_[wd] = dir;
+
+	// Go through directory contents
+	std::error_code ec;
+	for (const auto& item : std::filesystem::directory_iterator{ dir, ec })
+	{
+		auto name = item.path().filename().string();
+		if (ignore_hidden_ && strutil::startsWith(name, '.'))
+			continue;
+
+		auto path = fmt::format("{}/{}", dir, name);
+		if (mark_changed)
+			changed_.insert(path);
+
+		if (item.is_directory(ec) && !item.is_symlink(ec))
+			watchDir(path, mark_changed);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Reads all pending inotify events and updates the changed paths list
+// -----------------------------------------------------------------------------
+void DirWatcher::readEvents()
+{
+	alignas(inotify_event) char buffer[8192];
+
+	while (true)
+	{
+		auto len = read(fd_, buffer, sizeof(buffer));
+		if (len <= 0)
+			break;
+
+		for (ssize_t pos = 0; pos < len;)
+		{
+			const auto* event = reinterpret_cast<const inotify_event*>(buffer + pos);
+			pos += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+			// Event queue overflowed, changes have been lost
+			if (event->mask & IN_Q_OVERFLOW)
+			{
+				rescan_needed_ = true;
+				continue;
+			}
+
+			auto dir = watch_dirs_.find(event->wd);
+			if (dir == watch_dirs_.end())
+				continue;
+
+			// Event for a watched directory itself
+			if (event->len == 0 || event->name[0] == 0)
+			{
+				if (event->mask & IN_IGNORED)
+					watch_dirs_.erase(dir);
+				else if (event->mask & IN_DELETE_SELF)
+					changed_.insert(dir->second);
+				else if (event->mask & IN_MOVE_SELF)
+					rescan_needed_ = true; // Paths under the moved directory are no longer known
+
+				continue;
+			}
+
+			string_view name{ event->name };
+			if (ignore_hidden_ && strutil::startsWith(name, '.'))
+				continue;
+
+			auto path = fmt::format("{}/{}", dir->second, name);
+			changed_.insert(path);
+
+			if (event->mask & IN_ISDIR)
+			{
+				// Watch new directories (and check anything already in them)
+				if (event->mask & IN_CREATE)
+					watchDir(path, true);
+
+				// Directories moved within the tree would need all watched paths
+				// below them updated, just rescan instead
+				else if (event->mask & (IN_MOVED_FROM | IN_MOVED_TO))
+					rescan_needed_ = true;
+			}
+		}
+	}
+}
+#endif
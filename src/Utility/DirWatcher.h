@@ -0,0 +1,46 @@
+#pragma once
+
+#include <unordered_set>
+
+namespace slade
+{
+// -----------------------------------------------------------------------------
+// Watches a directory tree for changes using file system notifications, and
+// keeps a list of paths that have changed since they were last requested.
+//
+// Currently only implemented on Linux (inotify), elsewhere the watcher is
+// never active and changedPaths will always report that a full rescan is needed
+// -----------------------------------------------------------------------------
+class DirWatcher
+{
+public:
+	DirWatcher(string_view path, bool ignore_hidden = true);
+	~DirWatcher();
+
+	// Non-copyable
+	DirWatcher(const DirWatcher&)            = delete;
+	DirWatcher& operator=(const DirWatcher&) = delete;
+
+	const string& path() const { return path_; }
+	bool          isActive() const;
+
+	bool changedPaths(vector<string>& paths);
+	void markChanged(string_view path);
+
+private:
+	string path_;
+	bool   ignore_hidden_ = true;
+
+#ifdef __linux__
+	int                             fd_ = -1;
+	std::unordered_map<int, string> watch_dirs_; // Watch descriptor -> directory path
+	std::unordered_set<string>      changed_;
+	bool                            rescan_needed_ = false;
+
+	void start();
+	void stop();
+	void watchDir(const string& dir, bool mark_changed);
+	void readEvents();
+#endif
+};
+} // namespace slade
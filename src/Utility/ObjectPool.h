@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstddef>
+
+namespace slade
+{
+// -----------------------------------------------------------------------------
+// A simple fixed-size allocator for objects of type T.
+//
+// Memory is allocated in blocks (of at least [BlockSize] objects), so objects
+// allocated one after another end up next to each other in memory. Freed slots
+// are kept in a free list and reused by later allocations, and all blocks are
+// released once every object allocated from the pool has been freed.
+//
+// Each allocation records the pool it came from, so objects can be freed
+// without knowing which pool (if any) they were allocated from. Objects too
+// big for a slot (eg. of a derived class) or allocated without a pool go to
+// the general heap instead.
+//
+// Addresses of allocated objects never change. A pool isn't thread-safe, and
+// must outlive everything allocated from it. This is intended to be used via
+// class-specific operator new/delete (see MapVertex etc.)
+// -----------------------------------------------------------------------------
+template<typename T, unsigned BlockSize = 1024> class ObjectPool
+{
+public:
+	ObjectPool() = default;
+	~ObjectPool() = default;
+
+	// Non-copyable
+	ObjectPool(const ObjectPool&)            = delete;
+	ObjectPool& operator=(const ObjectPool&) = delete;
+
+	size_t nAllocated() const { return n_allocated_; }
+	size_t nBlocks() const { return blocks_.size(); }
+
+	// Makes sure the next [count] allocations can be made without allocating
+	// any more memory, from a single block if possible
+	void reserve(size_t count)
+	{
+		if (count > n_free_)
+			addBlock(std::max<size_t>(count - n_free_, BlockSize));
+	}
+
+	// Allocates [size] bytes for an object from [pool], or from the heap if
+	// [pool] is null or [size] is bigger than a T
+	static void* allocate(size_t size, ObjectPool* pool = nullptr)
+	{
+		if (!pool || size > sizeof(T))
+		{
+			auto slot   = static_cast<Slot*>(::operator new(offsetof(Slot, data) + size));
+			slot->owner = nullptr;
+			return slot->data.storage;
+		}
+
+		if (!pool->free_)
+			pool->addBlock(BlockSize);
+
+		auto slot   = pool->free_;
+		pool->free_ = slot->data.next;
+		slot->owner = pool;
+		--pool->n_free_;
+		++pool->n_allocated_;
+
+		return slot->data.storage;
+	}
+
+	// Frees memory at [ptr] previously returned from allocate, returning it to
+	// the pool it was allocated from
+	static void free(void* ptr)
+	{
+		if (!ptr)
+			return;
+
+		auto slot = reinterpret_cast<Slot*>(static_cast<unsigned char*>(ptr) - offsetof(Slot, data));
+		auto pool = slot->owner;
+		if (!pool)
+		{
+			::operator delete(slot);
+			return;
+		}
+
+		slot->data.next = pool->free_;
+		pool->free_     = slot;
+		++pool->n_free_;
+
+		// Release all memory once everything has been freed (eg. map closed)
+		if (--pool->n_allocated_ == 0)
+		{
+			pool->blocks_.clear();
+			pool->free_   = nullptr;
+			pool->n_free_ = 0;
+		}
+	}
+
+private:
+	struct Slot
+	{
+		ObjectPool* owner; // Null if allocated from the heap
+		union
+		{
+			Slot*                    next;
+			alignas(T) unsigned char storage[sizeof(T)];
+		} data;
+	};
+
+	vector<unique_ptr<Slot[]>> blocks_;
+	Slot*                      free_        = nullptr;
+	size_t                     n_free_      = 0;
+	size_t                     n_allocated_ = 0;
+
+	void addBlock(size_t size)
+	{
+		blocks_.emplace_back(new Slot[size]);
+
+		// Link the new slots in order, so consecutive allocations are adjacent
+		auto block = blocks_.back().get();
+		for (size_t a = 0; a < size - 1; ++a)
+			block[a].data.next = &block[a + 1];
+		block[size - 1].data.next = free_;
+		free_                     = block;
+		n_free_ += size;
+	}
+};
+} // namespace slade
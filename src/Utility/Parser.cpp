@@ -598,12 +598,14 @@ bool Parser::parseText(MemChunk& mc, string_view source) const
 	// Do parsing
 	return pt_root_->parse(tz);
 }
-bool Parser::parseText(string_view text, string_view source) const
+bool Parser::parseText(string_view text, string_view source, unsigned first_line) const
 {
 	Tokenizer tz;
 
-	// Open the given text data
+	// Open the given text data ([first_line] is the line number it starts at,
+	// if it's part of some larger text)
 	tz.setReadLowerCase(!case_sensitive_);
+	tz.setFirstLine(first_line);
 	if (!tz.openString(text, 0, 0, source))
 	{
 		log::error("Unable to open text data for parsing");
@@ -85,7 +85,7 @@ public:
 	void setCaseSensitive(bool cs) { case_sensitive_ = cs; }
 
 	bool parseText(MemChunk& mc, string_view source = "memory chunk") const;
-	bool parseText(string_view text, string_view source = "string") const;
+	bool parseText(string_view text, string_view source = "string", unsigned first_line = 1) const;
 	void define(string_view def);
 	bool defined(string_view def) const;
 
@@ -36,6 +36,7 @@
 #include "MathStuff.h"
 #include "OpenGL/GLTexture.h"
 #include "OpenGL/OpenGL.h"
+#include "PolygonTriangulator.h"
 #include "SLADEMap/SLADEMap.h"
 
 using namespace slade;
@@ -47,6 +48,7 @@ using namespace slade;
 //
 // -----------------------------------------------------------------------------
 constexpr int VERTEX_SIZE = 20;
+CVAR(Bool, map_poly_triangulate, true, CVar::Flag::Save)
 
 
 // -----------------------------------------------------------------------------
@@ -122,6 +124,23 @@ unsigned Polygon2D::totalVertices() const
 	return total;
 }
 
+double Polygon2D::area() const
+{
+	// Total area of all sub-polygons (which are clockwise)
+	double total = 0.;
+	for (auto& subpoly : subpolys_)
+	{
+		auto& verts = subpoly.vertices;
+		for (unsigned v = 0; v < verts.size(); v++)
+		{
+			auto& v1 = verts[v];
+			auto& v2 = verts[(v + 1) % verts.size()];
+			total -= (static_cast<double>(v1.x) * v2.y - static_cast<double>(v2.x) * v1.y) * 0.5;
+		}
+	}
+	return total;
+}
+
 bool Polygon2D::openSector(MapSector* sector)
 {
 	// Check sector was given
@@ -129,9 +148,27 @@ bool Polygon2D::openSector(MapSector* sector)
 		return false;
 
 	// Init
-	PolygonSplitter splitter;
 	clear();
 
+	// Use the triangulator if enabled, falling back to the splitter if it fails
+	// or the triangles don't cover the whole sector (allowing for float vertex
+	// precision)
+	if (map_poly_triangulate)
+	{
+		PolygonTriangulator triangulator;
+		triangulator.openSector(sector);
+		if (triangulator.triangulate(this))
+		{
+			auto sector_area = triangulator.area();
+			if (std::abs(area() - sector_area) <= std::max(1., sector_area * 0.0001))
+				return true;
+		}
+
+		clear();
+	}
+
+	PolygonSplitter splitter;
+
 	// Get list of sides connected to this sector
 	auto& sides = sector->connectedSides();
 
@@ -235,6 +272,22 @@ unsigned Polygon2D::writeToVBO(unsigned offset)
 	return offset;
 }
 
+unsigned Polygon2D::writeToBuffer(uint8_t* buffer, unsigned offset)
+{
+	// Same as writeToVBO, but copies to [buffer] so that the data can be
+	// prepared off the render thread and uploaded later
+	for (auto& subpoly : subpolys_)
+	{
+		unsigned length = subpoly.vertices.size() * VERTEX_SIZE;
+		memcpy(buffer + offset, subpoly.vertices.data(), length);
+		offset += length;
+	}
+
+	vbo_update_ = 0;
+
+	return offset;
+}
+
 void Polygon2D::render() const
 {
 	// Go through sub-polys
@@ -41,6 +41,7 @@ public:
 	void     removeSubPoly(unsigned index);
 	void     clear();
 	unsigned totalVertices() const;
+	double   area() const;
 
 	bool openSector(MapSector* sector);
 	void updateTextureCoords(
@@ -52,6 +53,7 @@ public:
 
 	unsigned vboDataSize() const;
 	unsigned writeToVBO(unsigned offset);
+	unsigned writeToBuffer(uint8_t* buffer, unsigned offset);
 
 	void render() const;
 	void renderWireframe() const;
@@ -0,0 +1,1200 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2022 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    PolygonTriangulator.cpp
+// Description: PolygonTriangulator class - ear clipping triangulation of
+//              (sector) polygons with holes, into convex sub-polygons
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+//
+// The ear clipping implementation (the EarClipper class and the Node functions
+// it uses) is adapted from earcut (https://github.com/mapbox/earcut), which is
+// distributed under the following licence:
+//
+// ISC License
+//
+// Copyright (c) 2016, Mapbox
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH REGARD
+// TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+// FITNESS. IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT,
+// OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF
+// USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+// TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+// OF THIS SOFTWARE.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "PolygonTriangulator.h"
+#include "MathStuff.h"
+#include "SLADEMap/MapObject/MapLine.h"
+#include "SLADEMap/MapObject/MapSector.h"
+#include "SLADEMap/MapObject/MapSide.h"
+#include "SLADEMap/MapObject/MapVertex.h"
+#include <deque>
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+using Triangle = std::array<unsigned, 3>;
+
+// The ear clipping below is adapted from the mapbox 'earcut' library (see the
+// licence notice at the top of this file): polygons are circular doubly
+// linked lists of nodes, holes are joined to the outer outline via bridges
+// (David Eberly's method), and for larger polygons nodes are also linked in
+// z-order so that ear tests only need to check nearby nodes
+struct Node
+{
+	unsigned i; // Vertex index
+	double   x, y;
+	Node*    prev    = nullptr;
+	Node*    next    = nullptr;
+	uint32_t z       = 0; // Z-order curve value
+	Node*    prev_z  = nullptr;
+	Node*    next_z  = nullptr;
+	bool     steiner = false;
+
+	Node(unsigned i, double x, double y) : i{ i }, x{ x }, y{ y } {}
+};
+
+// -----------------------------------------------------------------------------
+// Returns the signed area of the triangle [p,q,r] (negative if anticlockwise)
+// -----------------------------------------------------------------------------
+double area(const Node* p, const Node* q, const Node* r)
+{
+	return (q->y - p->y) * (r->x - q->x) - (q->x - p->x) * (r->y - q->y);
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if nodes [p1] and [p2] are at the same position
+// -----------------------------------------------------------------------------
+bool equals(const Node* p1, const Node* p2)
+{
+	return p1->x == p2->x && p1->y == p2->y;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the sign of [num] (-1, 0 or 1)
+// -----------------------------------------------------------------------------
+int sign(double num)
+{
+	return num > 0. ? 1 : num < 0. ? -1 : 0;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if point [p] lies within the triangle [a,b,c]
+// -----------------------------------------------------------------------------
+bool pointInTriangle(double ax, double ay, double bx, double by, double cx, double cy, double px, double py)
+{
+	return (cx - px) * (ay - py) >= (ax - px) * (cy - py) && (ax - px) * (by - py) >= (bx - px) * (ay - py)
+		   && (bx - px) * (cy - py) >= (cx - px) * (by - py);
+}
+
+// -----------------------------------------------------------------------------
+// For collinear points [p], [q] and [r], returns true if [q] lies on the
+// segment [p,r]
+// -----------------------------------------------------------------------------
+bool onSegment(const Node* p, const Node* q, const Node* r)
+{
+	return q->x <= std::max(p->x, r->x) && q->x >= std::min(p->x, r->x) && q->y <= std::max(p->y, r->y)
+		   && q->y >= std::min(p->y, r->y);
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if segments [p1,q1] and [p2,q2] intersect
+// -----------------------------------------------------------------------------
+bool intersects(const Node* p1, const Node* q1, const Node* p2, const Node* q2)
+{
+	auto o1 = sign(area(p1, q1, p2));
+	auto o2 = sign(area(p1, q1, q2));
+	auto o3 = sign(area(p2, q2, p1));
+	auto o4 = sign(area(p2, q2, q1));
+
+	if (o1 != o2 && o3 != o4)
+		return true;
+
+	// Collinear cases
+	return (o1 == 0 && onSegment(p1, p2, q1)) || (o2 == 0 && onSegment(p1, q2, q1))
+		   || (o3 == 0 && onSegment(p2, p1, q2)) || (o4 == 0 && onSegment(p2, q1, q2));
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the diagonal [a,b] intersects any polygon edge
+// -----------------------------------------------------------------------------
+bool intersectsPolygon(const Node* a, const Node* b)
+{
+	auto p = a;
+	do
+	{
+		if (p->i != a->i && p->next->i != a->i && p->i != b->i && p->next->i != b->i
+			&& intersects(p, p->next, a, b))
+			return true;
+		p = p->next;
+	} while (p != a);
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the diagonal [a,b] is locally inside the polygon at [a]
+// -----------------------------------------------------------------------------
+bool locallyInside(const Node* a, const Node* b)
+{
+	return area(a->prev, a, a->next) < 0. ? area(a, b, a->next) >= 0. && area(a, a->prev, b) >= 0. :
+											area(a, b, a->prev) < 0. || area(a, a->next, b) < 0.;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the middle point of the diagonal [a,b] is inside the polygon
+// -----------------------------------------------------------------------------
+bool middleInside(const Node* a, const Node* b)
+{
+	auto   p      = a;
+	bool   inside = false;
+	double px     = (a->x + b->x) / 2.;
+	double py     = (a->y + b->y) / 2.;
+	do
+	{
+		if (((p->y > py) != (p->next->y > py)) && p->next->y != p->y
+			&& (px < (p->next->x - p->x) * (py - p->y) / (p->next->y - p->y) + p->x))
+			inside = !inside;
+		p = p->next;
+	} while (p != a);
+
+	return inside;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the diagonal [a,b] is valid (lies within the polygon)
+// -----------------------------------------------------------------------------
+bool isValidDiagonal(const Node* a, const Node* b)
+{
+	// Doesn't intersect other edges
+	if (a->next->i == b->i || a->prev->i == b->i || intersectsPolygon(a, b))
+		return false;
+
+	// Locally visible, and doesn't create opposite-facing sectors
+	if (locallyInside(a, b) && locallyInside(b, a) && middleInside(a, b)
+		&& (area(a->prev, a, b->prev) != 0. || area(a, b->prev, b) != 0.))
+		return true;
+
+	// Special zero-length case
+	return equals(a, b) && area(a->prev, a, a->next) > 0. && area(b->prev, b, b->next) > 0.;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the (vertex) sector at [m] contains the sector at [p]
+// -----------------------------------------------------------------------------
+bool sectorContainsSector(const Node* m, const Node* p)
+{
+	return area(m->prev, m, p->prev) < 0. && area(p->next, m, m->next) < 0.;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the leftmost node of the polygon starting at [start]
+// -----------------------------------------------------------------------------
+Node* leftmost(Node* start)
+{
+	auto p        = start;
+	auto leftmost = start;
+	do
+	{
+		if (p->x < leftmost->x || (p->x == leftmost->x && p->y < leftmost->y))
+			leftmost = p;
+		p = p->next;
+	} while (p != start);
+
+	return leftmost;
+}
+
+// -----------------------------------------------------------------------------
+// Unlinks node [p] from its polygon (and z-order) lists
+// -----------------------------------------------------------------------------
+void removeNode(Node* p)
+{
+	p->next->prev = p->prev;
+	p->prev->next = p->next;
+
+	if (p->prev_z)
+		p->prev_z->next_z = p->next_z;
+	if (p->next_z)
+		p->next_z->prev_z = p->prev_z;
+}
+
+// -----------------------------------------------------------------------------
+// Sorts the z-order linked list starting at [list] by z value
+// (Simon Tatham's linked list merge sort)
+// -----------------------------------------------------------------------------
+void sortLinked(Node* list)
+{
+	unsigned in_size = 1;
+	unsigned num_merges;
+	do
+	{
+		auto  p    = list;
+		Node* tail = nullptr;
+		list       = nullptr;
+		num_merges = 0;
+
+		while (p)
+		{
+			num_merges++;
+			auto     q      = p;
+			unsigned p_size = 0;
+			for (unsigned a = 0; a < in_size; a++)
+			{
+				p_size++;
+				q = q->next_z;
+				if (!q)
+					break;
+			}
+			unsigned q_size = in_size;
+
+			while (p_size > 0 || (q_size > 0 && q))
+			{
+				Node* e;
+				if (p_size != 0 && (q_size == 0 || !q || p->z <= q->z))
+				{
+					e = p;
+					p = p->next_z;
+					p_size--;
+				}
+				else
+				{
+					e = q;
+					q = q->next_z;
+					q_size--;
+				}
+
+				if (tail)
+					tail->next_z = e;
+				else
+					list = e;
+
+				e->prev_z = tail;
+				tail      = e;
+			}
+
+			p = q;
+		}
+
+		tail->next_z = nullptr;
+		in_size *= 2;
+	} while (num_merges > 1);
+}
+
+
+// -----------------------------------------------------------------------------
+// EarClipper class
+//
+// Triangulates a single outline and its holes, adding the resulting
+// (anticlockwise) triangles to a list
+// -----------------------------------------------------------------------------
+class EarClipper
+{
+public:
+	EarClipper(const vector<Vec2d>& vertices, vector<Triangle>& triangles) :
+		vertices_{ vertices },
+		triangles_{ triangles }
+	{
+	}
+
+	void triangulate(const vector<unsigned>& outer, const vector<const vector<unsigned>*>& holes)
+	{
+		auto outer_node = linkedList(outer, true);
+		if (!outer_node || outer_node->next == outer_node->prev)
+			return;
+
+		unsigned n_vertices = outer.size();
+		if (!holes.empty())
+		{
+			for (auto* hole : holes)
+				n_vertices += hole->size();
+			outer_node = eliminateHoles(holes, outer_node);
+		}
+
+		// Use z-order hashing for ear tests if the polygon isn't too simple
+		if (n_vertices > 80)
+		{
+			min_x_     = vertices_[outer[0]].x;
+			min_y_     = vertices_[outer[0]].y;
+			auto max_x = min_x_;
+			auto max_y = min_y_;
+			for (auto v : outer)
+			{
+				min_x_ = std::min(min_x_, vertices_[v].x);
+				min_y_ = std::min(min_y_, vertices_[v].y);
+				max_x  = std::max(max_x, vertices_[v].x);
+				max_y  = std::max(max_y, vertices_[v].y);
+			}
+
+			inv_size_ = std::max(max_x - min_x_, max_y - min_y_);
+			inv_size_ = inv_size_ != 0. ? 32767. / inv_size_ : 0.;
+		}
+
+		earcutLinked(outer_node, 0);
+	}
+
+private:
+	const vector<Vec2d>& vertices_;
+	vector<Triangle>&    triangles_;
+	std::deque<Node>     nodes_; // Deque so node pointers stay valid
+	double               min_x_    = 0.;
+	double               min_y_    = 0.;
+	double               inv_size_ = 0.;
+
+	// -------------------------------------------------------------------------
+	// Creates a node for vertex [i], linked after [last] (if given)
+	// -------------------------------------------------------------------------
+	Node* insertNode(unsigned i, Node* last)
+	{
+		auto p = &nodes_.emplace_back(i, vertices_[i].x, vertices_[i].y);
+
+		if (!last)
+		{
+			p->prev = p;
+			p->next = p;
+		}
+		else
+		{
+			p->next          = last->next;
+			p->prev          = last;
+			last->next->prev = p;
+			last->next       = p;
+		}
+
+		return p;
+	}
+
+	// -------------------------------------------------------------------------
+	// Creates a circular linked list of nodes for the [outline] vertices, in
+	// the specified winding order
+	// -------------------------------------------------------------------------
+	Node* linkedList(const vector<unsigned>& outline, bool clockwise)
+	{
+		double sum = 0.;
+		for (unsigned a = 0, b = outline.size() - 1; a < outline.size(); b = a++)
+		{
+			auto& va = vertices_[outline[a]];
+			auto& vb = vertices_[outline[b]];
+			sum += (vb.x - va.x) * (va.y + vb.y);
+		}
+
+		Node* last = nullptr;
+		if (clockwise == (sum > 0.))
+			for (auto i : outline)
+				last = insertNode(i, last);
+		else
+			for (auto i = outline.rbegin(); i != outline.rend(); ++i)
+				last = insertNode(*i, last);
+
+		if (last && equals(last, last->next))
+		{
+			removeNode(last);
+			last = last->next;
+		}
+
+		return last;
+	}
+
+	// -------------------------------------------------------------------------
+	// Removes duplicate and collinear nodes between [start] and [end]
+	// -------------------------------------------------------------------------
+	static Node* filterPoints(Node* start, Node* end = nullptr)
+	{
+		if (!start)
+			return start;
+		if (!end)
+			end = start;
+
+		auto p = start;
+		bool again;
+		do
+		{
+			again = false;
+
+			if (!p->steiner && (equals(p, p->next) || area(p->prev, p, p->next) == 0.))
+			{
+				removeNode(p);
+				p = end = p->prev;
+				if (p == p->next)
+					break;
+				again = true;
+			}
+			else
+				p = p->next;
+		} while (again || p != end);
+
+		return end;
+	}
+
+	// -------------------------------------------------------------------------
+	// Returns the z-order curve value for the point at [x,y]
+	// -------------------------------------------------------------------------
+	uint32_t zOrder(double x, double y) const
+	{
+		// Coords are transformed into the non-negative 15-bit integer range
+		auto zx = static_cast<uint32_t>((x - min_x_) * inv_size_);
+		auto zy = static_cast<uint32_t>((y - min_y_) * inv_size_);
+
+		zx = (zx | (zx << 8)) & 0x00FF00FF;
+		zx = (zx | (zx << 4)) & 0x0F0F0F0F;
+		zx = (zx | (zx << 2)) & 0x33333333;
+		zx = (zx | (zx << 1)) & 0x55555555;
+
+		zy = (zy | (zy << 8)) & 0x00FF00FF;
+		zy = (zy | (zy << 4)) & 0x0F0F0F0F;
+		zy = (zy | (zy << 2)) & 0x33333333;
+		zy = (zy | (zy << 1)) & 0x55555555;
+
+		return zx | (zy << 1);
+	}
+
+	// -------------------------------------------------------------------------
+	// Links the polygon nodes starting at [start] in z-order
+	// -------------------------------------------------------------------------
+	void indexCurve(Node* start) const
+	{
+		auto p = start;
+		do
+		{
+			if (p->z == 0)
+				p->z = zOrder(p->x, p->y);
+			p->prev_z = p->prev;
+			p->next_z = p->next;
+			p         = p->next;
+		} while (p != start);
+
+		p->prev_z->next_z = nullptr;
+		p->prev_z         = nullptr;
+
+		sortLinked(p);
+	}
+
+	// -------------------------------------------------------------------------
+	// Returns true if [ear] forms a valid ear with its neighbouring nodes
+	// -------------------------------------------------------------------------
+	static bool isEar(const Node* ear)
+	{
+		auto a = ear->prev;
+		auto b = ear;
+		auto c = ear->next;
+
+		// Reflex, can't be an ear
+		if (area(a, b, c) >= 0.)
+			return false;
+
+		// Triangle bbox
+		auto x0 = std::min({ a->x, b->x, c->x });
+		auto y0 = std::min({ a->y, b->y, c->y });
+		auto x1 = std::max({ a->x, b->x, c->x });
+		auto y1 = std::max({ a->y, b->y, c->y });
+
+		// Check no other nodes are within the ear
+		auto p = c->next;
+		while (p != a)
+		{
+			if (p->x >= x0 && p->x <= x1 && p->y >= y0 && p->y <= y1
+				&& pointInTriangle(a->x, a->y, b->x, b->y, c->x, c->y, p->x, p->y)
+				&& area(p->prev, p, p->next) >= 0.)
+				return false;
+			p = p->next;
+		}
+
+		return true;
+	}
+
+	// -------------------------------------------------------------------------
+	// Returns true if [ear] forms a valid ear with its neighbouring nodes,
+	// only checking nodes within the ear's z-order range
+	// -------------------------------------------------------------------------
+	bool isEarHashed(const Node* ear) const
+	{
+		auto a = ear->prev;
+		auto b = ear;
+		auto c = ear->next;
+
+		// Reflex, can't be an ear
+		if (area(a, b, c) >= 0.)
+			return false;
+
+		// Triangle bbox
+		auto x0 = std::min({ a->x, b->x, c->x });
+		auto y0 = std::min({ a->y, b->y, c->y });
+		auto x1 = std::max({ a->x, b->x, c->x });
+		auto y1 = std::max({ a->y, b->y, c->y });
+
+		// Z-order range for the triangle bbox
+		auto min_z = zOrder(x0, y0);
+		auto max_z = zOrder(x1, y1);
+
+		auto inEar = [&](const Node* p)
+		{
+			return p->x >= x0 && p->x <= x1 && p->y >= y0 && p->y <= y1 && p != a && p != c
+				   && pointInTriangle(a->x, a->y, b->x, b->y, c->x, c->y, p->x, p->y)
+				   && area(p->prev, p, p->next) >= 0.;
+		};
+
+		// Look for nodes within the ear in both directions
+		auto p = ear->prev_z;
+		auto n = ear->next_z;
+		while (p && p->z >= min_z && n && n->z <= max_z)
+		{
+			if (inEar(p))
+				return false;
+			p = p->prev_z;
+
+			if (inEar(n))
+				return false;
+			n = n->next_z;
+		}
+
+		// Remaining nodes in decreasing z-order
+		while (p && p->z >= min_z)
+		{
+			if (inEar(p))
+				return false;
+			p = p->prev_z;
+		}
+
+		// Remaining nodes in increasing z-order
+		while (n && n->z <= max_z)
+		{
+			if (inEar(n))
+				return false;
+			n = n->next_z;
+		}
+
+		return true;
+	}
+
+	// -------------------------------------------------------------------------
+	// Adds the triangle [a,b,c] to the output
+	// -------------------------------------------------------------------------
+	void addTriangle(const Node* a, const Node* b, const Node* c) const
+	{
+		triangles_.push_back({ a->i, b->i, c->i });
+	}
+
+	// -------------------------------------------------------------------------
+	// Main ear slicing loop, triangulates the polygon starting at [ear]. If no
+	// more ears can be found, tries again after filtering points ([pass] 1),
+	// curing local self-intersections ([pass] 2) and finally splitting the
+	// remaining polygon in two
+	// -------------------------------------------------------------------------
+	void earcutLinked(Node* ear, int pass)
+	{
+		if (!ear)
+			return;
+
+		// Interlink polygon nodes in z-order
+		if (pass == 0 && inv_size_ != 0.)
+			indexCurve(ear);
+
+		auto stop = ear;
+
+		// Slice ears one by one
+		while (ear->prev != ear->next)
+		{
+			auto prev = ear->prev;
+			auto next = ear->next;
+
+			if (inv_size_ != 0. ? isEarHashed(ear) : isEar(ear))
+			{
+				addTriangle(prev, ear, next);
+				removeNode(ear);
+
+				// Skipping the next node leads to less sliver triangles
+				ear  = next->next;
+				stop = next->next;
+				continue;
+			}
+
+			ear = next;
+
+			// Looped through the whole remaining polygon without finding an ear
+			if (ear == stop)
+			{
+				if (pass == 0)
+					earcutLinked(filterPoints(ear), 1);
+				else if (pass == 1)
+					earcutLinked(cureLocalIntersections(filterPoints(ear)), 2);
+				else if (pass == 2)
+					splitEarcut(ear);
+
+				break;
+			}
+		}
+	}
+
+	// -------------------------------------------------------------------------
+	// Removes small local self-intersections from the polygon starting at
+	// [start], adding a triangle for each
+	// -------------------------------------------------------------------------
+	Node* cureLocalIntersections(Node* start) const
+	{
+		auto p = start;
+		do
+		{
+			auto a = p->prev;
+			auto b = p->next->next;
+
+			if (!equals(a, b) && intersects(a, p, p->next, b) && locallyInside(a, b) && locallyInside(b, a))
+			{
+				addTriangle(a, p, b);
+
+				// Remove the two nodes involved
+				removeNode(p);
+				removeNode(p->next);
+
+				p = start = b;
+			}
+
+			p = p->next;
+		} while (p != start);
+
+		return filterPoints(p);
+	}
+
+	// -------------------------------------------------------------------------
+	// Splits the polygon starting at [start] in two along a valid diagonal and
+	// triangulates each half separately
+	// -------------------------------------------------------------------------
+	void splitEarcut(Node* start)
+	{
+		auto a = start;
+		do
+		{
+			auto b = a->next->next;
+			while (b != a->prev)
+			{
+				if (a->i != b->i && isValidDiagonal(a, b))
+				{
+					auto c = splitPolygon(a, b);
+
+					// Filter collinear points around the cuts
+					a = filterPoints(a, a->next);
+					c = filterPoints(c, c->next);
+
+					earcutLinked(a, 0);
+					earcutLinked(c, 0);
+					return;
+				}
+				b = b->next;
+			}
+			a = a->next;
+		} while (a != start);
+	}
+
+	// -------------------------------------------------------------------------
+	// Links nodes [a] and [b] with a bridge. If they are in the same polygon
+	// it is split in two, otherwise (eg. a hole) the polygons are joined.
+	// Returns the new node created for [b]
+	// -------------------------------------------------------------------------
+	Node* splitPolygon(Node* a, Node* b)
+	{
+		auto a2 = &nodes_.emplace_back(a->i, a->x, a->y);
+		auto b2 = &nodes_.emplace_back(b->i, b->x, b->y);
+		auto an = a->next;
+		auto bp = b->prev;
+
+		a->next  = b;
+		b->prev  = a;
+		a2->next = an;
+		an->prev = a2;
+		b2->next = a2;
+		a2->prev = b2;
+		bp->next = b2;
+		b2->prev = bp;
+
+		return b2;
+	}
+
+	// -------------------------------------------------------------------------
+	// Links every hole into the outer polygon, left to right
+	// -------------------------------------------------------------------------
+	Node* eliminateHoles(const vector<const vector<unsigned>*>& holes, Node* outer_node)
+	{
+		vector<Node*> queue;
+		for (auto* hole : holes)
+		{
+			auto list = linkedList(*hole, false);
+			if (!list)
+				continue;
+			if (list == list->next)
+				list->steiner = true;
+			queue.push_back(leftmost(list));
+		}
+
+		std::sort(queue.begin(), queue.end(), [](const Node* a, const Node* b) { return a->x < b->x; });
+
+		for (auto* hole : queue)
+			outer_node = eliminateHole(hole, outer_node);
+
+		return outer_node;
+	}
+
+	// -------------------------------------------------------------------------
+	// Finds a bridge between [hole] and the outer polygon and links them
+	// -------------------------------------------------------------------------
+	Node* eliminateHole(Node* hole, Node* outer_node)
+	{
+		auto bridge = findHoleBridge(hole, outer_node);
+		if (!bridge)
+			return outer_node;
+
+		auto bridge_reverse = splitPolygon(bridge, hole);
+
+		// Filter collinear points around the cuts
+		filterPoints(bridge_reverse, bridge_reverse->next);
+		return filterPoints(bridge, bridge->next);
+	}
+
+	// -------------------------------------------------------------------------
+	// Finds a node on the outer polygon visible from the (leftmost) [hole] node
+	// (David Eberly's algorithm)
+	// -------------------------------------------------------------------------
+	static Node* findHoleBridge(Node* hole, Node* outer_node)
+	{
+		auto   p  = outer_node;
+		double hx = hole->x;
+		double hy = hole->y;
+		double qx = -std::numeric_limits<double>::infinity();
+		Node*  m  = nullptr;
+
+		// Find a segment intersected by a ray from the hole's leftmost point to
+		// the left; the segment's endpoint with lesser x will be the potential
+		// connection point
+		do
+		{
+			if (hy <= p->y && hy >= p->next->y && p->next->y != p->y)
+			{
+				double x = p->x + (hy - p->y) * (p->next->x - p->x) / (p->next->y - p->y);
+				if (x <= hx && x > qx)
+				{
+					qx = x;
+					m  = p->x < p->next->x ? p : p->next;
+					if (x == hx)
+						return m; // Hole touches the outer segment
+				}
+			}
+			p = p->next;
+		} while (p != outer_node);
+
+		if (!m)
+			return nullptr;
+
+		// Look for nodes inside the triangle of the hole point, segment
+		// intersection and endpoint. If there are none, we have a valid
+		// connection, otherwise choose the node with the minimum angle to the
+		// ray as the connection point
+		auto   stop    = m;
+		double mx      = m->x;
+		double my      = m->y;
+		double tan_min = std::numeric_limits<double>::infinity();
+		p              = m;
+		do
+		{
+			if (hx >= p->x && p->x >= mx && hx != p->x
+				&& pointInTriangle(hy < my ? hx : qx, hy, mx, my, hy < my ? qx : hx, hy, p->x, p->y))
+			{
+				double tan = std::abs(hy - p->y) / (hx - p->x);
+				if (locallyInside(p, hole)
+					&& (tan < tan_min
+						|| (tan == tan_min && (p->x > m->x || (p->x == m->x && sectorContainsSector(m, p))))))
+				{
+					m       = p;
+					tan_min = tan;
+				}
+			}
+			p = p->next;
+		} while (p != stop);
+
+		return m;
+	}
+};
+
+// -----------------------------------------------------------------------------
+// Returns the index of directed edge [v1]->[v2] in [poly], or -1 if it isn't
+// found
+// -----------------------------------------------------------------------------
+int findEdge(const vector<unsigned>& poly, unsigned v1, unsigned v2)
+{
+	for (unsigned a = 0; a < poly.size(); a++)
+		if (poly[a] == v1 && poly[(a + 1) % poly.size()] == v2)
+			return a;
+
+	return -1;
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// PolygonTriangulator Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Clears all edges and vertices
+// -----------------------------------------------------------------------------
+void PolygonTriangulator::clear()
+{
+	vertices_.clear();
+	vertex_edges_out_.clear();
+	edges_.clear();
+	vertex_map_.clear();
+	outlines_.clear();
+	area_ = 0.;
+}
+
+// -----------------------------------------------------------------------------
+// Adds a directed edge from [x1,y1] to [x2,y2]
+// -----------------------------------------------------------------------------
+void PolygonTriangulator::addEdge(double x1, double y1, double x2, double y2)
+{
+	auto v1 = addVertex(x1, y1);
+	auto v2 = addVertex(x2, y2);
+	if (v1 == v2)
+		return;
+
+	vertex_edges_out_[v1].push_back(edges_.size());
+	edges_.push_back({ v1, v2 });
+}
+
+// -----------------------------------------------------------------------------
+// Adds edges for all sides of [sector], ignoring lines with [sector] on both
+// sides
+// -----------------------------------------------------------------------------
+void PolygonTriangulator::openSector(MapSector* sector)
+{
+	clear();
+
+	if (!sector)
+		return;
+
+	for (auto* side : sector->connectedSides())
+	{
+		auto line = side->parentLine();
+		if (!line || line->doubleSector())
+			continue;
+
+		// Edge direction depends on what side of the line this is, so that the
+		// sector is always on the right
+		if (line->s1() == side)
+			addEdge(line->v1()->xPos(), line->v1()->yPos(), line->v2()->xPos(), line->v2()->yPos());
+		else
+			addEdge(line->v2()->xPos(), line->v2()->yPos(), line->v1()->xPos(), line->v1()->yPos());
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Triangulates the polygon defined by the current edges and adds the
+// resulting convex sub-polygons to [poly]. Returns false if no closed outlines
+// could be built from the edges
+// -----------------------------------------------------------------------------
+bool PolygonTriangulator::triangulate(Polygon2D* poly)
+{
+	if (!poly)
+		return false;
+
+	// Trace closed outlines
+	outlines_.clear();
+	for (auto& edge : edges_)
+		edge.done = false;
+	for (unsigned a = 0; a < edges_.size(); a++)
+		if (!edges_[a].done)
+			traceOutline(a);
+
+	assignHoles();
+
+	// Triangulate each outer (clockwise) outline along with its holes
+	vector<Triangle>                triangles;
+	vector<const vector<unsigned>*> holes;
+	for (const auto& outline : outlines_)
+	{
+		if (outline.area >= 0.)
+			continue;
+
+		holes.clear();
+		for (auto* hole : outline.holes)
+			holes.push_back(&hole->vertices);
+
+		triangles.clear();
+		EarClipper clipper(vertices_, triangles);
+		clipper.triangulate(outline.vertices, holes);
+
+		buildSubPolys(triangles, poly);
+	}
+
+	return poly->hasPolygon();
+}
+
+// -----------------------------------------------------------------------------
+// Returns the index of the vertex at [x,y], adding it if it doesn't exist
+// -----------------------------------------------------------------------------
+unsigned PolygonTriangulator::addVertex(double x, double y)
+{
+	auto [it, added] = vertex_map_.try_emplace({ x, y }, vertices_.size());
+	if (added)
+	{
+		vertices_.emplace_back(x, y);
+		vertex_edges_out_.emplace_back();
+	}
+
+	return it->second;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the edge following [edge] in an outline (the unused edge leaving its
+// end vertex with the smallest angle), or -1 if there is none.
+// [edge_start] is allowed even if used, to close the outline
+// -----------------------------------------------------------------------------
+int PolygonTriangulator::nextEdge(unsigned edge, unsigned edge_start) const
+{
+	const auto& e = edges_[edge];
+
+	double min_angle = 2 * math::PI;
+	int    next      = -1;
+	for (auto out : vertex_edges_out_[e.v2])
+	{
+		const auto& out_edge = edges_[out];
+
+		// Ignore used edges and edges on the reverse side of this
+		if ((out_edge.done && out != edge_start) || out_edge.v2 == e.v1)
+			continue;
+
+		auto angle = math::angle2DRad(vertices_[e.v1], vertices_[e.v2], vertices_[out_edge.v2]);
+		if (angle < min_angle)
+		{
+			min_angle = angle;
+			next      = out;
+		}
+	}
+
+	return next;
+}
+
+// -----------------------------------------------------------------------------
+// Traces a closed outline beginning with [edge_start] and adds it to the
+// outlines list. Returns false if the outline isn't closed
+// -----------------------------------------------------------------------------
+bool PolygonTriangulator::traceOutline(unsigned edge_start)
+{
+	Outline          outline;
+	vector<unsigned> traced;
+	double           sum  = 0.;
+	auto             edge = edge_start;
+
+	while (true)
+	{
+		auto& e = edges_[edge];
+		e.done  = true;
+		traced.push_back(edge);
+		outline.vertices.push_back(e.v1);
+		sum += vertices_[e.v1].x * vertices_[e.v2].y - vertices_[e.v2].x * vertices_[e.v1].y;
+
+		auto next = nextEdge(edge, edge_start);
+		if (next < 0)
+			break;
+
+		// Closed
+		if (next == static_cast<int>(edge_start))
+		{
+			outline.area = sum * 0.5;
+			if (outline.vertices.size() >= 3 && outline.area != 0.)
+				outlines_.push_back(std::move(outline));
+
+			return true;
+		}
+
+		edge = next;
+	}
+
+	// Not closed, release the traced edges so they can be part of other
+	// outlines (the first edge is left used so it isn't traced again)
+	for (auto e : traced)
+		if (e != edge_start)
+			edges_[e].done = false;
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [point] is within [outline]
+// -----------------------------------------------------------------------------
+bool PolygonTriangulator::pointInOutline(const Outline& outline, Vec2d point) const
+{
+	bool inside = false;
+	for (unsigned a = 0, b = outline.vertices.size() - 1; a < outline.vertices.size(); b = a++)
+	{
+		auto& va = vertices_[outline.vertices[a]];
+		auto& vb = vertices_[outline.vertices[b]];
+		if ((va.y > point.y) != (vb.y > point.y)
+			&& point.x < (vb.x - va.x) * (point.y - va.y) / (vb.y - va.y) + va.x)
+			inside = !inside;
+	}
+
+	return inside;
+}
+
+// -----------------------------------------------------------------------------
+// Assigns each hole (anticlockwise) outline to the smallest outer (clockwise)
+// outline that contains it, and calculates the total polygon area.
+// Holes that aren't within any outer outline are invalid and ignored
+// -----------------------------------------------------------------------------
+void PolygonTriangulator::assignHoles()
+{
+	area_ = 0.;
+	for (const auto& outline : outlines_)
+		if (outline.area < 0.)
+			area_ -= outline.area;
+
+	for (const auto& hole : outlines_)
+	{
+		if (hole.area <= 0.)
+			continue;
+
+		// Test a point just outside the hole, beside the middle of its first
+		// edge (outline edges have the polygon interior on their right)
+		auto& v1    = vertices_[hole.vertices[0]];
+		auto& v2    = vertices_[hole.vertices[1]];
+		auto  dir   = (v2 - v1).normalized();
+		auto  point = Vec2d{ (v1.x + v2.x) * 0.5 + dir.y * 0.01, (v1.y + v2.y) * 0.5 - dir.x * 0.01 };
+
+		Outline* container = nullptr;
+		for (auto& outer : outlines_)
+			if (outer.area < 0. && (!container || outer.area > container->area) && pointInOutline(outer, point))
+				container = &outer;
+
+		if (container)
+		{
+			container->holes.push_back(&hole);
+			area_ -= hole.area;
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Merges neighbouring [triangles] into convex polygons where possible and adds
+// them to [poly] as sub-polygons
+// -----------------------------------------------------------------------------
+void PolygonTriangulator::buildSubPolys(const vector<Triangle>& triangles, Polygon2D* poly) const
+{
+	auto edgeKey = [](unsigned v1, unsigned v2) { return static_cast<uint64_t>(v1) << 32 | v2; };
+	auto convex  = [this](unsigned prev, unsigned v, unsigned next)
+	{
+		auto& p = vertices_[prev];
+		auto& c = vertices_[v];
+		auto& n = vertices_[next];
+		return (c.x - p.x) * (n.y - c.y) - (c.y - p.y) * (n.x - c.x) >= 0.;
+	};
+
+	// Begin with a polygon for each (anticlockwise) triangle
+	vector<vector<unsigned>>               polys(triangles.size());
+	std::unordered_map<uint64_t, unsigned> edge_polys;
+	edge_polys.reserve(triangles.size() * 3);
+	for (unsigned t = 0; t < triangles.size(); t++)
+	{
+		polys[t].assign(triangles[t].begin(), triangles[t].end());
+		for (unsigned a = 0; a < 3; a++)
+			edge_polys[edgeKey(triangles[t][a], triangles[t][(a + 1) % 3])] = t;
+	}
+
+	// Merge polygons across each shared edge if the result stays convex
+	// (checking the two vertices at either end of the edge is enough, as both
+	// polygons are already convex)
+	for (const auto& triangle : triangles)
+	{
+		for (unsigned a = 0; a < 3; a++)
+		{
+			auto v1 = triangle[a];
+			auto v2 = triangle[(a + 1) % 3];
+			auto p1 = edge_polys.find(edgeKey(v1, v2));
+			auto p2 = edge_polys.find(edgeKey(v2, v1));
+			if (p1 == edge_polys.end() || p2 == edge_polys.end() || p1->second == p2->second)
+				continue;
+
+			auto  merged_index = p1->second;
+			auto& poly1        = polys[p1->second];
+			auto& poly2        = polys[p2->second];
+			auto  i1           = findEdge(poly1, v1, v2);
+			auto  i2           = findEdge(poly2, v2, v1);
+			if (i1 < 0 || i2 < 0)
+				continue;
+
+			unsigned n1 = poly1.size();
+			unsigned n2 = poly2.size();
+			if (!convex(poly1[(i1 + n1 - 1) % n1], v1, poly2[(i2 + 2) % n2])
+				|| !convex(poly2[(i2 + n2 - 1) % n2], v2, poly1[(i1 + 2) % n1]))
+				continue;
+
+			// Merge: [v2 ... v1] from poly1, then poly2 from after v1 to before v2
+			vector<unsigned> merged;
+			merged.reserve(n1 + n2 - 2);
+			for (unsigned b = 0; b < n1; b++)
+				merged.push_back(poly1[(i1 + 1 + b) % n1]);
+			for (unsigned b = 2; b < n2; b++)
+				merged.push_back(poly2[(i2 + b) % n2]);
+
+			edge_polys.erase(edgeKey(v1, v2));
+			edge_polys.erase(edgeKey(v2, v1));
+			poly2.clear();
+			poly1 = std::move(merged);
+			for (unsigned b = 0; b < poly1.size(); b++)
+				edge_polys[edgeKey(poly1[b], poly1[(b + 1) % poly1.size()])] = merged_index;
+		}
+	}
+
+	// Add sub-polygons, clockwise like those built by PolygonSplitter
+	for (const auto& verts : polys)
+	{
+		if (verts.size() < 3)
+			continue;
+
+		poly->addSubPoly();
+		auto sub = poly->subPoly(poly->nSubPolys() - 1);
+		sub->vertices.resize(verts.size());
+		for (unsigned a = 0; a < verts.size(); a++)
+		{
+			auto& vertex      = vertices_[verts[verts.size() - 1 - a]];
+			sub->vertices[a].x = vertex.x;
+			sub->vertices[a].y = vertex.y;
+		}
+	}
+}
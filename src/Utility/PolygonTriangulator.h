@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Polygon2D.h"
+#include <array>
+
+namespace slade
+{
+class MapSector;
+
+// Builds convex sub-polygons for a (possibly concave, possibly holed) polygon
+// given as a set of directed edges with the interior on their right side.
+// Closed outlines are traced from the edges, holes are bridged into the outer
+// outline containing them and the result is ear clipped, then neighbouring
+// triangles are merged back into convex sub-polygons where possible
+class PolygonTriangulator
+{
+public:
+	PolygonTriangulator()  = default;
+	~PolygonTriangulator() = default;
+
+	double area() const { return area_; }
+
+	void clear();
+	void addEdge(double x1, double y1, double x2, double y2);
+	void openSector(MapSector* sector);
+	bool triangulate(Polygon2D* poly);
+
+private:
+	struct Edge
+	{
+		unsigned v1, v2;
+		bool     done = false;
+	};
+	struct Outline
+	{
+		vector<unsigned>       vertices;
+		double                 area = 0.;
+		vector<const Outline*> holes;
+	};
+
+	vector<Vec2d>                                 vertices_;
+	vector<vector<unsigned>>                      vertex_edges_out_;
+	vector<Edge>                                  edges_;
+	std::map<std::pair<double, double>, unsigned> vertex_map_;
+	vector<Outline>                               outlines_;
+	double                                        area_ = 0.;
+
+	unsigned addVertex(double x, double y);
+	int      nextEdge(unsigned edge, unsigned edge_start) const;
+	bool     traceOutline(unsigned edge_start);
+	bool     pointInOutline(const Outline& outline, Vec2d point) const;
+	void     assignHoles();
+	void     buildSubPolys(const vector<std::array<unsigned, 3>>& triangles, Polygon2D* poly) const;
+};
+} // namespace slade
@@ -34,6 +34,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "Property.h"
+#include <charconv>
 
 using namespace slade;
 
@@ -138,27 +139,42 @@ string asString(const Property& prop, int float_precision)
 // -----------------------------------------------------------------------------
 string PropertyList::toString(bool condensed, int float_precision) const
 {
-	// Init return string
 	string ret;
+	write(ret, condensed, float_precision);
+	return ret;
+}
 
+// -----------------------------------------------------------------------------
+// Writes a string representation of the property list, appending it to [out]
+// -----------------------------------------------------------------------------
+void PropertyList::write(string& out, bool condensed, int float_precision) const
+{
 	// Go through all properties
 	for (const auto& prop : properties_)
 	{
-		// Add "key = value;\n" to the return string
-		auto val = property::asString(prop.value, float_precision);
+		// Add "key = value;\n" to the output
+		out += prop.name;
+		out += condensed ? "=" : " = ";
 
-		if (property::valueType(prop.value) == property::ValueType::String)
+		auto type = property::valueType(prop.value);
+		if (type == property::ValueType::String)
 		{
-			val = strutil::escapedString(val, false, true);
-			val.insert(val.begin(), '\"');
-			val.push_back('\"');
+			out += '\"';
+			out += strutil::escapedString(std::get<string>(prop.value), false, true);
+			out += '\"';
+		}
+		else if (type == property::ValueType::Int || type == property::ValueType::UInt)
+		{
+			// Format integers directly, no need for a temporary string
+			char buf[16];
+			auto result = type == property::ValueType::Int ?
+							  std::to_chars(buf, buf + sizeof(buf), std::get<int>(prop.value)) :
+							  std::to_chars(buf, buf + sizeof(buf), std::get<unsigned int>(prop.value));
+			out.append(buf, result.ptr);
 		}
-
-		if (condensed)
-			ret += fmt::format("{}={};\n", prop.name, val);
 		else
-			ret += fmt::format("{} = {};\n", prop.name, val);
-	}
+			out += property::asString(prop.value, float_precision);
 
-	return ret;
+		out += ";\n";
+	}
 }
@@ -140,6 +140,7 @@ public:
 	}
 
 	string toString(bool condensed = false, int float_precision = 0) const;
+	void   write(string& out, bool condensed = false, int float_precision = 0) const;
 
 private:
 	vector<Named<Property>> properties_;
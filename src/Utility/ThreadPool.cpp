@@ -0,0 +1,245 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2022 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    ThreadPool.cpp
+// Description: A simple pool of worker threads for running independent tasks
+//              concurrently, plus a global pool shared by the whole program
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "ThreadPool.h"
+#include <atomic>
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+CVAR(Int, max_worker_threads, 0, CVar::Flag::Save)
+namespace slade::threadpool
+{
+std::once_flag         global_pool_init;
+unique_ptr<ThreadPool> global_pool;
+} // namespace slade::threadpool
+
+
+// -----------------------------------------------------------------------------
+//
+// ThreadPool Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// ThreadPool class constructor, starts [n_threads] worker threads (or one per
+// hardware thread if [n_threads] is 0)
+// -----------------------------------------------------------------------------
+ThreadPool::ThreadPool(unsigned n_threads)
+{
+	if (n_threads == 0)
+		n_threads = std::max(1u, std::thread::hardware_concurrency());
+
+	workers_.reserve(n_threads);
+	for (unsigned a = 0; a < n_threads; ++a)
+		workers_.emplace_back([this]() { workerLoop(); });
+}
+
+// -----------------------------------------------------------------------------
+// ThreadPool class destructor, finishes any queued tasks and joins all worker
+// threads
+// -----------------------------------------------------------------------------
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard lock(mutex_);
+		stop_ = true;
+	}
+	cv_.notify_all();
+
+	for (auto& worker : workers_)
+		worker.join();
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the calling thread is one of this pool's worker threads
+// -----------------------------------------------------------------------------
+bool ThreadPool::isWorkerThread() const
+{
+	auto id = std::this_thread::get_id();
+	for (const auto& worker : workers_)
+		if (worker.get_id() == id)
+			return true;
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// Calls [func] for each index in [0, count), spread over the worker threads in
+// blocks of [grain] indices. The calling thread also takes part and this
+// doesn't return until all indices have been processed, so it is safe to call
+// from within a task running on the pool itself.
+// If [func] throws, the first exception is rethrown here once all indices are
+// done
+// -----------------------------------------------------------------------------
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& func, size_t grain)
+{
+	if (count == 0)
+		return;
+	if (grain == 0)
+		grain = 1;
+
+	// Not worth distributing, just run everything here
+	if (count <= grain || workers_.size() < 2)
+	{
+		for (size_t i = 0; i < count; ++i)
+			func(i);
+		return;
+	}
+
+	// Shared state, kept alive by any helper tasks that start after we return
+	struct State
+	{
+		std::atomic<size_t>     next{ 0 };
+		size_t                  done = 0;
+		std::mutex              mutex;
+		std::condition_variable cv;
+		std::exception_ptr      error;
+	};
+	auto state = std::make_shared<State>();
+
+	auto process = [state, count, grain, &func]()
+	{
+		while (true)
+		{
+			auto start = state->next.fetch_add(grain);
+			if (start >= count)
+				return;
+
+			auto end = std::min(start + grain, count);
+			try
+			{
+				for (auto i = start; i < end; ++i)
+					func(i);
+			}
+			catch (...)
+			{
+				std::lock_guard lock(state->mutex);
+				if (!state->error)
+					state->error = std::current_exception();
+			}
+
+			std::lock_guard lock(state->mutex);
+			state->done += end - start;
+			if (state->done == count)
+				state->cv.notify_all();
+		}
+	};
+
+	// Queue helper tasks (the calling thread counts as one worker).
+	// Late helpers only touch [func] after claiming an index, which can't
+	// happen once everything has been claimed, so the reference stays valid
+	auto n_blocks  = (count + grain - 1) / grain;
+	auto n_helpers = std::min<size_t>(workers_.size(), n_blocks - 1);
+	{
+		std::lock_guard lock(mutex_);
+		for (size_t a = 0; a < n_helpers; ++a)
+			tasks_.emplace_back(process);
+	}
+	cv_.notify_all();
+
+	// Process on this thread too, then wait for any blocks still in progress
+	process();
+	std::unique_lock lock(state->mutex);
+	state->cv.wait(lock, [&]() { return state->done == count; });
+
+	if (state->error)
+		std::rethrow_exception(state->error);
+}
+
+// -----------------------------------------------------------------------------
+// Main loop for each worker thread, runs queued tasks until the pool is
+// stopped and the queue is empty
+// -----------------------------------------------------------------------------
+void ThreadPool::workerLoop()
+{
+	while (true)
+	{
+		std::function<void()> task;
+		{
+			std::unique_lock lock(mutex_);
+			cv_.wait(lock, [this]() { return stop_ || !tasks_.empty(); });
+			if (stop_ && tasks_.empty())
+				return;
+
+			task = std::move(tasks_.front());
+			tasks_.pop_front();
+		}
+
+		task();
+	}
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// ThreadPool Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns the global thread pool, creating it on first use with
+// [max_worker_threads] workers (0 = one per hardware thread)
+// -----------------------------------------------------------------------------
+ThreadPool& threadpool::global()
+{
+	std::call_once(
+		global_pool_init,
+		[]() { global_pool = std::make_unique<ThreadPool>(std::max(0, static_cast<int>(max_worker_threads))); });
+
+	return *global_pool;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the number of worker threads in the global pool
+// -----------------------------------------------------------------------------
+unsigned threadpool::nWorkers()
+{
+	return global().nThreads();
+}
+
+// -----------------------------------------------------------------------------
+// Runs [func] for each index in [0, count) on the global thread pool.
+// See ThreadPool::parallelFor
+// -----------------------------------------------------------------------------
+void threadpool::parallelFor(size_t count, const std::function<void(size_t)>& func, size_t grain)
+{
+	global().parallelFor(count, func, grain);
+}
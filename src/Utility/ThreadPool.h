@@ -0,0 +1,58 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+
+namespace slade
+{
+class ThreadPool
+{
+public:
+	ThreadPool(unsigned n_threads = 0);
+	~ThreadPool();
+
+	// Non-copyable
+	ThreadPool(const ThreadPool&)            = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	unsigned nThreads() const { return static_cast<unsigned>(workers_.size()); }
+	bool     isWorkerThread() const;
+
+	// Queues [func] to be run on a worker thread, returns a future for its result
+	template<typename F> auto enqueue(F&& func) -> std::future<decltype(func())>
+	{
+		using Result = decltype(func());
+
+		auto task   = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(func));
+		auto future = task->get_future();
+		{
+			std::lock_guard lock(mutex_);
+			tasks_.emplace_back([task]() { (*task)(); });
+		}
+		cv_.notify_one();
+
+		return future;
+	}
+
+	void parallelFor(size_t count, const std::function<void(size_t)>& func, size_t grain = 1);
+
+private:
+	vector<std::thread>               workers_;
+	std::deque<std::function<void()>> tasks_;
+	std::mutex                        mutex_;
+	std::condition_variable           cv_;
+	bool                              stop_ = false;
+
+	void workerLoop();
+};
+
+namespace threadpool
+{
+	ThreadPool& global();
+	unsigned    nWorkers();
+	void        parallelFor(size_t count, const std::function<void(size_t)>& func, size_t grain = 1);
+} // namespace threadpool
+} // namespace slade
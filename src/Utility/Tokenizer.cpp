@@ -674,8 +674,9 @@ bool Tokenizer::openMem(const MemChunk& mc, string_view source)
 void Tokenizer::reset()
 {
 	// Init tokenizing state
-	state_      = TokenizeState{};
-	state_.size = data_.size();
+	state_              = TokenizeState{};
+	state_.size         = data_.size();
+	state_.current_line = first_line_;
 
 	// Read first tokens
 	readNext(&token_current_);
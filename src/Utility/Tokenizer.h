@@ -88,6 +88,7 @@ public:
 	}
 	void setSource(const wxString& source) { source_ = source; }
 	void setReadLowerCase(bool lower) { read_lowercase_ = lower; }
+	void setFirstLine(unsigned line) { first_line_ = line; }
 	void enableDecorate(bool enable) { decorate_ = enable; }
 	void enableDebug(bool enable) { debug_ = enable; }
 
@@ -217,6 +218,7 @@ private:
 	bool         read_lowercase_ = false; // If true, tokens will all be read in lowercase
 										  // (except for quoted strings, obviously)
 	bool debug_ = false;                  // Log each token read
+	unsigned first_line_ = 1;             // Line number of the start of the data (eg. if it's part of a file)
 
 	// Static
 	static Token invalid_token_;